@@ -0,0 +1,113 @@
+/* Bank of up to 64 button/LED channels running the same lab1 case
+*/
+#include <string.h>
+#include "button_bank.h"
+
+static inline uint64_t channel_mask(uint8_t num_channels)
+{
+    return num_channels == 64 ? UINT64_MAX : (1ULL << num_channels) - 1;
+}
+
+bool button_bank_init(button_bank_t *bank, button_case_t which, const button_case_ctx_t *config, uint8_t num_channels)
+{
+    if (num_channels == 0 || num_channels > BUTTON_BANK_MAX_CHANNELS) {
+        return false;
+    }
+    memset(bank, 0, sizeof(*bank));
+    bank->ctx.long_press_ms = config->long_press_ms;
+    bank->ctx.blink_period_ms = config->blink_period_ms;
+    bank->ctx.blink_duration_ms = config->blink_duration_ms;
+    bank->ctx.debounce_ms = config->debounce_ms;
+    if (!button_case_init(&bank->fsm, which, &bank->ctx)) {
+        return false;
+    }
+    bank->num_channels = num_channels;
+    // Every channel starts as a copy of the freshly initialized machine
+    for (int i = 0; i < num_channels; i++) {
+        bank->state[i] = bank->fsm.state;
+        bank->last_press_us[i] = bank->ctx.last_press_us;
+        bank->blink_start_us[i] = bank->ctx.blink_start_us;
+        for (int t = 0; t < BUTTON_TIMER_COUNT; t++) {
+            bank->deadline_us[t][i] = BUTTON_CASE_NO_DEADLINE;
+        }
+        bank->next_deadline_us[i] = BUTTON_CASE_NO_DEADLINE;
+    }
+    return true;
+}
+
+// Load channel i into the scratch machine, run it, store it back
+static void step_channel(button_bank_t *bank, int i, bool edge, uint8_t level, int64_t now_us)
+{
+    button_case_ctx_t *ctx = &bank->ctx;
+    bank->fsm.state = bank->state[i];
+    ctx->led = (bank->leds >> i) & 1;
+    ctx->last_press_us = bank->last_press_us[i];
+    ctx->blink_start_us = bank->blink_start_us[i];
+    for (int t = 0; t < BUTTON_TIMER_COUNT; t++) {
+        ctx->deadline_us[t] = bank->deadline_us[t][i];
+    }
+
+    button_case_fire_due(&bank->fsm, now_us);
+    if (edge) {
+        button_case_edge(&bank->fsm, level, now_us);
+    }
+
+    bank->state[i] = bank->fsm.state;
+    bank->leds = (bank->leds & ~(1ULL << i)) | ((uint64_t)ctx->led << i);
+    bank->last_press_us[i] = ctx->last_press_us;
+    bank->blink_start_us[i] = ctx->blink_start_us;
+    for (int t = 0; t < BUTTON_TIMER_COUNT; t++) {
+        bank->deadline_us[t][i] = ctx->deadline_us[t];
+    }
+    int64_t next = button_case_next_deadline(ctx);
+    bank->next_deadline_us[i] = next;
+    if (next == BUTTON_CASE_NO_DEADLINE) {
+        bank->armed &= ~(1ULL << i);
+    } else {
+        bank->armed |= 1ULL << i;
+    }
+}
+
+uint64_t button_bank_update(button_bank_t *bank, uint64_t buttons, int64_t now_us)
+{
+    uint64_t mask = channel_mask(bank->num_channels);
+    buttons &= mask;
+    uint64_t changed = buttons ^ bank->buttons;
+    uint64_t todo = changed;
+    for (uint64_t armed = bank->armed; armed; armed &= armed - 1) {
+        int i = __builtin_ctzll(armed);
+        if (bank->next_deadline_us[i] <= now_us) {
+            todo |= 1ULL << i;
+        }
+    }
+    bank->buttons = buttons;
+
+    for (; todo; todo &= todo - 1) {
+        int i = __builtin_ctzll(todo);
+        uint32_t start = bank->get_cycles ? bank->get_cycles() : 0;
+        step_channel(bank, i, (changed >> i) & 1, (buttons >> i) & 1, now_us);
+        if (bank->get_cycles) {
+            bank->cycles[i] += bank->get_cycles() - start;
+            bank->steps[i]++;
+        }
+    }
+    return bank->leds;
+}
+
+int64_t button_bank_next_deadline(const button_bank_t *bank)
+{
+    int64_t next = BUTTON_CASE_NO_DEADLINE;
+    for (uint64_t armed = bank->armed; armed; armed &= armed - 1) {
+        int i = __builtin_ctzll(armed);
+        if (bank->next_deadline_us[i] < next) {
+            next = bank->next_deadline_us[i];
+        }
+    }
+    return next;
+}
+
+void button_bank_reset_cycles(button_bank_t *bank)
+{
+    memset(bank->cycles, 0, sizeof(bank->cycles));
+    memset(bank->steps, 0, sizeof(bank->steps));
+}
@@ -0,0 +1,251 @@
+/* Lab1 cases A, B and C as transition tables for the fsm engine
+*/
+#include <stddef.h>
+#include "button_cases.h"
+
+#define MS_TO_US(ms) ((int64_t)(ms) * 1000)
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+
+// Case A states
+enum {
+    A_RELEASED,                 // Waiting for a press
+    A_PRESSED,                  // Waiting for the release
+    A_STATE_COUNT
+};
+
+// Case B states
+enum {
+    B_IDLE,                     // Waiting for button press
+    B_BUTTON_PRESSED,           // Button pressed, checking duration
+    B_BUTTON_RELEASED,          // Long press detected, waiting for button release
+    B_STATE_COUNT
+};
+
+// Case C states, same meaning as in C_improved.c
+enum {
+    C_IDLE,                             // LED off, waiting for press
+    C_BUTTON_PRESSED,                   // Button pressed, validating duration
+    C_BUTTON_RELEASED,                  // Blinking active with button still pressed
+    C_BLINKING,                         // Blinking active with button released
+    C_BLINKING_BUTTON_PRESSED,          // Detecting possible cancellation during blink
+    C_BLINKING_ENDED_BUTTON_RELEASED,   // Blinking over, waiting for release
+    C_STATE_COUNT
+};
+
+static inline button_case_ctx_t *case_ctx(fsm_t *fsm)
+{
+    return (button_case_ctx_t *)fsm->ctx;
+}
+
+static void set_led(button_case_ctx_t *ctx, uint8_t level)
+{
+    ctx->led = level;
+    if (ctx->set_led) {
+        ctx->set_led(ctx->set_led_arg, level);
+    }
+}
+
+static void arm(button_case_ctx_t *ctx, button_timer_t timer, int64_t deadline_us)
+{
+    ctx->deadline_us[timer] = deadline_us;
+}
+
+static void disarm(button_case_ctx_t *ctx, button_timer_t timer)
+{
+    ctx->deadline_us[timer] = BUTTON_CASE_NO_DEADLINE;
+}
+
+// ---- Guards ----
+
+static bool is_not_bounce(fsm_t *fsm, const fsm_event_t *evt)
+{
+    button_case_ctx_t *ctx = case_ctx(fsm);
+    return evt->time_us - ctx->last_press_us >= MS_TO_US(ctx->debounce_ms);
+}
+
+static bool is_blink_expired(fsm_t *fsm, const fsm_event_t *evt)
+{
+    button_case_ctx_t *ctx = case_ctx(fsm);
+    return evt->time_us - ctx->blink_start_us >= MS_TO_US(ctx->blink_duration_ms);
+}
+
+// ---- Actions ----
+
+static void toggle_led(fsm_t *fsm, const fsm_event_t *evt)
+{
+    (void)evt;
+    button_case_ctx_t *ctx = case_ctx(fsm);
+    set_led(ctx, !ctx->led);
+}
+
+static void accept_press(fsm_t *fsm, const fsm_event_t *evt)
+{
+    case_ctx(fsm)->last_press_us = evt->time_us;
+    toggle_led(fsm, evt);
+}
+
+static void start_long_press(fsm_t *fsm, const fsm_event_t *evt)
+{
+    button_case_ctx_t *ctx = case_ctx(fsm);
+    arm(ctx, BUTTON_TIMER_LONG_PRESS, evt->time_us + MS_TO_US(ctx->long_press_ms));
+}
+
+static void cancel_long_press(fsm_t *fsm, const fsm_event_t *evt)
+{
+    (void)evt;
+    disarm(case_ctx(fsm), BUTTON_TIMER_LONG_PRESS);
+}
+
+static void start_blink(fsm_t *fsm, const fsm_event_t *evt)
+{
+    button_case_ctx_t *ctx = case_ctx(fsm);
+    ctx->blink_start_us = evt->time_us;
+    if (ctx->start_blink) {
+        // Blinking offloaded: only the end of the blink remains to be timed
+        ctx->led = 1;
+        ctx->start_blink(ctx->set_led_arg, ctx->blink_period_ms, ctx->blink_duration_ms);
+    } else {
+        set_led(ctx, 1);
+        arm(ctx, BUTTON_TIMER_BLINK_TOGGLE, evt->time_us + MS_TO_US(ctx->blink_period_ms / 2));
+    }
+    arm(ctx, BUTTON_TIMER_BLINK_END, evt->time_us + MS_TO_US(ctx->blink_duration_ms));
+}
+
+static void blink_toggle(fsm_t *fsm, const fsm_event_t *evt)
+{
+    button_case_ctx_t *ctx = case_ctx(fsm);
+    set_led(ctx, !ctx->led);
+    // Re-arm from the nominal deadline so the period does not drift
+    arm(ctx, BUTTON_TIMER_BLINK_TOGGLE, evt->time_us + MS_TO_US(ctx->blink_period_ms / 2));
+}
+
+static void stop_blink(fsm_t *fsm, const fsm_event_t *evt)
+{
+    (void)evt;
+    button_case_ctx_t *ctx = case_ctx(fsm);
+    set_led(ctx, 0);
+    for (int i = 0; i < BUTTON_TIMER_COUNT; i++) {
+        disarm(ctx, i);
+    }
+}
+
+// ---- Tables ----
+
+static const fsm_transition_t s_case_a_rows[] = {
+    { A_RELEASED, BUTTON_EV_PRESS,   is_not_bounce, accept_press, A_PRESSED },
+    { A_RELEASED, BUTTON_EV_PRESS,   NULL,          NULL,         A_PRESSED },
+    { A_PRESSED,  BUTTON_EV_RELEASE, NULL,          NULL,         A_RELEASED },
+};
+
+static const fsm_transition_t s_case_b_rows[] = {
+    { B_IDLE,            BUTTON_EV_PRESS,      NULL, start_long_press,  B_BUTTON_PRESSED },
+    { B_BUTTON_PRESSED,  BUTTON_EV_RELEASE,    NULL, cancel_long_press, B_IDLE },
+    { B_BUTTON_PRESSED,  BUTTON_EV_LONG_PRESS, NULL, toggle_led,        B_BUTTON_RELEASED },
+    { B_BUTTON_RELEASED, BUTTON_EV_RELEASE,    NULL, NULL,              B_IDLE },
+};
+
+static const fsm_transition_t s_case_c_rows[] = {
+    { C_IDLE,                           BUTTON_EV_PRESS,        NULL,             start_long_press,  C_BUTTON_PRESSED },
+    { C_BUTTON_PRESSED,                 BUTTON_EV_RELEASE,      NULL,             cancel_long_press, C_IDLE },
+    { C_BUTTON_PRESSED,                 BUTTON_EV_LONG_PRESS,   NULL,             start_blink,       C_BUTTON_RELEASED },
+    { C_BUTTON_RELEASED,                BUTTON_EV_RELEASE,      NULL,             NULL,              C_BLINKING },
+    { C_BUTTON_RELEASED,                BUTTON_EV_BLINK_TOGGLE, NULL,             blink_toggle,      C_BUTTON_RELEASED },
+    { C_BUTTON_RELEASED,                BUTTON_EV_BLINK_END,    NULL,             stop_blink,        C_BLINKING_ENDED_BUTTON_RELEASED },
+    { C_BLINKING,                       BUTTON_EV_PRESS,        NULL,             start_long_press,  C_BLINKING_BUTTON_PRESSED },
+    { C_BLINKING,                       BUTTON_EV_BLINK_TOGGLE, NULL,             blink_toggle,      C_BLINKING },
+    { C_BLINKING,                       BUTTON_EV_BLINK_END,    NULL,             stop_blink,        C_IDLE },
+    // The blink duration is not checked while a cancellation is pending, only once released
+    { C_BLINKING_BUTTON_PRESSED,        BUTTON_EV_RELEASE,      is_blink_expired, stop_blink,        C_IDLE },
+    { C_BLINKING_BUTTON_PRESSED,        BUTTON_EV_RELEASE,      NULL,             cancel_long_press, C_BLINKING },
+    { C_BLINKING_BUTTON_PRESSED,        BUTTON_EV_LONG_PRESS,   NULL,             stop_blink,        C_BLINKING_ENDED_BUTTON_RELEASED },
+    { C_BLINKING_BUTTON_PRESSED,        BUTTON_EV_BLINK_TOGGLE, NULL,             blink_toggle,      C_BLINKING_BUTTON_PRESSED },
+    { C_BLINKING_ENDED_BUTTON_RELEASED, BUTTON_EV_RELEASE,      NULL,             NULL,              C_IDLE },
+};
+
+typedef struct {
+    const fsm_transition_t *rows;
+    uint8_t num_rows;
+    uint8_t num_states;
+    uint8_t initial_state;
+} case_desc_t;
+
+static const case_desc_t s_cases[BUTTON_CASE_COUNT] = {
+    [BUTTON_CASE_A] = { s_case_a_rows, COUNT_OF(s_case_a_rows), A_STATE_COUNT, A_RELEASED },
+    [BUTTON_CASE_B] = { s_case_b_rows, COUNT_OF(s_case_b_rows), B_STATE_COUNT, B_IDLE },
+    [BUTTON_CASE_C] = { s_case_c_rows, COUNT_OF(s_case_c_rows), C_STATE_COUNT, C_IDLE },
+};
+
+// Dispatch indexes, built on first use of each case
+static fsm_table_t s_tables[BUTTON_CASE_COUNT];
+static bool s_table_ready[BUTTON_CASE_COUNT];
+
+bool button_case_init(fsm_t *fsm, button_case_t which, button_case_ctx_t *ctx)
+{
+    if (which >= BUTTON_CASE_COUNT) {
+        return false;
+    }
+    const case_desc_t *desc = &s_cases[which];
+    if (!s_table_ready[which]) {
+        if (!fsm_table_init(&s_tables[which], desc->rows, desc->num_rows, desc->num_states, BUTTON_EV_COUNT)) {
+            return false;
+        }
+        s_table_ready[which] = true;
+    }
+    ctx->led = 0;
+    ctx->last_press_us = INT64_MIN / 2;
+    ctx->blink_start_us = 0;
+    for (int i = 0; i < BUTTON_TIMER_COUNT; i++) {
+        disarm(ctx, i);
+    }
+    fsm_init(fsm, &s_tables[which], desc->initial_state, ctx);
+    return true;
+}
+
+int64_t button_case_next_deadline(const button_case_ctx_t *ctx)
+{
+    int64_t next = BUTTON_CASE_NO_DEADLINE;
+    for (int i = 0; i < BUTTON_TIMER_COUNT; i++) {
+        if (ctx->deadline_us[i] < next) {
+            next = ctx->deadline_us[i];
+        }
+    }
+    return next;
+}
+
+bool button_case_edge(fsm_t *fsm, uint8_t level, int64_t time_us)
+{
+    fsm_event_t evt = {
+        .id = level ? BUTTON_EV_PRESS : BUTTON_EV_RELEASE,
+        .time_us = time_us,
+    };
+    return fsm_dispatch(fsm, &evt);
+}
+
+void button_case_fire_due(fsm_t *fsm, int64_t now_us)
+{
+    static const uint8_t timer_event[BUTTON_TIMER_COUNT] = {
+        [BUTTON_TIMER_LONG_PRESS] = BUTTON_EV_LONG_PRESS,
+        [BUTTON_TIMER_BLINK_TOGGLE] = BUTTON_EV_BLINK_TOGGLE,
+        [BUTTON_TIMER_BLINK_END] = BUTTON_EV_BLINK_END,
+    };
+    button_case_ctx_t *ctx = case_ctx(fsm);
+    while (1) {
+        // Earliest expired deadline first, ties resolved in timer order
+        int timer = -1;
+        for (int i = 0; i < BUTTON_TIMER_COUNT; i++) {
+            if (ctx->deadline_us[i] <= now_us && (timer < 0 || ctx->deadline_us[i] < ctx->deadline_us[timer])) {
+                timer = i;
+            }
+        }
+        if (timer < 0) {
+            return;
+        }
+        // Events carry the nominal deadline, not the (later) wake-up time
+        fsm_event_t evt = {
+            .id = timer_event[timer],
+            .time_us = ctx->deadline_us[timer],
+        };
+        disarm(ctx, timer);
+        fsm_dispatch(fsm, &evt);
+    }
+}
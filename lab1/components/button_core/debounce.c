@@ -0,0 +1,13 @@
+/* Bit-parallel debouncer for up to 32 inputs
+*/
+#include "debounce.h"
+
+void debounce_init(debounce_t *db, uint32_t mask, uint32_t active_low, uint32_t initial_raw)
+{
+    db->mask = mask;
+    db->invert = active_low & mask;
+    db->state = (initial_raw ^ db->invert) & mask;
+    // All ones is the counter reset value
+    db->ct0 = UINT32_MAX;
+    db->ct1 = UINT32_MAX;
+}
@@ -0,0 +1,65 @@
+/* Table-driven finite state machine
+*/
+#include <string.h>
+#include "fsm.h"
+
+bool fsm_table_init(fsm_table_t *table, const fsm_transition_t *rows, size_t num_rows,
+                    uint8_t num_states, uint8_t num_events)
+{
+    if (!table || !rows || num_rows > FSM_MAX_ROWS ||
+        num_states > FSM_MAX_STATES || num_events > FSM_MAX_EVENTS) {
+        return false;
+    }
+    memset(table->first, FSM_NO_ROW, sizeof(table->first));
+    for (size_t i = 0; i < num_rows; i++) {
+        const fsm_transition_t *row = &rows[i];
+        if (row->state >= num_states || row->event >= num_events || row->next >= num_states) {
+            return false;
+        }
+        uint8_t *first = &table->first[row->state * FSM_MAX_EVENTS + row->event];
+        if (*first == FSM_NO_ROW) {
+            *first = i;
+        } else if (rows[i - 1].state != row->state || rows[i - 1].event != row->event) {
+            // Alternatives of a pair must follow each other
+            return false;
+        }
+    }
+    table->rows = rows;
+    table->num_rows = num_rows;
+    table->num_states = num_states;
+    table->num_events = num_events;
+    return true;
+}
+
+void fsm_init(fsm_t *fsm, const fsm_table_t *table, uint8_t initial_state, void *ctx)
+{
+    fsm->table = table;
+    fsm->state = initial_state;
+    fsm->ctx = ctx;
+}
+
+bool fsm_dispatch(fsm_t *fsm, const fsm_event_t *evt)
+{
+    const fsm_table_t *table = fsm->table;
+    if (evt->id >= table->num_events) {
+        return false;
+    }
+    uint8_t state = fsm->state;
+    uint8_t i = table->first[state * FSM_MAX_EVENTS + evt->id];
+    if (i == FSM_NO_ROW) {
+        return false;
+    }
+    for (const fsm_transition_t *row = &table->rows[i], *end = table->rows + table->num_rows;
+         row < end && row->state == state && row->event == evt->id; row++) {
+        if (row->guard && !row->guard(fsm, evt)) {
+            continue;
+        }
+        // Enter the next state first so actions see where the machine is going
+        fsm->state = row->next;
+        if (row->action) {
+            row->action(fsm, evt);
+        }
+        return true;
+    }
+    return false;
+}
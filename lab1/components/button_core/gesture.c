@@ -0,0 +1,162 @@
+/* Button gesture recognizer
+*/
+#include <stddef.h>
+#include "gesture.h"
+
+#define MS_TO_US(ms) ((int64_t)(ms) * 1000)
+
+// Recognizer states
+enum {
+    G_IDLE,         // Released, no sequence in progress
+    G_PRESSED,      // Held, not long yet
+    G_HELD,         // Held past the long press threshold
+    G_WAIT_NEXT,    // Released, waiting to see if another click follows
+};
+
+static void emit(gesture_t *g, gesture_type_t type, uint16_t count, int64_t time_us, uint32_t duration_ms)
+{
+    gesture_event_t evt = {
+        .type = type,
+        .count = count,
+        .time_us = time_us,
+        .duration_ms = duration_ms,
+    };
+    for (int i = 0; i < GESTURE_MAX_SUBSCRIBERS; i++) {
+        if (g->subscribers[i].cb && (g->subscribers[i].mask & GESTURE_MASK(type))) {
+            g->subscribers[i].cb(&evt, g->subscribers[i].arg);
+        }
+    }
+}
+
+static void end_sequence(gesture_t *g)
+{
+    g->state = G_IDLE;
+    g->count = 0;
+    g->deadline_us = GESTURE_NO_DEADLINE;
+}
+
+static void on_press(gesture_t *g, int64_t time_us)
+{
+    emit(g, GESTURE_PRESS, 0, time_us, 0);
+    g->count = g->state == G_WAIT_NEXT ? g->count + 1 : 1;
+    g->state = G_PRESSED;
+    g->press_us = time_us;
+    g->deadline_us = time_us + MS_TO_US(g->config.long_press_ms);
+}
+
+static void on_release(gesture_t *g, int64_t time_us)
+{
+    emit(g, GESTURE_RELEASE, 0, time_us, 0);
+    if (g->state == G_HELD) {
+        emit(g, GESTURE_LONG_RELEASE, g->count, time_us, (time_us - g->press_us) / 1000);
+        end_sequence(g);
+    } else if (g->config.max_clicks && g->count >= g->config.max_clicks) {
+        // No longer sequence is possible, do not wait for the gap
+        emit(g, GESTURE_CLICK, g->count, time_us, 0);
+        end_sequence(g);
+    } else {
+        g->state = G_WAIT_NEXT;
+        g->deadline_us = time_us + MS_TO_US(g->config.multi_click_gap_ms);
+    }
+}
+
+static void accept_edge(gesture_t *g, uint8_t level, int64_t time_us)
+{
+    g->level = level;
+    g->last_edge_us = time_us;
+    if (level) {
+        on_press(g, time_us);
+    } else {
+        on_release(g, time_us);
+    }
+}
+
+static void on_deadline(gesture_t *g)
+{
+    int64_t time_us = g->deadline_us;
+    switch (g->state) {
+    case G_PRESSED:
+        emit(g, GESTURE_LONG_PRESS, g->count, time_us, 0);
+        g->state = G_HELD;
+        g->repeats = 0;
+        g->deadline_us = g->config.repeat_interval_ms ?
+                         time_us + MS_TO_US(g->config.repeat_interval_ms) : GESTURE_NO_DEADLINE;
+        break;
+    case G_HELD:
+        emit(g, GESTURE_HOLD_REPEAT, ++g->repeats, time_us, 0);
+        g->deadline_us = time_us + MS_TO_US(g->config.repeat_interval_ms);
+        break;
+    case G_WAIT_NEXT:
+        emit(g, GESTURE_CLICK, g->count, time_us, 0);
+        end_sequence(g);
+        break;
+    default:
+        g->deadline_us = GESTURE_NO_DEADLINE;
+        break;
+    }
+}
+
+// When a level ignored as bounce becomes the accepted level
+static int64_t settle_deadline(const gesture_t *g)
+{
+    return g->raw_level != g->level ? g->last_edge_us + MS_TO_US(g->config.debounce_ms) : GESTURE_NO_DEADLINE;
+}
+
+void gesture_init(gesture_t *g, const gesture_config_t *config)
+{
+    *g = (gesture_t) {
+        .config = *config,
+        .state = G_IDLE,
+        .last_edge_us = INT64_MIN / 2,
+        .deadline_us = GESTURE_NO_DEADLINE,
+    };
+}
+
+bool gesture_subscribe(gesture_t *g, uint32_t types_mask, gesture_cb_t cb, void *arg)
+{
+    for (int i = 0; i < GESTURE_MAX_SUBSCRIBERS; i++) {
+        if (!g->subscribers[i].cb) {
+            g->subscribers[i].mask = types_mask;
+            g->subscribers[i].cb = cb;
+            g->subscribers[i].arg = arg;
+            return true;
+        }
+    }
+    return false;
+}
+
+void gesture_poll(gesture_t *g, int64_t now_us)
+{
+    while (1) {
+        int64_t settle = settle_deadline(g);
+        if (settle <= g->deadline_us) {
+            if (settle > now_us) {
+                return;
+            }
+            accept_edge(g, g->raw_level, settle);
+        } else {
+            if (g->deadline_us > now_us) {
+                return;
+            }
+            on_deadline(g);
+        }
+    }
+}
+
+void gesture_edge(gesture_t *g, uint8_t level, int64_t time_us)
+{
+    // A deadline at the very time of the edge is too late: the edge wins
+    gesture_poll(g, time_us - 1);
+    g->raw_level = level;
+    if (level == g->level || time_us - g->last_edge_us < MS_TO_US(g->config.debounce_ms)) {
+        // Repeated level, or a bounce: settle_deadline() picks it up if it persists
+        return;
+    }
+    accept_edge(g, level, time_us);
+}
+
+int64_t gesture_next_deadline(const gesture_t *g)
+{
+    int64_t settle = settle_deadline(g);
+    return settle < g->deadline_us ? settle : g->deadline_us;
+}
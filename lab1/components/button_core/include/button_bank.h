@@ -0,0 +1,73 @@
+/* Bank of up to 64 button/LED channels running the same lab1 case
+
+   The per channel state is kept as struct-of-arrays (state, press and
+   blink times, one deadline array per timer) and the button and LED levels
+   as one bit per channel, so a whole panel is read and written with a few
+   mask operations. Each update only visits the channels whose button
+   changed or whose deadline expired: idle channels cost nothing. A visited
+   channel is run through the transition tables of button_cases.c, so
+   every channel behaves exactly like a single button_case machine.
+
+   This file has no ESP-IDF dependency and builds for the target and for Linux.
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fsm.h"
+#include "button_cases.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BUTTON_BANK_MAX_CHANNELS 64
+
+typedef struct {
+    // Configuration
+    uint8_t num_channels;
+    uint32_t (*get_cycles)(void);   // Optional CPU cycle counter, enables the per channel cost
+    // Levels, bit n is channel n
+    uint64_t buttons;               // Last button levels seen
+    uint64_t leds;                  // LED levels
+    uint64_t armed;                 // Channels with at least one deadline
+    // Per channel state
+    uint8_t state[BUTTON_BANK_MAX_CHANNELS];
+    int64_t last_press_us[BUTTON_BANK_MAX_CHANNELS];
+    int64_t blink_start_us[BUTTON_BANK_MAX_CHANNELS];
+    int64_t deadline_us[BUTTON_TIMER_COUNT][BUTTON_BANK_MAX_CHANNELS];
+    int64_t next_deadline_us[BUTTON_BANK_MAX_CHANNELS];  // Earliest of the channel's deadlines
+    // Per channel cost, only with get_cycles
+    uint32_t cycles[BUTTON_BANK_MAX_CHANNELS];  // CPU cycles spent in the channel
+    uint32_t steps[BUTTON_BANK_MAX_CHANNELS];   // Times the channel was visited
+    // Scratch machine the channels are loaded into, holds the shared configuration
+    fsm_t fsm;
+    button_case_ctx_t ctx;
+} button_bank_t;
+
+/**
+ * @brief Set every channel of the bank to the initial state of a case
+ *
+ * @param config Shared timing configuration, only its configuration fields are used
+ * @return false if the case does not exist or num_channels is out of range
+ */
+bool button_bank_init(button_bank_t *bank, button_case_t which, const button_case_ctx_t *config, uint8_t num_channels);
+
+/**
+ * @brief Feed the button levels sampled at now_us
+ *
+ * Deadlines expired by now_us are handled first, then the button changes.
+ *
+ * @return LED levels, bit n is channel n
+ */
+uint64_t button_bank_update(button_bank_t *bank, uint64_t buttons, int64_t now_us);
+
+// Earliest deadline of all channels, BUTTON_CASE_NO_DEADLINE if none
+int64_t button_bank_next_deadline(const button_bank_t *bank);
+
+// Clear the per channel cost counters
+void button_bank_reset_cycles(button_bank_t *bank);
+
+#ifdef __cplusplus
+}
+#endif
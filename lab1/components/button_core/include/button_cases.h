@@ -0,0 +1,90 @@
+/* Lab1 cases A, B and C as transition tables for the fsm engine
+
+   Button edges become BUTTON_EV_PRESS / BUTTON_EV_RELEASE events. Timing is
+   done with deadlines armed by the actions. The caller waits until the
+   earliest deadline and then calls button_case_fire_due(), which turns
+   expired deadlines into timer events.
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fsm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BUTTON_CASE_NO_DEADLINE INT64_MAX
+
+// Which lab1 behaviour the machine implements
+typedef enum {
+    BUTTON_CASE_A,      // Toggle the LED on every press
+    BUTTON_CASE_B,      // Toggle the LED on a long press
+    BUTTON_CASE_C,      // Long press blinks the LED, a second long press cancels
+    BUTTON_CASE_COUNT
+} button_case_t;
+
+// Event ids shared by all cases
+typedef enum {
+    BUTTON_EV_PRESS,        // Button went down
+    BUTTON_EV_RELEASE,      // Button went up
+    BUTTON_EV_LONG_PRESS,   // Long press threshold reached
+    BUTTON_EV_BLINK_TOGGLE, // Half blink period elapsed
+    BUTTON_EV_BLINK_END,    // Blink duration elapsed
+    BUTTON_EV_COUNT
+} button_event_id_t;
+
+// Deadlines, one per timer event
+typedef enum {
+    BUTTON_TIMER_LONG_PRESS,
+    BUTTON_TIMER_BLINK_END,     // Before the toggle so a simultaneous end wins
+    BUTTON_TIMER_BLINK_TOGGLE,
+    BUTTON_TIMER_COUNT
+} button_timer_t;
+
+// Shared context of a case machine
+typedef struct {
+    // Configuration
+    uint32_t long_press_ms;         // Minimum press time for a long press
+    uint32_t blink_period_ms;       // Full blink period (ON + OFF)
+    uint32_t blink_duration_ms;     // Total blinking duration
+    uint32_t debounce_ms;           // Case A: presses closer than this are bounces
+    void (*set_led)(void *arg, uint8_t level);  // LED output
+    // Optional: blink in hardware for blink_duration_ms. The LED then stays untouched until set_led()
+    void (*start_blink)(void *arg, uint32_t period_ms, uint32_t duration_ms);
+    void *set_led_arg;                          // Argument of set_led and start_blink
+    // Runtime state
+    uint8_t led;                    // Current LED level
+    int64_t last_press_us;          // Case A: last accepted press
+    int64_t blink_start_us;         // Case C: when blinking started
+    int64_t deadline_us[BUTTON_TIMER_COUNT];    // BUTTON_CASE_NO_DEADLINE when disarmed
+} button_case_ctx_t;
+
+// Defaults of the original lab1 programs
+#define BUTTON_CASE_CTX_DEFAULT() {     \
+    .long_press_ms = 500,               \
+    .blink_period_ms = 200,             \
+    .blink_duration_ms = 10000,         \
+    .debounce_ms = 50,                  \
+}
+
+/**
+ * @brief Bind fsm to the table of a case and reset the runtime part of ctx
+ *
+ * @return false if the case does not exist
+ */
+bool button_case_init(fsm_t *fsm, button_case_t which, button_case_ctx_t *ctx);
+
+// Earliest armed deadline, BUTTON_CASE_NO_DEADLINE if none
+int64_t button_case_next_deadline(const button_case_ctx_t *ctx);
+
+// Dispatch a button level change at time_us
+bool button_case_edge(fsm_t *fsm, uint8_t level, int64_t time_us);
+
+// Dispatch, in time order, the timer events of every deadline <= now_us
+void button_case_fire_due(fsm_t *fsm, int64_t now_us);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,56 @@
+/* Bit-parallel debouncer for up to 32 inputs
+
+   Every input owns a 2-bit counter stored "vertically": bit n of ct0 and
+   ct1 hold the counter of input n. One update debounces the 32 inputs with
+   a few bitwise operations. An input changes its debounced state after
+   DEBOUNCE_SAMPLES consecutive samples that differ from it; any sample equal
+   to the current state resets its counter.
+
+   This file has no ESP-IDF dependency and builds for the target and for Linux.
+*/
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DEBOUNCE_SAMPLES 4  // Consecutive samples needed to accept a change
+
+typedef struct {
+    uint32_t state;     // Debounced levels, 1 = pressed
+    uint32_t ct0;       // Counter bit 0 of every input
+    uint32_t ct1;       // Counter bit 1 of every input
+    uint32_t mask;      // Inputs being debounced
+    uint32_t invert;    // Inputs that read 0 when pressed
+} debounce_t;
+
+// Edges accepted by one update
+typedef struct {
+    uint32_t pressed;   // Inputs that became pressed
+    uint32_t released;  // Inputs that became released
+} debounce_edges_t;
+
+// Start debouncing mask, taking initial_raw (a raw register read) as the settled state
+void debounce_init(debounce_t *db, uint32_t mask, uint32_t active_low, uint32_t initial_raw);
+
+// Feed one raw sample of the input register, returns the accepted edges
+static inline debounce_edges_t debounce_update(debounce_t *db, uint32_t raw)
+{
+    uint32_t delta = ((raw ^ db->invert) ^ db->state) & db->mask;
+    // Count inputs whose sample differs from the state, reset the others
+    db->ct0 = ~(db->ct0 & delta);
+    db->ct1 = db->ct0 ^ (db->ct1 & delta);
+    // Counters that rolled over from 0b00 back to 0b11 flip their input
+    uint32_t toggle = delta & db->ct0 & db->ct1;
+    db->state ^= toggle;
+    return (debounce_edges_t) {
+        .pressed = toggle & db->state,
+        .released = toggle & ~db->state,
+    };
+}
+
+#ifdef __cplusplus
+}
+#endif
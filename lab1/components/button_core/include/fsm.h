@@ -0,0 +1,84 @@
+/* Table-driven finite state machine
+
+   A machine is described by a const array of transitions {state, event,
+   guard, action, next}, so the description lives in flash. Rows sharing the
+   same (state, event) pair are evaluated in order until a guard accepts the
+   event. An index built once per table makes each dispatch O(1).
+
+   This file has no ESP-IDF dependency and builds for the target and for Linux.
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FSM_MAX_STATES 16     // Upper bound for the number of states of a table
+#define FSM_MAX_EVENTS 8      // Upper bound for the number of event ids of a table
+#define FSM_MAX_ROWS 255      // Row indexes are stored in a byte
+#define FSM_NO_ROW 0xFF       // Index entry for a (state, event) pair without rows
+
+// Event fed to a state machine
+typedef struct {
+    uint8_t id;         // Event id, below the table's num_events
+    int64_t time_us;    // When the event happened
+} fsm_event_t;
+
+typedef struct fsm fsm_t;
+
+// Returns true when the transition may be taken. NULL guard means always
+typedef bool (*fsm_guard_t)(fsm_t *fsm, const fsm_event_t *evt);
+// Side effect run when the transition is taken. NULL action means none
+typedef void (*fsm_action_t)(fsm_t *fsm, const fsm_event_t *evt);
+
+// One row of a transition table
+typedef struct {
+    uint8_t state;          // State the row applies to
+    uint8_t event;          // Event the row reacts to
+    fsm_guard_t guard;      // Optional condition
+    fsm_action_t action;    // Optional side effect
+    uint8_t next;           // State after the transition
+} fsm_transition_t;
+
+// Transition table plus its (state, event) -> first row index
+typedef struct {
+    const fsm_transition_t *rows;
+    uint8_t num_rows;
+    uint8_t num_states;
+    uint8_t num_events;
+    uint8_t first[FSM_MAX_STATES * FSM_MAX_EVENTS];
+} fsm_table_t;
+
+// State machine instance
+struct fsm {
+    const fsm_table_t *table;
+    uint8_t state;
+    void *ctx;              // User context for guards and actions
+};
+
+/**
+ * @brief Build the dispatch index of a transition table
+ *
+ * @return false if the table is too large, references out of range states or
+ *         events, or the rows of a (state, event) pair are not contiguous
+ */
+bool fsm_table_init(fsm_table_t *table, const fsm_transition_t *rows, size_t num_rows,
+                    uint8_t num_states, uint8_t num_events);
+
+// Bind an instance to an initialized table
+void fsm_init(fsm_t *fsm, const fsm_table_t *table, uint8_t initial_state, void *ctx);
+
+/**
+ * @brief Feed one event to the state machine
+ *
+ * @return true if a transition was taken, false if the event was ignored
+ */
+bool fsm_dispatch(fsm_t *fsm, const fsm_event_t *evt);
+
+#ifdef __cplusplus
+}
+#endif
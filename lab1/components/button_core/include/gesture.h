@@ -0,0 +1,95 @@
+/* Button gesture recognizer
+
+   Classifies the edges of one button into gestures: N-clicks (single,
+   double, triple, ...), long press, hold-repeat and the release that ends a
+   long press. It is driven only by timestamps: the caller feeds edges with
+   gesture_edge() and, when nothing happens, calls gesture_poll() at
+   gesture_next_deadline(). Recognized gestures are delivered to the
+   subscribers whose type mask matches.
+
+   This file has no ESP-IDF dependency and builds for the target and for Linux.
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GESTURE_MAX_SUBSCRIBERS 4
+#define GESTURE_NO_DEADLINE INT64_MAX
+
+typedef enum {
+    GESTURE_PRESS,          // Debounced press
+    GESTURE_RELEASE,        // Debounced release
+    GESTURE_CLICK,          // Sequence of count short presses ended
+    GESTURE_LONG_PRESS,     // Button held for long_press_ms, count includes the clicks before it
+    GESTURE_HOLD_REPEAT,    // Button still held, every repeat_interval_ms after the long press
+    GESTURE_LONG_RELEASE,   // Button released after a long press
+    GESTURE_TYPE_COUNT
+} gesture_type_t;
+
+#define GESTURE_MASK(type) (1u << (type))
+#define GESTURE_MASK_ALL ((1u << GESTURE_TYPE_COUNT) - 1)
+
+typedef struct {
+    gesture_type_t type;
+    uint16_t count;         // CLICK/LONG_PRESS: presses in the sequence. HOLD_REPEAT: repeat number
+    int64_t time_us;        // When the gesture was recognized
+    uint32_t duration_ms;   // LONG_RELEASE: how long the button was held
+} gesture_event_t;
+
+typedef void (*gesture_cb_t)(const gesture_event_t *evt, void *arg);
+
+typedef struct {
+    uint32_t debounce_ms;           // Edges closer than this to the previous accepted edge are bounces
+    uint32_t long_press_ms;         // Hold time that turns a press into a long press
+    uint32_t multi_click_gap_ms;    // Max release-to-press gap chaining clicks into one sequence
+    uint32_t repeat_interval_ms;    // Hold-repeat period, 0 disables hold-repeat
+    uint8_t max_clicks;             // Report a click sequence as soon as it reaches this count, 0 = no limit
+} gesture_config_t;
+
+#define GESTURE_CONFIG_DEFAULT() {  \
+    .debounce_ms = 20,              \
+    .long_press_ms = 500,           \
+    .multi_click_gap_ms = 250,      \
+    .repeat_interval_ms = 200,      \
+    .max_clicks = 0,                \
+}
+
+typedef struct {
+    gesture_config_t config;
+    struct {
+        uint32_t mask;
+        gesture_cb_t cb;
+        void *arg;
+    } subscribers[GESTURE_MAX_SUBSCRIBERS];
+    uint8_t state;              // Internal recognizer state
+    uint8_t level;              // Debounced button level
+    uint8_t raw_level;          // Last level seen, possibly still bouncing
+    uint8_t count;              // Presses in the current sequence
+    uint16_t repeats;           // Hold-repeats emitted since the long press
+    int64_t last_edge_us;       // Last accepted edge
+    int64_t press_us;           // Start of the current press
+    int64_t deadline_us;        // Next timing decision
+} gesture_t;
+
+void gesture_init(gesture_t *g, const gesture_config_t *config);
+
+// Deliver the gestures of types_mask to cb. Returns false when all slots are taken
+bool gesture_subscribe(gesture_t *g, uint32_t types_mask, gesture_cb_t cb, void *arg);
+
+// Feed a raw button edge. Deadlines before time_us are processed first
+void gesture_edge(gesture_t *g, uint8_t level, int64_t time_us);
+
+// Process every deadline up to now_us
+void gesture_poll(gesture_t *g, int64_t now_us);
+
+// When gesture_poll() has something to do next, GESTURE_NO_DEADLINE if nothing
+int64_t gesture_next_deadline(const gesture_t *g);
+
+#ifdef __cplusplus
+}
+#endif
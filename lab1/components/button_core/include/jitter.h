@@ -0,0 +1,42 @@
+/* Period jitter statistics
+
+   Compares the intervals between the timestamps of a periodic action (the
+   LED toggles of a blink, for instance) with its nominal period. The error
+   of each interval gives the jitter, the sum of the errors gives the drift
+   of the last timestamp against the nominal schedule.
+
+   This file has no ESP-IDF dependency and builds for the target and for Linux.
+*/
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int64_t nominal_us;     // Expected interval
+    int64_t first_us;       // Timestamp that started the measurement
+    int64_t last_us;        // Latest timestamp
+    uint32_t count;         // Intervals measured
+    int64_t min_err_us;     // Shortest interval minus nominal
+    int64_t max_err_us;     // Longest interval minus nominal
+    int64_t sum_abs_err_us; // Sum of |interval - nominal|
+} jitter_t;
+
+// Start a measurement at time_us
+void jitter_start(jitter_t *j, int64_t nominal_us, int64_t time_us);
+
+// Add the next timestamp of the periodic action
+void jitter_add(jitter_t *j, int64_t time_us);
+
+// Mean |interval - nominal|, 0 before the first interval
+int64_t jitter_mean_abs_err_us(const jitter_t *j);
+
+// Last timestamp minus its nominal time: positive when the action runs late
+int64_t jitter_drift_us(const jitter_t *j);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,45 @@
+/* Log-scale latency histogram
+
+   Buckets are 4 per power of two, so a bucket spans at most 25% of its
+   lower bound, from 0 to UINT32_MAX in 124 buckets. Recording is a few
+   integer operations and the whole histogram is 512 bytes, cheap enough to
+   keep one for each measured path.
+
+   This file has no ESP-IDF dependency and builds for the target and for Linux.
+*/
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LATENCY_HIST_SUB_BITS 2                             // 2^2 buckets per power of two
+#define LATENCY_HIST_SUB_BUCKETS (1 << LATENCY_HIST_SUB_BITS)
+#define LATENCY_HIST_NUM_BUCKETS ((32 - LATENCY_HIST_SUB_BITS + 1) * LATENCY_HIST_SUB_BUCKETS)
+
+typedef struct {
+    uint32_t counts[LATENCY_HIST_NUM_BUCKETS];
+    uint32_t count;     // Values recorded
+    uint32_t min;
+    uint32_t max;
+} latency_hist_t;
+
+// Forget every value
+void latency_hist_reset(latency_hist_t *hist);
+
+// Bucket holding value
+int latency_hist_bucket(uint32_t value);
+
+// Smallest value of a bucket, the next bucket starts where it ends
+uint32_t latency_hist_bucket_lower(int bucket);
+
+void latency_hist_record(latency_hist_t *hist, uint32_t value);
+
+// Upper bound of the value below which percent % of the values fall, clamped to [min, max]. 0 when empty
+uint32_t latency_hist_percentile(const latency_hist_t *hist, unsigned percent);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,87 @@
+/* Lock-free ring of deferred log records
+
+   The hot path stores a compact record {timestamp, tag, format, 3 words of
+   arguments} and returns, the formatting is done later by the consumer.
+   One producer and one consumer: each side owns one index and only reads the
+   other, so neither needs a lock or a critical section. A full ring drops the
+   new record and counts it.
+
+   Arguments are captured as 32-bit words when the record is written: integers
+   up to 32 bits and pointers to strings that outlive the record (literals).
+
+   This file has no ESP-IDF dependency and builds for the target and for Linux.
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOG_RING_SIZE 64        // Records, power of two
+#define LOG_RING_MAX_ARGS 3
+
+typedef struct {
+    uint32_t time_ms;                   // When the record was written
+    const char *tag;
+    const char *fmt;                    // printf format of at most LOG_RING_MAX_ARGS arguments
+    uint32_t args[LOG_RING_MAX_ARGS];
+} log_record_t;
+
+typedef struct {
+    log_record_t records[LOG_RING_SIZE];
+    atomic_uint_fast32_t head;          // Next record to write, producer side
+    atomic_uint_fast32_t tail;          // Next record to read, consumer side
+    uint32_t dropped;                   // Records lost on a full ring, producer side
+} log_ring_t;
+
+_Static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE must be a power of two");
+
+void log_ring_init(log_ring_t *ring);
+
+// Producer: append a record. Returns false, and counts it, when the ring is full
+static inline bool log_ring_put(log_ring_t *ring, const log_record_t *rec)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail == LOG_RING_SIZE) {
+        ring->dropped++;
+        return false;
+    }
+    ring->records[head & (LOG_RING_SIZE - 1)] = *rec;
+    // Publish the record before the new head
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+// Consumer: take the oldest record. Returns false when the ring is empty
+static inline bool log_ring_get(log_ring_t *ring, log_record_t *rec)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+    *rec = ring->records[tail & (LOG_RING_SIZE - 1)];
+    // Free the slot only once it has been copied
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+// Either side: records waiting, a snapshot that the other side may change right away
+static inline uint32_t log_ring_count(log_ring_t *ring)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    return atomic_load_explicit(&ring->head, memory_order_acquire) - tail;
+}
+
+// Format the message of rec (without timestamp and tag) into buf
+int log_ring_format(const log_record_t *rec, char *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
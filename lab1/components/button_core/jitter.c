@@ -0,0 +1,38 @@
+/* Period jitter statistics
+*/
+#include "jitter.h"
+
+void jitter_start(jitter_t *j, int64_t nominal_us, int64_t time_us)
+{
+    j->nominal_us = nominal_us;
+    j->first_us = time_us;
+    j->last_us = time_us;
+    j->count = 0;
+    j->min_err_us = INT64_MAX;
+    j->max_err_us = INT64_MIN;
+    j->sum_abs_err_us = 0;
+}
+
+void jitter_add(jitter_t *j, int64_t time_us)
+{
+    int64_t err = time_us - j->last_us - j->nominal_us;
+    if (err < j->min_err_us) {
+        j->min_err_us = err;
+    }
+    if (err > j->max_err_us) {
+        j->max_err_us = err;
+    }
+    j->sum_abs_err_us += err < 0 ? -err : err;
+    j->last_us = time_us;
+    j->count++;
+}
+
+int64_t jitter_mean_abs_err_us(const jitter_t *j)
+{
+    return j->count ? j->sum_abs_err_us / j->count : 0;
+}
+
+int64_t jitter_drift_us(const jitter_t *j)
+{
+    return j->last_us - j->first_us - (int64_t)j->count * j->nominal_us;
+}
@@ -0,0 +1,69 @@
+/* Log-scale latency histogram
+*/
+#include <string.h>
+#include "latency_hist.h"
+
+void latency_hist_reset(latency_hist_t *hist)
+{
+    memset(hist->counts, 0, sizeof(hist->counts));
+    hist->count = 0;
+    hist->min = UINT32_MAX;
+    hist->max = 0;
+}
+
+int latency_hist_bucket(uint32_t value)
+{
+    if (value < LATENCY_HIST_SUB_BUCKETS) {
+        return value;
+    }
+    // Position of the top bit, then the SUB_BITS bits right below it select the sub-bucket
+    int top = 31 - __builtin_clz(value);
+    int shift = top - LATENCY_HIST_SUB_BITS;
+    return (shift + 1) * LATENCY_HIST_SUB_BUCKETS + ((value >> shift) & (LATENCY_HIST_SUB_BUCKETS - 1));
+}
+
+uint32_t latency_hist_bucket_lower(int bucket)
+{
+    if (bucket < LATENCY_HIST_SUB_BUCKETS) {
+        return bucket;
+    }
+    int shift = bucket / LATENCY_HIST_SUB_BUCKETS - 1;
+    uint32_t sub = bucket % LATENCY_HIST_SUB_BUCKETS;
+    return (LATENCY_HIST_SUB_BUCKETS + sub) << shift;
+}
+
+void latency_hist_record(latency_hist_t *hist, uint32_t value)
+{
+    hist->counts[latency_hist_bucket(value)]++;
+    hist->count++;
+    if (value < hist->min) {
+        hist->min = value;
+    }
+    if (value > hist->max) {
+        hist->max = value;
+    }
+}
+
+uint32_t latency_hist_percentile(const latency_hist_t *hist, unsigned percent)
+{
+    if (hist->count == 0) {
+        return 0;
+    }
+    // Rank of the value, rounded up so that p100 is the last one
+    uint64_t rank = ((uint64_t)hist->count * percent + 99) / 100;
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (int b = 0; b < LATENCY_HIST_NUM_BUCKETS; b++) {
+        seen += hist->counts[b];
+        if (seen >= rank) {
+            uint32_t upper = b + 1 < LATENCY_HIST_NUM_BUCKETS ? latency_hist_bucket_lower(b + 1) - 1 : UINT32_MAX;
+            if (upper > hist->max) {
+                upper = hist->max;
+            }
+            return upper < hist->min ? hist->min : upper;
+        }
+    }
+    return hist->max;
+}
@@ -0,0 +1,17 @@
+/* Lock-free ring of deferred log records
+*/
+#include <stdio.h>
+#include "log_ring.h"
+
+void log_ring_init(log_ring_t *ring)
+{
+    atomic_store(&ring->head, 0);
+    atomic_store(&ring->tail, 0);
+    ring->dropped = 0;
+}
+
+int log_ring_format(const log_record_t *rec, char *buf, size_t size)
+{
+    // Unused arguments are ignored by snprintf
+    return snprintf(buf, size, rec->fmt, rec->args[0], rec->args[1], rec->args[2]);
+}
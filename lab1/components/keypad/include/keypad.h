@@ -0,0 +1,35 @@
+/* Keypad scanner: up to 32 buttons debounced in parallel
+
+   Every scan samples the whole GPIO input register once and feeds it to
+   the bit-parallel debouncer of debounce.h, so the cost per scan does not
+   depend on the number of buttons. The caller owns the scan loop and runs
+   keypad_scan() at its own period, e.g. together with the state machines
+   fed by the debounced levels. Only GPIO0..GPIO31 can be scanned.
+*/
+#pragma once
+
+#include <stdint.h>
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#include "esp_err.h"
+#include "debounce.h"
+
+typedef struct {
+    debounce_t debounce;    // Debounced levels of the pins, state bit n = GPIOn pressed
+} keypad_t;
+
+// Configure the pins of pin_mask as inputs, pulled to their released level, and take
+// their current levels as settled. ESP_ERR_INVALID_ARG when a pin is not a GPIO
+esp_err_t keypad_init(keypad_t *kp, uint32_t pin_mask, uint32_t active_low);
+
+// Sample every pin at the same instant, returns the accepted edges
+static inline debounce_edges_t keypad_scan(keypad_t *kp)
+{
+    return debounce_update(&kp->debounce, REG_READ(GPIO_IN_REG));
+}
+
+// Debounced levels, bit n = GPIOn pressed
+static inline uint32_t keypad_state(const keypad_t *kp)
+{
+    return kp->debounce.state;
+}
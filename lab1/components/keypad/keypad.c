@@ -0,0 +1,36 @@
+/* Keypad scanner: up to 32 buttons debounced in parallel
+*/
+#include "driver/gpio.h"
+#include "esp_check.h"
+#include "keypad.h"
+
+static const char *TAG = "keypad";
+
+esp_err_t keypad_init(keypad_t *kp, uint32_t pin_mask, uint32_t active_low)
+{
+    ESP_RETURN_ON_FALSE(kp && pin_mask, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    for (int pin = 0; pin < 32; pin++) {
+        ESP_RETURN_ON_FALSE(!((pin_mask >> pin) & 1) || GPIO_IS_VALID_GPIO(pin), ESP_ERR_INVALID_ARG, TAG,
+                            "GPIO%d is not a valid input", pin);
+    }
+
+    // Active low buttons idle high through the pull-up, the others idle low
+    gpio_config_t io_conf = {
+        .mode = GPIO_MODE_INPUT,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    if (pin_mask & active_low) {
+        io_conf.pin_bit_mask = pin_mask & active_low;
+        io_conf.pull_up_en = GPIO_PULLUP_ENABLE;
+        io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
+        ESP_RETURN_ON_ERROR(gpio_config(&io_conf), TAG, "configure active low pins failed");
+    }
+    if (pin_mask & ~active_low) {
+        io_conf.pin_bit_mask = pin_mask & ~active_low;
+        io_conf.pull_up_en = GPIO_PULLUP_DISABLE;
+        io_conf.pull_down_en = GPIO_PULLDOWN_ENABLE;
+        ESP_RETURN_ON_ERROR(gpio_config(&io_conf), TAG, "configure active high pins failed");
+    }
+    debounce_init(&kp->debounce, pin_mask, active_low, REG_READ(GPIO_IN_REG));
+    return ESP_OK;
+}
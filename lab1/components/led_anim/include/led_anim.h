@@ -0,0 +1,90 @@
+/* Layered LED strip animations
+
+   An animation is a stack of layers, each an effect (solid color, chase,
+   fade, sparkle) on a range of pixels, composited bottom to top with a
+   blend mode and an opacity into an RGB framebuffer, over black. A frame
+   is a pure function of its time: nothing is kept from one frame to the
+   next, so frames skipped by a late scheduler leave no trace and a frame
+   can be rendered again for any time.
+
+   led_anim_stats_t accumulates the per frame figures of a player: frames
+   sent and dropped, render time and wire time.
+
+   This file has no ESP-IDF dependency and builds for the target and for Linux.
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LED_ANIM_MAX_LAYERS 8
+
+typedef enum {
+    LED_ANIM_SOLID,     // The color on every pixel
+    LED_ANIM_CHASE,     // A head going round the range once per period, followed by a fading tail of size pixels
+    LED_ANIM_FADE,      // The color fading in then out once per period, on every pixel
+    LED_ANIM_SPARKLE,   // Once per period, each pixel sparks with a chance of size/256 and fades in half a period
+} led_anim_effect_t;
+
+typedef enum {
+    LED_ANIM_BLEND_NORMAL,      // Layer over what is below, weighted by its intensity
+    LED_ANIM_BLEND_ADD,         // Sum, saturated
+    LED_ANIM_BLEND_MULTIPLY,    // Filter what is below through the layer color
+    LED_ANIM_BLEND_MAX,         // Brightest of each component
+} led_anim_blend_t;
+
+typedef struct {
+    led_anim_effect_t effect;
+    led_anim_blend_t blend;
+    uint8_t color[3];       // R, G, B
+    uint8_t opacity;        // 255 opaque, 0 hidden
+    uint32_t start;         // First pixel
+    uint32_t count;         // Pixels, 0 up to the end of the strip
+    uint32_t period_ms;     // Unused by LED_ANIM_SOLID
+    uint16_t size;          // Tail length of LED_ANIM_CHASE, spark chance of LED_ANIM_SPARKLE
+} led_anim_layer_t;
+
+typedef struct {
+    uint32_t num_leds;
+    uint8_t num_layers;
+    led_anim_layer_t layers[LED_ANIM_MAX_LAYERS];  // Bottom first
+} led_anim_t;
+
+// Empty animation of num_leds pixels, renders black
+void led_anim_init(led_anim_t *anim, uint32_t num_leds);
+
+// Put a layer on top of the others. Returns its index, -1 if the stack is full or the layer invalid
+int led_anim_add_layer(led_anim_t *anim, const led_anim_layer_t *layer);
+
+// Render the frame at time_us into rgb, num_leds * 3 bytes
+void led_anim_render(const led_anim_t *anim, int64_t time_us, uint8_t *rgb);
+
+typedef struct {
+    uint32_t frames;            // Frames rendered and sent
+    uint32_t dropped;           // Frame slots skipped because the previous frame was late
+    uint32_t render_us_max;
+    uint64_t render_us_total;
+    uint32_t wire_us_max;       // From the start of the refresh to the end of the transmission
+    uint64_t wire_us_total;
+    uint32_t wire_frames;       // Frames whose wire time is known
+} led_anim_stats_t;
+
+void led_anim_stats_reset(led_anim_stats_t *stats);
+
+// Count a frame rendered in render_us, after dropped skipped slots
+void led_anim_stats_add_frame(led_anim_stats_t *stats, uint32_t render_us, uint32_t dropped);
+
+// Count the wire time of a frame, known once it is transmitted
+void led_anim_stats_add_wire(led_anim_stats_t *stats, uint32_t wire_us);
+
+// Mean render and wire times, 0 before the first frame
+uint32_t led_anim_stats_render_us_mean(const led_anim_stats_t *stats);
+uint32_t led_anim_stats_wire_us_mean(const led_anim_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,169 @@
+/* Layered LED strip animations
+*/
+#include <string.h>
+#include "led_anim.h"
+
+// round(a * b / 255) for a, b in 0..255
+static inline uint8_t mul8(uint32_t a, uint32_t b)
+{
+    uint32_t x = a * b + 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// Pseudo-random and stateless: the same pixel, period and layer always give the same value
+static uint32_t hash3(uint32_t a, uint32_t b, uint32_t c)
+{
+    uint32_t x = a * 0x9E3779B1u ^ b * 0x85EBCA77u ^ c * 0xC2B2AE3Du;
+    x ^= x >> 15;
+    x *= 0x2C1B3C6Du;
+    x ^= x >> 12;
+    x *= 0x297A2D39u;
+    x ^= x >> 15;
+    return x;
+}
+
+void led_anim_init(led_anim_t *anim, uint32_t num_leds)
+{
+    memset(anim, 0, sizeof(*anim));
+    anim->num_leds = num_leds;
+}
+
+int led_anim_add_layer(led_anim_t *anim, const led_anim_layer_t *layer)
+{
+    if (anim->num_layers >= LED_ANIM_MAX_LAYERS || layer->start >= anim->num_leds) {
+        return -1;
+    }
+    if (layer->effect > LED_ANIM_SPARKLE || layer->blend > LED_ANIM_BLEND_MAX) {
+        return -1;
+    }
+    if (layer->effect != LED_ANIM_SOLID && layer->period_ms == 0) {
+        return -1;
+    }
+    anim->layers[anim->num_layers] = *layer;
+    return anim->num_layers++;
+}
+
+static void blend_pixel(uint8_t *dst, const uint8_t *color, uint8_t alpha, led_anim_blend_t blend)
+{
+    for (int c = 0; c < 3; c++) {
+        uint32_t d = dst[c];
+        uint32_t s = color[c];
+        switch (blend) {
+        case LED_ANIM_BLEND_NORMAL:
+            d = s > d ? d + mul8(s - d, alpha) : d - mul8(d - s, alpha);
+            break;
+        case LED_ANIM_BLEND_ADD:
+            d += mul8(s, alpha);
+            d = d > 255 ? 255 : d;
+            break;
+        case LED_ANIM_BLEND_MULTIPLY:
+            // the color faded towards white by the missing intensity
+            d = mul8(d, 255 - mul8(255 - s, alpha));
+            break;
+        default:
+            s = mul8(s, alpha);
+            d = s > d ? s : d;
+            break;
+        }
+        dst[c] = d;
+    }
+}
+
+// Composite a layer over the count pixels of its range, rgb pointing to the first one
+static void render_layer(const led_anim_layer_t *layer, uint32_t seed, uint32_t count, int64_t time_us, uint8_t *rgb)
+{
+    uint64_t period_us = (uint64_t)layer->period_ms * 1000;
+    uint64_t phase_us = period_us ? (uint64_t)time_us % period_us : 0;
+    uint8_t fade = 255;
+    uint32_t head = 0;
+    uint32_t tail = layer->size ? layer->size : 1;
+    uint64_t cycle = period_us ? (uint64_t)time_us / period_us : 0;
+    uint64_t spark_us = period_us / 2;
+
+    switch (layer->effect) {
+    case LED_ANIM_CHASE:
+        head = phase_us * count / period_us;
+        break;
+    case LED_ANIM_FADE: {
+        // triangle, up in the first half and down in the second
+        uint64_t ramp = phase_us < spark_us ? phase_us : period_us - phase_us;
+        fade = spark_us ? (ramp * 255 + spark_us / 2) / spark_us : 255;
+        break;
+    }
+    default:
+        break;
+    }
+
+    for (uint32_t i = 0; i < count; i++, rgb += 3) {
+        uint8_t intensity = fade;
+        if (layer->effect == LED_ANIM_CHASE) {
+            uint32_t behind = head >= i ? head - i : head + count - i;
+            if (behind >= tail) {
+                continue;
+            }
+            intensity = 255 - behind * 255 / tail;
+        } else if (layer->effect == LED_ANIM_SPARKLE) {
+            uint32_t h = hash3(i, (uint32_t)cycle, seed);
+            if ((h & 0xFF) >= layer->size || spark_us == 0) {
+                continue;
+            }
+            // sparks start in the first half, so that they end within the period
+            uint64_t start_us = (h >> 8) % spark_us;
+            if (phase_us < start_us || phase_us - start_us >= spark_us) {
+                continue;
+            }
+            intensity = 255 - (phase_us - start_us) * 255 / spark_us;
+        }
+        uint8_t alpha = mul8(intensity, layer->opacity);
+        if (alpha) {
+            blend_pixel(rgb, layer->color, alpha, layer->blend);
+        }
+    }
+}
+
+void led_anim_render(const led_anim_t *anim, int64_t time_us, uint8_t *rgb)
+{
+    memset(rgb, 0, anim->num_leds * 3);
+    for (int l = 0; l < anim->num_layers; l++) {
+        const led_anim_layer_t *layer = &anim->layers[l];
+        uint32_t count = anim->num_leds - layer->start;
+        if (layer->count && layer->count < count) {
+            count = layer->count;
+        }
+        render_layer(layer, l, count, time_us, rgb + layer->start * 3);
+    }
+}
+
+void led_anim_stats_reset(led_anim_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+void led_anim_stats_add_frame(led_anim_stats_t *stats, uint32_t render_us, uint32_t dropped)
+{
+    stats->frames++;
+    stats->dropped += dropped;
+    stats->render_us_total += render_us;
+    if (render_us > stats->render_us_max) {
+        stats->render_us_max = render_us;
+    }
+}
+
+void led_anim_stats_add_wire(led_anim_stats_t *stats, uint32_t wire_us)
+{
+    stats->wire_frames++;
+    stats->wire_us_total += wire_us;
+    if (wire_us > stats->wire_us_max) {
+        stats->wire_us_max = wire_us;
+    }
+}
+
+uint32_t led_anim_stats_render_us_mean(const led_anim_stats_t *stats)
+{
+    return stats->frames ? stats->render_us_total / stats->frames : 0;
+}
+
+uint32_t led_anim_stats_wire_us_mean(const led_anim_stats_t *stats)
+{
+    return stats->wire_frames ? stats->wire_us_total / stats->wire_frames : 0;
+}
@@ -0,0 +1,361 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "led_strip_rmt.h"
+#include "led_strip_spi.h"
+#include "led_strip_group.h"
+#include "led_strip_dither.h"
+#include "led_strip_rle.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Set RGB for a specific pixel
+ *
+ * @param strip: LED strip
+ * @param index: index of pixel to set
+ * @param red: red part of color
+ * @param green: green part of color
+ * @param blue: blue part of color
+ *
+ * @return
+ *      - ESP_OK: Set RGB for a specific pixel successfully
+ *      - ESP_ERR_INVALID_ARG: Set RGB for a specific pixel failed because of invalid parameters
+ *      - ESP_FAIL: Set RGB for a specific pixel failed because other error occurred
+ */
+esp_err_t led_strip_set_pixel(led_strip_handle_t strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue);
+
+/**
+ * @brief Set RGBW for a specific pixel
+ *
+ * @note Only call this function if your led strip does have the white component (e.g. SK6812-RGBW)
+ * @note Also see `led_strip_set_pixel` if you only want to specify the RGB part of the color and bypass the white component
+ *
+ * @param strip: LED strip
+ * @param index: index of pixel to set
+ * @param red: red part of color
+ * @param green: green part of color
+ * @param blue: blue part of color
+ * @param white: separate white component
+ *
+ * @return
+ *      - ESP_OK: Set RGBW color for a specific pixel successfully
+ *      - ESP_ERR_INVALID_ARG: Set RGBW color for a specific pixel failed because of an invalid argument
+ *      - ESP_FAIL: Set RGBW color for a specific pixel failed because other error occurred
+ */
+esp_err_t led_strip_set_pixel_rgbw(led_strip_handle_t strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white);
+
+/**
+ * @brief Set RGB for a range of pixels
+ *
+ * @note Faster than calling `led_strip_set_pixel` for each pixel: the range is checked once and the backend
+ *       converts all the pixels in one loop, or copies them when the strip expects the R, G, B order
+ *
+ * @param strip: LED strip
+ * @param start: index of the first pixel to set
+ * @param count: number of pixels to set
+ * @param rgb: colors, 3 bytes per pixel in R, G, B order
+ *
+ * @return
+ *      - ESP_OK: Set RGB for the pixels successfully
+ *      - ESP_ERR_INVALID_ARG: Set RGB for the pixels failed because of invalid parameters
+ *      - ESP_FAIL: Set RGB for the pixels failed because other error occurred
+ */
+esp_err_t led_strip_set_pixels(led_strip_handle_t strip, uint32_t start, uint32_t count, const uint8_t *rgb);
+
+/**
+ * @brief Set RGBW for a range of pixels
+ *
+ * @note Only call this function if your led strip does have the white component (e.g. SK6812-RGBW)
+ *
+ * @param strip: LED strip
+ * @param start: index of the first pixel to set
+ * @param count: number of pixels to set
+ * @param rgbw: colors, 4 bytes per pixel in R, G, B, W order
+ *
+ * @return
+ *      - ESP_OK: Set RGBW for the pixels successfully
+ *      - ESP_ERR_INVALID_ARG: Set RGBW for the pixels failed because of invalid parameters
+ *      - ESP_FAIL: Set RGBW for the pixels failed because other error occurred
+ */
+esp_err_t led_strip_set_pixels_rgbw(led_strip_handle_t strip, uint32_t start, uint32_t count, const uint8_t *rgbw);
+
+/**
+ * @brief Set HSV for a specific pixel
+ *
+ * @param strip: LED strip
+ * @param index: index of pixel to set
+ * @param hue: hue part of color (0 - 360)
+ * @param saturation: saturation part of color (0 - 255, rescaled from 0 - 1. e.g. saturation = 0.5, rescaled to 127)
+ * @param value: value part of color (0 - 255, rescaled from 0 - 1. e.g. value = 0.5, rescaled to 127)
+ *
+ * @return
+ *      - ESP_OK: Set HSV color for a specific pixel successfully
+ *      - ESP_ERR_INVALID_ARG: Set HSV color for a specific pixel failed because of an invalid argument
+ *      - ESP_FAIL: Set HSV color for a specific pixel failed because other error occurred
+ */
+esp_err_t led_strip_set_pixel_hsv(led_strip_handle_t strip, uint32_t index, uint16_t hue, uint8_t saturation, uint8_t value);
+
+/**
+ * @brief Convert HSV colors to R, G, B bytes
+ *
+ * @note Integer arithmetic only, with the colors of `led_strip_set_pixel_hsv`
+ *
+ * @param hsv: colors to convert
+ * @param count: number of colors
+ * @param rgb: 3 * count bytes, R, G, B of each color
+ *
+ * @return
+ *      - ESP_OK: Converted successfully
+ *      - ESP_ERR_INVALID_ARG: Convert failed because of invalid parameters
+ */
+esp_err_t led_strip_hsv_to_rgb(const led_strip_hsv_t *hsv, uint32_t count, uint8_t *rgb);
+
+/**
+ * @brief Set HSV for consecutive pixels
+ *
+ * @note The colors are converted by blocks handed to `led_strip_set_pixels`, instead of one backend call per pixel
+ *
+ * @param strip: LED strip
+ * @param start: index of the first pixel to set
+ * @param count: number of pixels to set
+ * @param hsv: count colors
+ *
+ * @return
+ *      - ESP_OK: Set HSV colors successfully
+ *      - ESP_ERR_INVALID_ARG: Set HSV colors failed because of invalid parameters, or pixels out of the strip
+ *      - ESP_FAIL: Set HSV colors failed because other error occurred
+ */
+esp_err_t led_strip_set_pixels_hsv(led_strip_handle_t strip, uint32_t start, uint32_t count, const led_strip_hsv_t *hsv);
+
+/**
+ * @brief Fill consecutive pixels with a gradient between two HSV colors
+ *
+ * @note The first and the last pixels get the two colors. The hue goes in a straight line from from->hue to to->hue,
+ *       hues up to 720 are accepted so that a gradient can cross red: 300 to 420 goes through magenta, red and orange.
+ *
+ * @param strip: LED strip
+ * @param start: index of the first pixel to set
+ * @param count: number of pixels to set
+ * @param from: color of the first pixel
+ * @param to: color of the last pixel
+ *
+ * @return
+ *      - ESP_OK: Fill successfully
+ *      - ESP_ERR_INVALID_ARG: Fill failed because of invalid parameters, or pixels out of the strip
+ *      - ESP_FAIL: Fill failed because other error occurred
+ */
+esp_err_t led_strip_fill_gradient(led_strip_handle_t strip, uint32_t start, uint32_t count, const led_strip_hsv_t *from, const led_strip_hsv_t *to);
+
+/**
+ * @brief Fill consecutive pixels with one turn of the color wheel
+ *
+ * @param strip: LED strip
+ * @param start: index of the first pixel to set
+ * @param count: number of pixels to set
+ * @param first_hue: hue of the first pixel (0 - 360), the hue then increases by 360 / count per pixel
+ * @param saturation: saturation of all pixels (0 - 255)
+ * @param value: value of all pixels (0 - 255)
+ *
+ * @return
+ *      - ESP_OK: Fill successfully
+ *      - ESP_ERR_INVALID_ARG: Fill failed because of invalid parameters, or pixels out of the strip
+ *      - ESP_FAIL: Fill failed because other error occurred
+ */
+esp_err_t led_strip_fill_rainbow(led_strip_handle_t strip, uint32_t start, uint32_t count, uint16_t first_hue, uint8_t saturation, uint8_t value);
+
+/**
+ * @brief Refresh memory colors to LEDs
+ *
+ * @param strip: LED strip
+ *
+ * @return
+ *      - ESP_OK: Refresh successfully
+ *      - ESP_FAIL: Refresh failed because some other error occurred
+ *
+ * @note:
+ *      After updating the LED colors in the memory, a following invocation of this API is needed to flush colors to strip.
+ */
+esp_err_t led_strip_refresh(led_strip_handle_t strip);
+
+/**
+ * @brief Start flushing the memory colors to the LEDs and return without waiting for the transmission
+ *
+ * @note Waits for the previous refresh, if still in progress, before starting this one
+ * @note With the `double_buffer` flag, the pixels can be set again as soon as this function returns, they go to the next frame.
+ *       Without it, the pixels must not be set before `led_strip_refresh_wait_done` returns.
+ * @note A backend without asynchronous support refreshes synchronously
+ *
+ * @param strip: LED strip
+ *
+ * @return
+ *      - ESP_OK: Refresh started successfully
+ *      - ESP_FAIL: Refresh failed because some other error occurred
+ */
+esp_err_t led_strip_refresh_async(led_strip_handle_t strip);
+
+/**
+ * @brief Wait for the refresh started by `led_strip_refresh_async` to be transmitted
+ *
+ * @param strip: LED strip
+ * @param timeout_ms: how long to wait, -1 to wait forever
+ *
+ * @return
+ *      - ESP_OK: No refresh in progress anymore
+ *      - ESP_ERR_TIMEOUT: The refresh is still in progress after timeout_ms
+ *      - ESP_FAIL: Wait failed because some other error occurred
+ */
+esp_err_t led_strip_refresh_wait_done(led_strip_handle_t strip, int32_t timeout_ms);
+
+/**
+ * @brief Send a frame of a run-length encoded show, without waiting for it to be transmitted
+ *
+ * @note The runs are decoded while the frame is on the wire, from where they are stored: a show mapped from flash
+ *       plays without being unpacked into the pixels of the strip, which are left as they are for the next `led_strip_refresh`.
+ * @note Waits for the previous refresh, if still in progress, and uses the color table like any refresh.
+ *       The runs must stay readable until `led_strip_refresh_wait_done` returns.
+ *
+ * @param strip: LED strip
+ * @param show: show opened with `led_strip_rle_open`, in the component format of the strip
+ * @param frame: frame of the show, from `led_strip_rle_next_frame`
+ *
+ * @return
+ *      - ESP_OK: Refresh started successfully
+ *      - ESP_ERR_INVALID_ARG: Refresh failed because of invalid parameters, or a show longer than the strip or of other pixels
+ *      - ESP_ERR_INVALID_STATE: The strip keeps palette indices
+ *      - ESP_ERR_NOT_SUPPORTED: The backend does not decode shows
+ *      - ESP_FAIL: Refresh failed because some other error occurred
+ */
+esp_err_t led_strip_refresh_rle_async(led_strip_handle_t strip, const led_strip_rle_show_t *show, const led_strip_rle_frame_t *frame);
+
+/**
+ * @brief Set the callbacks of the LED strip events
+ *
+ * @note Call it while no refresh is in progress. The callbacks run in ISR context.
+ *
+ * @param strip: LED strip
+ * @param cbs: callbacks, NULL members are disabled
+ * @param user_ctx: user context passed to the callbacks
+ *
+ * @return
+ *      - ESP_OK: Callbacks set successfully
+ *      - ESP_ERR_INVALID_ARG: Set callbacks failed because of invalid parameters
+ *      - ESP_ERR_NOT_SUPPORTED: The backend does not report events
+ */
+esp_err_t led_strip_register_event_callbacks(led_strip_handle_t strip, const led_strip_event_callbacks_t *cbs, void *user_ctx);
+
+/**
+ * @brief Set a lookup table every color component goes through when the pixels are sent
+ *
+ * @note The pixels keep their linear values, so that a global brightness or gamma change is a table swap instead of setting every pixel again
+ * @note The table is used from the next refresh on, and is kept by reference: it must stay valid until it is replaced
+ *
+ * @param strip: LED strip
+ * @param lut: 256 entries indexed by the color component value, NULL to send the values as they are
+ *
+ * @return
+ *      - ESP_OK: Set the table successfully
+ *      - ESP_ERR_INVALID_ARG: Set the table failed because of invalid parameters
+ *      - ESP_ERR_NOT_SUPPORTED: The backend does not apply color tables
+ */
+esp_err_t led_strip_set_color_lut(led_strip_handle_t strip, const uint8_t *lut);
+
+/**
+ * @brief Set consecutive colors of the palette of a strip created with `palette_bits`
+ *
+ * @note Every pixel refers to its color by index, so changing an entry recolors all the pixels using it
+ *       for the cost of the entry only. The palette is read when a refresh starts, it can be changed as
+ *       soon as `led_strip_refresh_async` returns.
+ *
+ * @param strip: LED strip
+ * @param start: index of the first entry to set
+ * @param count: number of entries to set, up to the 16 or 256 entries of the palette
+ * @param colors: count colors, R, G, B for a 3 component strip, R, G, B, W for a 4 component strip
+ *
+ * @return
+ *      - ESP_OK: Set the palette successfully
+ *      - ESP_ERR_INVALID_ARG: Set the palette failed because of invalid parameters, or entries out of the palette
+ *      - ESP_ERR_INVALID_STATE: The strip keeps a color per pixel
+ *      - ESP_ERR_NOT_SUPPORTED: The backend has no palette mode
+ */
+esp_err_t led_strip_set_palette(led_strip_handle_t strip, uint32_t start, uint32_t count, const uint8_t *colors);
+
+/**
+ * @brief Set the palette index of a pixel of a strip created with `palette_bits`
+ *
+ * @param strip: LED strip
+ * @param index: index of pixel to set
+ * @param color_index: entry of the palette
+ *
+ * @return
+ *      - ESP_OK: Set the pixel successfully
+ *      - ESP_ERR_INVALID_ARG: Set the pixel failed because of invalid parameters, or an index out of the palette
+ *      - ESP_ERR_INVALID_STATE: The strip keeps a color per pixel
+ *      - ESP_ERR_NOT_SUPPORTED: The backend has no palette mode
+ */
+esp_err_t led_strip_set_pixel_index(led_strip_handle_t strip, uint32_t index, uint8_t color_index);
+
+/**
+ * @brief Set the palette indices of consecutive pixels of a strip created with `palette_bits`
+ *
+ * @param strip: LED strip
+ * @param start: index of the first pixel to set
+ * @param count: number of pixels to set
+ * @param indices: count entries of the palette, one byte each whatever `palette_bits`
+ *
+ * @return
+ *      - ESP_OK: Set the pixels successfully
+ *      - ESP_ERR_INVALID_ARG: Set the pixels failed because of invalid parameters, or indices out of the palette
+ *      - ESP_ERR_INVALID_STATE: The strip keeps a color per pixel
+ *      - ESP_ERR_NOT_SUPPORTED: The backend has no palette mode
+ */
+esp_err_t led_strip_set_pixels_index(led_strip_handle_t strip, uint32_t start, uint32_t count, const uint8_t *indices);
+
+/**
+ * @brief Fill a color lookup table with a gamma curve scaled to a brightness
+ *
+ * @note lut[i] = brightness * (i / 255) ^ gamma, rounded
+ *
+ * @param lut: table of 256 entries to fill
+ * @param gamma: gamma exponent, 1.0 for a linear table, 2.2 to 2.8 are usual for LEDs
+ * @param brightness: output of the full input value, 255 for full brightness
+ *
+ * @return
+ *      - ESP_OK: Fill the table successfully
+ *      - ESP_ERR_INVALID_ARG: Fill the table failed because of invalid parameters
+ */
+esp_err_t led_strip_make_color_lut(uint8_t *lut, float gamma, uint8_t brightness);
+
+/**
+ * @brief Clear LED strip (turn off all LEDs)
+ *
+ * @param strip: LED strip
+ *
+ * @return
+ *      - ESP_OK: Clear LEDs successfully
+ *      - ESP_FAIL: Clear LEDs failed because some other error occurred
+ */
+esp_err_t led_strip_clear(led_strip_handle_t strip);
+
+/**
+ * @brief Free LED strip resources
+ *
+ * @param strip: LED strip
+ *
+ * @return
+ *      - ESP_OK: Free resources successfully
+ *      - ESP_FAIL: Free resources failed because error occurred
+ */
+esp_err_t led_strip_del(led_strip_handle_t strip);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,89 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "led_strip_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Type of dithered framebuffer handle
+ */
+typedef struct led_strip_dither_t *led_strip_dither_handle_t;
+
+/**
+ * @brief Dithered framebuffer configuration
+ */
+typedef struct {
+    led_strip_handle_t strip; /*!< Strip the frames are sent to, ideally created with the `double_buffer` flag */
+    uint32_t num_leds;        /*!< Number of pixels of the framebuffer, from the first pixel of the strip */
+    uint8_t num_components;   /*!< 3 for R, G, B pixels, 4 for R, G, B, W pixels */
+} led_strip_dither_config_t;
+
+/**
+ * @brief Create a framebuffer of 16 bits per color component, sent to an 8 bit strip with temporal dithering
+ *
+ * @note Each refresh quantises the framebuffer to 8 bits and carries the part that was cut off over to the next
+ *       frame of the same pixel, so that the average over a few frames has the 16 bit value. Dark gradients then
+ *       keep their steps instead of banding, as long as the strip is refreshed continuously, e.g. at 100 Hz or more.
+ *
+ * @param config Framebuffer configuration
+ * @param ret_dither Returned framebuffer handle
+ * @return
+ *      - ESP_OK: create framebuffer successfully
+ *      - ESP_ERR_INVALID_ARG: create framebuffer failed because of invalid argument
+ *      - ESP_ERR_NO_MEM: create framebuffer failed because of out of memory
+ */
+esp_err_t led_strip_new_dither(const led_strip_dither_config_t *config, led_strip_dither_handle_t *ret_dither);
+
+/**
+ * @brief Set consecutive pixels of the framebuffer
+ *
+ * @param dither: dithered framebuffer
+ * @param start: index of the first pixel to set
+ * @param count: number of pixels to set
+ * @param components: count * num_components values, R, G, B(, W) of each pixel, 0xFFFF for full intensity
+ *
+ * @return
+ *      - ESP_OK: Set pixels successfully
+ *      - ESP_ERR_INVALID_ARG: Set pixels failed because of invalid parameters, or pixels out of the framebuffer
+ */
+esp_err_t led_strip_dither_set_pixels(led_strip_dither_handle_t dither, uint32_t start, uint32_t count, const uint16_t *components);
+
+/**
+ * @brief Send the next dithered frame to the strip, without waiting for it to be transmitted
+ *
+ * @note The pixels of the strip are set before the refresh starts: unless the strip is double buffered,
+ *       wait with `led_strip_refresh_wait_done` for the previous refresh before calling it again.
+ *       The next frame is then quantised while the previous one is on the wire.
+ *
+ * @param dither: dithered framebuffer
+ *
+ * @return
+ *      - ESP_OK: Refresh started successfully
+ *      - ESP_ERR_INVALID_ARG: Refresh failed because of invalid parameters
+ *      - ESP_FAIL: Refresh failed because some other error occurred
+ */
+esp_err_t led_strip_dither_refresh_async(led_strip_dither_handle_t dither);
+
+/**
+ * @brief Delete a framebuffer, its strip is left to the caller
+ *
+ * @param dither: dithered framebuffer
+ *
+ * @return
+ *      - ESP_OK: Deleted successfully
+ *      - ESP_ERR_INVALID_ARG: Delete failed because of invalid parameters
+ */
+esp_err_t led_strip_dither_del(led_strip_dither_handle_t dither);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,104 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "led_strip_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Type of LED strip group handle
+ */
+typedef struct led_strip_group_t *led_strip_group_handle_t;
+
+/**
+ * @brief LED strip group configuration
+ */
+typedef struct {
+    const led_strip_handle_t *strips; /*!< Strips of the group, created by `led_strip_new_rmt_device` */
+    size_t num_strips;                /*!< Number of strips in the group */
+} led_strip_group_config_t;
+
+/**
+ * @brief Create a group of RMT LED strips refreshed together
+ *
+ * @note The channels of the strips are bound to an RMT sync manager, their transmissions start on the same tick.
+ *       A group refresh then takes as long as its longest strip, instead of the sum of all of them.
+ * @note Once in a group, the strips are refreshed through the group only, `led_strip_refresh` and `led_strip_clear`
+ *       on a single strip would wait for the other ones. The pixels are still set on each strip.
+ * @note Delete the group before its strips.
+ *
+ * @param config Group configuration
+ * @param ret_group Returned group handle
+ * @return
+ *      - ESP_OK: create group successfully
+ *      - ESP_ERR_INVALID_ARG: create group failed because of invalid argument, or a strip not driven by the RMT backend
+ *      - ESP_ERR_NO_MEM: create group failed because of out of memory
+ *      - ESP_ERR_NOT_SUPPORTED: the chip cannot start RMT channels synchronously
+ *      - ESP_FAIL: create group failed because some other error
+ */
+esp_err_t led_strip_new_rmt_group(const led_strip_group_config_t *config, led_strip_group_handle_t *ret_group);
+
+/**
+ * @brief Start the refresh of every strip of the group, without waiting for it to be transmitted
+ *
+ * @note It waits for the previous group refresh first. The same rules as `led_strip_refresh_async` apply to each strip.
+ *
+ * @param group: LED strip group
+ *
+ * @return
+ *      - ESP_OK: Refresh started successfully
+ *      - ESP_ERR_INVALID_ARG: Refresh failed because of invalid parameters
+ *      - ESP_FAIL: Refresh failed because some other error occurred
+ */
+esp_err_t led_strip_group_refresh_async(led_strip_group_handle_t group);
+
+/**
+ * @brief Wait for the refresh started by `led_strip_group_refresh_async` to be transmitted on every strip
+ *
+ * @param group: LED strip group
+ * @param timeout_ms: how long to wait for each strip, -1 to wait forever
+ *
+ * @return
+ *      - ESP_OK: No refresh in progress anymore
+ *      - ESP_ERR_INVALID_ARG: Wait failed because of invalid parameters
+ *      - ESP_ERR_TIMEOUT: A strip is still being refreshed after timeout_ms
+ *      - ESP_FAIL: Wait failed because some other error occurred
+ */
+esp_err_t led_strip_group_wait_done(led_strip_group_handle_t group, int32_t timeout_ms);
+
+/**
+ * @brief Refresh every strip of the group and wait for the transmissions to end
+ *
+ * @param group: LED strip group
+ *
+ * @return
+ *      - ESP_OK: Refreshed successfully
+ *      - ESP_ERR_INVALID_ARG: Refresh failed because of invalid parameters
+ *      - ESP_FAIL: Refresh failed because some other error occurred
+ */
+esp_err_t led_strip_group_refresh(led_strip_group_handle_t group);
+
+/**
+ * @brief Delete a group, its strips are left to the caller
+ *
+ * @param group: LED strip group
+ *
+ * @return
+ *      - ESP_OK: Deleted successfully
+ *      - ESP_ERR_INVALID_ARG: Delete failed because of invalid parameters
+ *      - ESP_FAIL: Delete failed because some other error occurred
+ */
+esp_err_t led_strip_group_del(led_strip_group_handle_t group);
+
+#ifdef __cplusplus
+}
+#endif
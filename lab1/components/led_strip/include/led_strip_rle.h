@@ -0,0 +1,153 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "led_strip_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Run-length encoded show, all numbers little endian:
+ *
+ *   header  "LRLE", version (1 byte), components per pixel (1 byte, 3 or 4), LEDs (2 bytes),
+ *           frames (4 bytes), frame period in microseconds (4 bytes)
+ *   frame   size of its runs (4 bytes), then the runs
+ *   run     control byte c, then
+ *             c & 0x80: one pixel, repeated (c & 0x7F) + 1 times
+ *             otherwise: c + 1 pixels
+ *
+ * Pixels are in the byte order of the LEDs, e.g. G, R, B, as the RMT encoder sends them, and each frame
+ * decodes to exactly the LEDs of the header.
+ */
+#define LED_STRIP_RLE_HEADER_SIZE 16
+#define LED_STRIP_RLE_VERSION 1
+#define LED_STRIP_RLE_MAX_RUN 128
+
+/**
+ * @brief Largest encoded frame of a strip, with its size prefix
+ */
+#define LED_STRIP_RLE_FRAME_MAX_SIZE(num_leds, num_components) \
+    (4 + (num_leds) * (num_components) + ((num_leds) + LED_STRIP_RLE_MAX_RUN - 1) / LED_STRIP_RLE_MAX_RUN)
+
+/**
+ * @brief Run-length encoded show, read in place
+ */
+typedef struct {
+    uint8_t num_components;   /*!< 3 or 4 bytes per pixel */
+    uint32_t num_leds;        /*!< Pixels of every frame */
+    uint32_t num_frames;      /*!< Frames of the show */
+    uint32_t frame_period_us; /*!< Time between two frames */
+    const uint8_t *frames;    /*!< First frame, kept by reference */
+    size_t frames_size;       /*!< Bytes of all the frames */
+} led_strip_rle_show_t;
+
+/**
+ * @brief Runs of one frame of a show
+ */
+typedef struct {
+    const uint8_t *runs;      /*!< Runs, kept by reference */
+    size_t size;              /*!< Bytes of the runs */
+} led_strip_rle_frame_t;
+
+/**
+ * @brief Decoder of the runs of a frame, resumed where it stopped
+ */
+typedef struct {
+    const uint8_t *runs;      /*!< Runs being decoded */
+    size_t size;              /*!< Bytes of the runs */
+    size_t offset;            /*!< Next byte of the runs, the color of a repeat run until it is done */
+    uint32_t remaining;       /*!< Pixels left in the current run */
+    bool repeat;              /*!< Whether the current run repeats one pixel */
+} led_strip_rle_decoder_t;
+
+/**
+ * @brief Check a show and describe it
+ *
+ * @note Every frame is walked once, so that the decoders can trust the runs afterwards.
+ *       The show can stay in flash, e.g. mapped from a partition or embedded with `EMBED_FILES`.
+ *
+ * @param data: show, with its header
+ * @param size: bytes of the show
+ * @param show: returned description, referring to data
+ *
+ * @return
+ *      - ESP_OK: The show is valid
+ *      - ESP_ERR_INVALID_ARG: Invalid parameters
+ *      - ESP_ERR_INVALID_VERSION: Not a show of this version
+ *      - ESP_ERR_INVALID_SIZE: A frame is truncated or does not decode to the LEDs of the header
+ */
+esp_err_t led_strip_rle_open(const void *data, size_t size, led_strip_rle_show_t *show);
+
+/**
+ * @brief Get a frame of a show and step to the next one
+ *
+ * @param show: show opened with `led_strip_rle_open`
+ * @param offset: 0 for the first frame, advanced past the returned frame
+ * @param frame: returned runs
+ *
+ * @return true if a frame is returned, false after the last one
+ */
+bool led_strip_rle_next_frame(const led_strip_rle_show_t *show, size_t *offset, led_strip_rle_frame_t *frame);
+
+/**
+ * @brief Write the header of a show
+ *
+ * @param show: num_components, num_leds, num_frames and frame_period_us of the show
+ * @param header: LED_STRIP_RLE_HEADER_SIZE bytes, followed by the frames written with `led_strip_rle_pack_frame`
+ *
+ * @return
+ *      - ESP_OK: Header written
+ *      - ESP_ERR_INVALID_ARG: Invalid parameters
+ */
+esp_err_t led_strip_rle_write_header(const led_strip_rle_show_t *show, uint8_t *header);
+
+/**
+ * @brief Encode a frame, with its size prefix
+ *
+ * @param pixels: num_leds pixels in the byte order of the LEDs
+ * @param num_leds: pixels of the frame
+ * @param num_components: 3 or 4 bytes per pixel
+ * @param out: encoded frame, LED_STRIP_RLE_FRAME_MAX_SIZE bytes are always enough
+ * @param out_size: bytes of out
+ * @param ret_size: returned bytes written
+ *
+ * @return
+ *      - ESP_OK: Frame encoded
+ *      - ESP_ERR_INVALID_ARG: Invalid parameters
+ *      - ESP_ERR_INVALID_SIZE: The frame does not fit in out
+ */
+esp_err_t led_strip_rle_pack_frame(const uint8_t *pixels, uint32_t num_leds, uint8_t num_components,
+                                   uint8_t *out, size_t out_size, size_t *ret_size);
+
+/**
+ * @brief Start decoding the runs of a frame
+ *
+ * @param decoder: decoder
+ * @param frame: runs of a frame of an opened show
+ */
+void led_strip_rle_decoder_init(led_strip_rle_decoder_t *decoder, const led_strip_rle_frame_t *frame);
+
+/**
+ * @brief Decode the next pixels of a frame
+ *
+ * @param decoder: decoder
+ * @param num_components: bytes per pixel of the show
+ * @param pixels: max_pixels * num_components bytes
+ * @param max_pixels: pixels to decode at most
+ *
+ * @return Pixels decoded, 0 at the end of the frame
+ */
+uint32_t led_strip_rle_decode(led_strip_rle_decoder_t *decoder, uint8_t num_components, uint8_t *pixels, uint32_t max_pixels);
+
+#ifdef __cplusplus
+}
+#endif
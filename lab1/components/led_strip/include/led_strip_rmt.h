@@ -25,6 +25,7 @@ typedef struct {
     /*!< Extra RMT specific driver flags */
     struct led_strip_rmt_extra_config {
         uint32_t with_dma: 1;   /*!< Use DMA to transmit data */
+        uint32_t encoder_reorder: 1; /*!< Keep the pixels in R, G, B(, W) order, the encoder reorders them to the color component format while transmitting */
     } flags;                    /*!< Extra driver flags */
 } led_strip_rmt_config_t;
 
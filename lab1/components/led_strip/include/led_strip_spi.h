@@ -22,6 +22,8 @@ typedef struct {
     spi_host_device_t spi_bus;  /*!< SPI bus ID. Which buses are available depends on the specific chip */
     struct {
         uint32_t with_dma: 1;   /*!< Use DMA to transmit data */
+        uint32_t streaming: 1;  /*!< Keep only the color components of the pixels and expand them into two small chunks
+                                     while transmitting, instead of 3 SPI bytes per color byte for the whole strip */
     } flags;                    /*!< Extra driver flags */
 } led_strip_spi_config_t;
 
@@ -29,6 +31,16 @@ typedef struct {
  * @brief Create LED strip based on SPI MOSI channel
  *
  * @note Although only the MOSI line is used for generating the signal, the whole SPI bus can't be used for other purposes.
+ * @note A refresh only sends the pixels up to the last one changed since the previous refresh, the LEDs after it keep their color.
+ * @note In streaming mode the refreshing task refills each chunk while the other one is transmitted, so
+ *       `led_strip_refresh_async` returns once the last chunks are queued, and it must not be held off for longer
+ *       than a chunk takes on the wire (64 pixels, about 1.8 ms for RGB). The strip length is then no longer
+ *       limited by the maximum transfer size of the bus, and `double_buffer` is not needed.
+ * @note Each chunk is a separate SPI transaction, started by the SPI driver ISR after the previous one has ended, so the
+ *       line stays low between chunks: typically 10 to 30 us, and longer if the ISR is held off by other interrupts
+ *       or while the flash cache is disabled. LEDs latching on a low period shorter than that, e.g. WS281x clones
+ *       latching after 6 to 9 us, show the frame split at chunk boundaries: do not use streaming with them.
+ * @note A strip with `palette_bits` is always streamed, its indices are expanded through the palette by the chunk filler.
  *
  * @param led_config LED strip configuration
  * @param spi_config SPI specific configuration
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,6 +17,33 @@ extern "C" {
  */
 typedef struct led_strip_t *led_strip_handle_t;
 
+/**
+ * @brief Callback invoked when a refresh started by `led_strip_refresh_async` has been transmitted
+ *
+ * @note Called from the ISR context of the backend peripheral, must not block
+ *
+ * @param strip: LED strip
+ * @param user_ctx: user context passed to `led_strip_register_event_callbacks`
+ * @return Whether a high priority task has been woken up by this callback
+ */
+typedef bool (*led_strip_refresh_done_cb_t)(led_strip_handle_t strip, void *user_ctx);
+
+/**
+ * @brief LED strip event callbacks
+ */
+typedef struct {
+    led_strip_refresh_done_cb_t on_refresh_done; /*!< A refresh has been transmitted */
+} led_strip_event_callbacks_t;
+
+/**
+ * @brief HSV color, same ranges as `led_strip_set_pixel_hsv`
+ */
+typedef struct {
+    uint16_t hue;       /*!< Hue part of color, 0 - 360 */
+    uint8_t saturation; /*!< Saturation part of color, 0 - 255 */
+    uint8_t value;      /*!< Value part of color, 0 - 255 */
+} led_strip_hsv_t;
+
 /**
  * @brief LED strip model
  * @note Different led model may have different timing parameters, so we need to distinguish them.
@@ -59,9 +87,12 @@ typedef struct {
     led_model_t led_model;        /*!< Specifies the LED strip model (e.g., WS2812, SK6812) */
     led_color_component_format_t color_component_format; /*!< Specifies the order of color components in each pixel.
                                                               Use helper macros like `LED_STRIP_COLOR_COMPONENT_FMT_GRB` to set the format */
+    uint8_t palette_bits;         /*!< 0 to keep a color per pixel, 4 or 8 to keep a palette index per pixel,
+                                       in a palette of 16 or 256 colors set with `led_strip_set_palette` */
     /*!< LED strip extra driver flags */
     struct led_strip_extra_flags {
         uint32_t invert_out: 1; /*!< Invert output signal */
+        uint32_t double_buffer: 1; /*!< Keep a second pixel buffer, so that pixels can be set while the previous frame is transmitted */
     } flags; /*!< Extra driver flags */
 } led_strip_config_t;
 
@@ -0,0 +1,239 @@
+/*
+ * SPDX-FileCopyrightText: 2022 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "led_strip_types.h"
+#include "led_strip_rle.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct led_strip_t led_strip_t; /*!< Type of LED strip */
+
+/**
+ * @brief LED strip interface definition
+ */
+struct led_strip_t {
+    /**
+     * @brief Set RGB for a specific pixel
+     *
+     * @param strip: LED strip
+     * @param index: index of pixel to set
+     * @param red: red part of color
+     * @param green: green part of color
+     * @param blue: blue part of color
+     *
+     * @return
+     *      - ESP_OK: Set RGB for a specific pixel successfully
+     *      - ESP_ERR_INVALID_ARG: Set RGB for a specific pixel failed because of invalid parameters
+     *      - ESP_FAIL: Set RGB for a specific pixel failed because other error occurred
+     */
+    esp_err_t (*set_pixel)(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue);
+
+    /**
+     * @brief Set RGBW for a specific pixel. Similar to `set_pixel` but also set the white component
+     *
+     * @param strip: LED strip
+     * @param index: index of pixel to set
+     * @param red: red part of color
+     * @param green: green part of color
+     * @param blue: blue part of color
+     * @param white: separate white component
+     *
+     * @return
+     *      - ESP_OK: Set RGBW color for a specific pixel successfully
+     *      - ESP_ERR_INVALID_ARG: Set RGBW color for a specific pixel failed because of an invalid argument
+     *      - ESP_FAIL: Set RGBW color for a specific pixel failed because other error occurred
+     */
+    esp_err_t (*set_pixel_rgbw)(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white);
+
+    /**
+     * @brief Set RGB for a range of pixels
+     *
+     * @param strip: LED strip
+     * @param start: index of the first pixel to set
+     * @param count: number of pixels to set
+     * @param rgb: colors, 3 bytes per pixel in R, G, B order
+     *
+     * @return
+     *      - ESP_OK: Set RGB for the pixels successfully
+     *      - ESP_ERR_INVALID_ARG: Set RGB for the pixels failed because of invalid parameters
+     *      - ESP_FAIL: Set RGB for the pixels failed because other error occurred
+     *
+     * @note Optional, `led_strip_set_pixels` falls back to `set_pixel` when NULL
+     */
+    esp_err_t (*set_pixels)(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *rgb);
+
+    /**
+     * @brief Set RGBW for a range of pixels. Similar to `set_pixels` but also set the white component
+     *
+     * @param strip: LED strip
+     * @param start: index of the first pixel to set
+     * @param count: number of pixels to set
+     * @param rgbw: colors, 4 bytes per pixel in R, G, B, W order
+     *
+     * @return
+     *      - ESP_OK: Set RGBW for the pixels successfully
+     *      - ESP_ERR_INVALID_ARG: Set RGBW for the pixels failed because of invalid parameters
+     *      - ESP_FAIL: Set RGBW for the pixels failed because other error occurred
+     *
+     * @note Optional, `led_strip_set_pixels_rgbw` falls back to `set_pixel_rgbw` when NULL
+     */
+    esp_err_t (*set_pixels_rgbw)(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *rgbw);
+
+    /**
+     * @brief Refresh memory colors to LEDs
+     *
+     * @param strip: LED strip
+     * @param timeout_ms: timeout value for refreshing task
+     *
+     * @return
+     *      - ESP_OK: Refresh successfully
+     *      - ESP_FAIL: Refresh failed because some other error occurred
+     *
+     * @note:
+     *      After updating the LED colors in the memory, a following invocation of this API is needed to flush colors to strip.
+     */
+    esp_err_t (*refresh)(led_strip_t *strip);
+
+    /**
+     * @brief Start flushing memory colors to LEDs, without waiting for the end of the transmission
+     *
+     * @param strip: LED strip
+     *
+     * @return
+     *      - ESP_OK: Refresh started successfully
+     *      - ESP_FAIL: Refresh failed because some other error occurred
+     *
+     * @note Optional, `led_strip_refresh_async` falls back to `refresh` when NULL
+     */
+    esp_err_t (*refresh_async)(led_strip_t *strip);
+
+    /**
+     * @brief Wait for the end of the refresh started by `refresh_async`
+     *
+     * @param strip: LED strip
+     * @param timeout_ms: timeout value, -1 to wait forever
+     *
+     * @return
+     *      - ESP_OK: No refresh in progress
+     *      - ESP_ERR_TIMEOUT: The refresh is still in progress
+     *      - ESP_FAIL: Wait failed because some other error occurred
+     *
+     * @note Optional, needed if `refresh_async` is set
+     */
+    esp_err_t (*wait_refresh_done)(led_strip_t *strip, int32_t timeout_ms);
+
+    /**
+     * @brief Start sending a frame of a run-length encoded show, decoded while transmitting
+     *
+     * @param strip: LED strip
+     * @param show: opened show
+     * @param frame: frame of the show
+     *
+     * @return
+     *      - ESP_OK: Refresh started successfully
+     *      - ESP_ERR_INVALID_ARG: The show does not fit the strip
+     *      - ESP_ERR_INVALID_STATE: The strip cannot send colors
+     *      - ESP_FAIL: Refresh failed because some other error occurred
+     *
+     * @note Optional, completed by `wait_refresh_done`
+     */
+    esp_err_t (*refresh_rle_async)(led_strip_t *strip, const led_strip_rle_show_t *show, const led_strip_rle_frame_t *frame);
+
+    /**
+     * @brief Set the event callbacks
+     *
+     * @param strip: LED strip
+     * @param cbs: callbacks
+     * @param user_ctx: user context passed to the callbacks
+     *
+     * @return
+     *      - ESP_OK: Set callbacks successfully
+     *      - ESP_FAIL: Set callbacks failed because some other error occurred
+     *
+     * @note Optional, `led_strip_register_event_callbacks` returns ESP_ERR_NOT_SUPPORTED when NULL
+     */
+    esp_err_t (*register_event_callbacks)(led_strip_t *strip, const led_strip_event_callbacks_t *cbs, void *user_ctx);
+
+    /**
+     * @brief Set the lookup table the color components go through on their way to the LEDs
+     *
+     * @param strip: LED strip
+     * @param lut: 256 entries, kept by reference, NULL to disable
+     *
+     * @return
+     *      - ESP_OK: Set the table successfully
+     *      - ESP_FAIL: Set the table failed because some other error occurred
+     *
+     * @note Optional, `led_strip_set_color_lut` returns ESP_ERR_NOT_SUPPORTED when NULL
+     */
+    esp_err_t (*set_color_lut)(led_strip_t *strip, const uint8_t *lut);
+
+    /**
+     * @brief Set consecutive entries of the palette of a palette strip
+     *
+     * @param strip: LED strip
+     * @param start: index of the first entry to set
+     * @param count: number of entries to set
+     * @param colors: count colors, R, G, B(, W) for each, as many components as the strip
+     *
+     * @return
+     *      - ESP_OK: Set the entries successfully
+     *      - ESP_ERR_INVALID_ARG: Set the entries failed because of invalid parameters
+     *      - ESP_ERR_INVALID_STATE: The strip keeps a color per pixel
+     *
+     * @note Optional, `led_strip_set_palette` returns ESP_ERR_NOT_SUPPORTED when NULL
+     */
+    esp_err_t (*set_palette)(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *colors);
+
+    /**
+     * @brief Set the palette indices of consecutive pixels of a palette strip
+     *
+     * @param strip: LED strip
+     * @param start: index of the first pixel to set
+     * @param count: number of pixels to set
+     * @param indices: count palette indices, one byte each
+     *
+     * @return
+     *      - ESP_OK: Set the pixels successfully
+     *      - ESP_ERR_INVALID_ARG: Set the pixels failed because of invalid parameters
+     *      - ESP_ERR_INVALID_STATE: The strip keeps a color per pixel
+     *
+     * @note Optional, `led_strip_set_pixels_index` returns ESP_ERR_NOT_SUPPORTED when NULL
+     */
+    esp_err_t (*set_pixels_index)(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *indices);
+
+    /**
+     * @brief Clear LED strip (turn off all LEDs)
+     *
+     * @param strip: LED strip
+     * @param timeout_ms: timeout value for clearing task
+     *
+     * @return
+     *      - ESP_OK: Clear LEDs successfully
+     *      - ESP_FAIL: Clear LEDs failed because some other error occurred
+     */
+    esp_err_t (*clear)(led_strip_t *strip);
+
+    /**
+     * @brief Free LED strip resources
+     *
+     * @param strip: LED strip
+     *
+     * @return
+     *      - ESP_OK: Free resources successfully
+     *      - ESP_FAIL: Free resources failed because error occurred
+     */
+    esp_err_t (*del)(led_strip_t *strip);
+};
+
+#ifdef __cplusplus
+}
+#endif
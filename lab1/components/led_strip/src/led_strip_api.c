@@ -0,0 +1,278 @@
+/*
+ * SPDX-FileCopyrightText: 2022 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <math.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "led_strip.h"
+#include "led_strip_interface.h"
+
+// pixels converted on the stack before each set_pixels call of the HSV helpers
+#define LED_STRIP_HSV_CHUNK_PIXELS 64
+// hues in 1/256 degree
+#define LED_STRIP_HUE_Q8_SECTOR (60 * 256)
+#define LED_STRIP_HUE_Q8_TURN (360 * 256)
+
+static const char *TAG = "led_strip";
+
+// HSV to RGB in integers only, the hue in 1/256 degree. The divisions are by constants and become multiplications.
+// An integer hue gives the colors of the former float version, hues from 360 included
+static inline void led_strip_hsv_q8_to_rgb(uint32_t hue_q8, uint32_t saturation, uint32_t value, uint8_t *rgb)
+{
+    uint32_t rgb_max = value;
+    // x / 255 rounded down, for x up to 255 * 255
+    uint32_t x = rgb_max * (255 - saturation);
+    uint32_t rgb_min = (x + 1 + (x >> 8)) >> 8;
+
+    uint32_t i = hue_q8 / LED_STRIP_HUE_Q8_SECTOR;
+    uint32_t diff = hue_q8 - i * LED_STRIP_HUE_Q8_SECTOR;
+
+    // RGB adjustment amount by hue
+    uint32_t rgb_adj = (rgb_max - rgb_min) * diff / LED_STRIP_HUE_Q8_SECTOR;
+
+    switch (i) {
+    case 0:
+        rgb[0] = rgb_max;
+        rgb[1] = rgb_min + rgb_adj;
+        rgb[2] = rgb_min;
+        break;
+    case 1:
+        rgb[0] = rgb_max - rgb_adj;
+        rgb[1] = rgb_max;
+        rgb[2] = rgb_min;
+        break;
+    case 2:
+        rgb[0] = rgb_min;
+        rgb[1] = rgb_max;
+        rgb[2] = rgb_min + rgb_adj;
+        break;
+    case 3:
+        rgb[0] = rgb_min;
+        rgb[1] = rgb_max - rgb_adj;
+        rgb[2] = rgb_max;
+        break;
+    case 4:
+        rgb[0] = rgb_min + rgb_adj;
+        rgb[1] = rgb_min;
+        rgb[2] = rgb_max;
+        break;
+    default:
+        rgb[0] = rgb_max;
+        rgb[1] = rgb_min;
+        rgb[2] = rgb_max - rgb_adj;
+        break;
+    }
+}
+
+esp_err_t led_strip_set_pixel(led_strip_handle_t strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    return strip->set_pixel(strip, index, red, green, blue);
+}
+
+esp_err_t led_strip_set_pixel_hsv(led_strip_handle_t strip, uint32_t index, uint16_t hue, uint8_t saturation, uint8_t value)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    uint8_t rgb[3];
+    led_strip_hsv_q8_to_rgb((uint32_t)hue << 8, saturation, value, rgb);
+    return strip->set_pixel(strip, index, rgb[0], rgb[1], rgb[2]);
+}
+
+esp_err_t led_strip_set_pixel_rgbw(led_strip_handle_t strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    return strip->set_pixel_rgbw(strip, index, red, green, blue, white);
+}
+
+esp_err_t led_strip_set_pixels(led_strip_handle_t strip, uint32_t start, uint32_t count, const uint8_t *rgb)
+{
+    ESP_RETURN_ON_FALSE(strip && (rgb || count == 0), ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    if (strip->set_pixels) {
+        return strip->set_pixels(strip, start, count, rgb);
+    }
+    // backend without bulk support
+    for (uint32_t i = 0; i < count; i++, rgb += 3) {
+        ESP_RETURN_ON_ERROR(strip->set_pixel(strip, start + i, rgb[0], rgb[1], rgb[2]), TAG, "set pixel failed");
+    }
+    return ESP_OK;
+}
+
+esp_err_t led_strip_set_pixels_rgbw(led_strip_handle_t strip, uint32_t start, uint32_t count, const uint8_t *rgbw)
+{
+    ESP_RETURN_ON_FALSE(strip && (rgbw || count == 0), ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    if (strip->set_pixels_rgbw) {
+        return strip->set_pixels_rgbw(strip, start, count, rgbw);
+    }
+    // backend without bulk support
+    for (uint32_t i = 0; i < count; i++, rgbw += 4) {
+        ESP_RETURN_ON_ERROR(strip->set_pixel_rgbw(strip, start + i, rgbw[0], rgbw[1], rgbw[2], rgbw[3]), TAG, "set pixel failed");
+    }
+    return ESP_OK;
+}
+
+esp_err_t led_strip_refresh(led_strip_handle_t strip)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    return strip->refresh(strip);
+}
+
+esp_err_t led_strip_refresh_async(led_strip_handle_t strip)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    if (!strip->refresh_async) {
+        return strip->refresh(strip);
+    }
+    return strip->refresh_async(strip);
+}
+
+esp_err_t led_strip_refresh_rle_async(led_strip_handle_t strip, const led_strip_rle_show_t *show, const led_strip_rle_frame_t *frame)
+{
+    ESP_RETURN_ON_FALSE(strip && show && frame, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(strip->refresh_rle_async, ESP_ERR_NOT_SUPPORTED, TAG, "shows not supported by the backend");
+    return strip->refresh_rle_async(strip, show, frame);
+}
+
+esp_err_t led_strip_refresh_wait_done(led_strip_handle_t strip, int32_t timeout_ms)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    if (!strip->wait_refresh_done) {
+        // refresh_async was synchronous
+        return ESP_OK;
+    }
+    return strip->wait_refresh_done(strip, timeout_ms);
+}
+
+esp_err_t led_strip_register_event_callbacks(led_strip_handle_t strip, const led_strip_event_callbacks_t *cbs, void *user_ctx)
+{
+    ESP_RETURN_ON_FALSE(strip && cbs, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(strip->register_event_callbacks, ESP_ERR_NOT_SUPPORTED, TAG, "events not supported by the backend");
+    return strip->register_event_callbacks(strip, cbs, user_ctx);
+}
+
+esp_err_t led_strip_set_color_lut(led_strip_handle_t strip, const uint8_t *lut)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(strip->set_color_lut, ESP_ERR_NOT_SUPPORTED, TAG, "color table not supported by the backend");
+    return strip->set_color_lut(strip, lut);
+}
+
+esp_err_t led_strip_set_palette(led_strip_handle_t strip, uint32_t start, uint32_t count, const uint8_t *colors)
+{
+    ESP_RETURN_ON_FALSE(strip && (colors || count == 0), ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(strip->set_palette, ESP_ERR_NOT_SUPPORTED, TAG, "palette not supported by the backend");
+    return strip->set_palette(strip, start, count, colors);
+}
+
+esp_err_t led_strip_set_pixel_index(led_strip_handle_t strip, uint32_t index, uint8_t color_index)
+{
+    return led_strip_set_pixels_index(strip, index, 1, &color_index);
+}
+
+esp_err_t led_strip_set_pixels_index(led_strip_handle_t strip, uint32_t start, uint32_t count, const uint8_t *indices)
+{
+    ESP_RETURN_ON_FALSE(strip && (indices || count == 0), ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(strip->set_pixels_index, ESP_ERR_NOT_SUPPORTED, TAG, "palette not supported by the backend");
+    return strip->set_pixels_index(strip, start, count, indices);
+}
+
+esp_err_t led_strip_make_color_lut(uint8_t *lut, float gamma, uint8_t brightness)
+{
+    ESP_RETURN_ON_FALSE(lut && gamma > 0, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    for (int i = 0; i < 256; i++) {
+        lut[i] = (uint8_t)(brightness * powf(i / 255.0f, gamma) + 0.5f);
+    }
+    return ESP_OK;
+}
+
+esp_err_t led_strip_hsv_to_rgb(const led_strip_hsv_t *hsv, uint32_t count, uint8_t *rgb)
+{
+    ESP_RETURN_ON_FALSE((hsv && rgb) || count == 0, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    for (uint32_t i = 0; i < count; i++, rgb += 3) {
+        led_strip_hsv_q8_to_rgb((uint32_t)hsv[i].hue << 8, hsv[i].saturation, hsv[i].value, rgb);
+    }
+    return ESP_OK;
+}
+
+esp_err_t led_strip_set_pixels_hsv(led_strip_handle_t strip, uint32_t start, uint32_t count, const led_strip_hsv_t *hsv)
+{
+    ESP_RETURN_ON_FALSE(strip && (hsv || count == 0), ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    uint8_t rgb[LED_STRIP_HSV_CHUNK_PIXELS * 3];
+    while (count) {
+        uint32_t n = count < LED_STRIP_HSV_CHUNK_PIXELS ? count : LED_STRIP_HSV_CHUNK_PIXELS;
+        led_strip_hsv_to_rgb(hsv, n, rgb);
+        ESP_RETURN_ON_ERROR(led_strip_set_pixels(strip, start, n, rgb), TAG, "set pixels failed");
+        start += n;
+        count -= n;
+        hsv += n;
+    }
+    return ESP_OK;
+}
+
+// Set count pixels from start, with the hue, saturation and value stepping linearly.
+// Everything in 1/65536 units, the hue wrapping around at 360 degrees
+static esp_err_t led_strip_fill_hsv_steps(led_strip_handle_t strip, uint32_t start, uint32_t count,
+                                          int32_t hue, int32_t hue_step, int32_t sat, int32_t sat_step, int32_t val, int32_t val_step)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    const int32_t turn = LED_STRIP_HUE_Q8_TURN << 8;
+    uint8_t rgb[LED_STRIP_HSV_CHUNK_PIXELS * 3];
+    while (count) {
+        uint32_t n = count < LED_STRIP_HSV_CHUNK_PIXELS ? count : LED_STRIP_HSV_CHUNK_PIXELS;
+        for (uint32_t i = 0; i < n; i++) {
+            led_strip_hsv_q8_to_rgb((uint32_t)hue >> 8, (uint32_t)sat >> 16, (uint32_t)val >> 16, &rgb[i * 3]);
+            hue += hue_step;
+            // a step is up to two turns
+            while (hue >= turn) {
+                hue -= turn;
+            }
+            while (hue < 0) {
+                hue += turn;
+            }
+            sat += sat_step;
+            val += val_step;
+        }
+        ESP_RETURN_ON_ERROR(led_strip_set_pixels(strip, start, n, rgb), TAG, "set pixels failed");
+        start += n;
+        count -= n;
+    }
+    return ESP_OK;
+}
+
+esp_err_t led_strip_fill_gradient(led_strip_handle_t strip, uint32_t start, uint32_t count, const led_strip_hsv_t *from, const led_strip_hsv_t *to)
+{
+    ESP_RETURN_ON_FALSE(strip && from && to, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(from->hue <= 720 && to->hue <= 720, ESP_ERR_INVALID_ARG, TAG, "hue out of range");
+    // both ends included, started half a unit up so that the last pixel rounds to the end color.
+    // The unit of the hue is 1/256 degree
+    int32_t steps = count > 1 ? count - 1 : 1;
+    int32_t hue = (from->hue % 360) << 16;
+    // multiplied rather than shifted, the differences are negative for a descending gradient
+    int32_t hue_step = ((int32_t)to->hue - from->hue) * 65536 / steps;
+    int32_t sat_step = ((int32_t)to->saturation - from->saturation) * 65536 / steps;
+    int32_t val_step = ((int32_t)to->value - from->value) * 65536 / steps;
+    return led_strip_fill_hsv_steps(strip, start, count, hue + 0x80, hue_step,
+                                    (from->saturation << 16) + 0x8000, sat_step, (from->value << 16) + 0x8000, val_step);
+}
+
+esp_err_t led_strip_fill_rainbow(led_strip_handle_t strip, uint32_t start, uint32_t count, uint16_t first_hue, uint8_t saturation, uint8_t value)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    // one turn of the color wheel, the pixel after the last one would be first_hue again
+    int32_t hue_step = count ? (360 << 16) / (int32_t)count : 0;
+    return led_strip_fill_hsv_steps(strip, start, count, (first_hue % 360) << 16, hue_step,
+                                    saturation << 16, 0, value << 16, 0);
+}
+
+esp_err_t led_strip_clear(led_strip_handle_t strip)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    return strip->clear(strip);
+}
+
+esp_err_t led_strip_del(led_strip_handle_t strip)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    return strip->del(strip);
+}
@@ -0,0 +1,123 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "led_strip.h"
+#include "led_strip_dither.h"
+
+// pixels quantised on the stack before each set_pixels call
+#define LED_STRIP_DITHER_CHUNK_PIXELS 64
+
+static const char *TAG = "led_strip_dither";
+
+struct led_strip_dither_t {
+    led_strip_handle_t strip;
+    uint32_t num_leds;
+    uint8_t num_components;
+    uint16_t *frame;    // 16 bit components, padded to an even number
+    uint16_t *error;    // part of each component below the 8 bit output, carried to the next frame
+};
+
+/*
+ * Two components per 32 bit word, one in each half. A value v is first scaled to v - v / 256, at most 255 * 256,
+ * so that adding an error below 256 never carries into the next lane and the output never exceeds 255.
+ * The high byte of each lane is the output, the low byte the error of the next frame.
+ */
+static inline uint32_t led_strip_dither_pair(uint32_t values, uint32_t *errors)
+{
+    uint32_t sums = values - ((values >> 8) & 0x00FF00FF) + *errors;
+    *errors = sums & 0x00FF00FF;
+    return sums;
+}
+
+// quantise count components from index, 2 at a time
+static void led_strip_dither_quantise(led_strip_dither_handle_t dither, uint32_t index, uint32_t count, uint8_t *out)
+{
+    const uint16_t *frame = dither->frame + index;
+    uint16_t *error = dither->error + index;
+    for (uint32_t i = 0; i < count; i += 2) {
+        uint32_t values;
+        uint32_t errors;
+        memcpy(&values, frame + i, sizeof(values));
+        memcpy(&errors, error + i, sizeof(errors));
+        uint32_t sums = led_strip_dither_pair(values, &errors);
+        memcpy(error + i, &errors, sizeof(errors));
+        out[i] = sums >> 8;
+        out[i + 1] = sums >> 24;
+    }
+}
+
+esp_err_t led_strip_new_dither(const led_strip_dither_config_t *config, led_strip_dither_handle_t *ret_dither)
+{
+    esp_err_t ret = ESP_OK;
+    led_strip_dither_handle_t dither = NULL;
+    ESP_RETURN_ON_FALSE(config && config->strip && config->num_leds && ret_dither, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(config->num_components == 3 || config->num_components == 4, ESP_ERR_INVALID_ARG, TAG,
+                        "invalid number of color components: %d", config->num_components);
+    // even, so that the last pair of a chunk is whole
+    size_t num_values = (config->num_leds * config->num_components + 1) & ~1u;
+    dither = calloc(1, sizeof(struct led_strip_dither_t));
+    ESP_GOTO_ON_FALSE(dither, ESP_ERR_NO_MEM, err, TAG, "no mem for dither");
+    dither->frame = calloc(num_values, sizeof(uint16_t));
+    dither->error = malloc(num_values * sizeof(uint16_t));
+    ESP_GOTO_ON_FALSE(dither->frame && dither->error, ESP_ERR_NO_MEM, err, TAG, "no mem for dither framebuffer");
+    // spread the starting errors, so that pixels of the same color do not all step up on the same frame
+    for (size_t i = 0; i < num_values; i++) {
+        dither->error[i] = (i * 159) & 0xFF;
+    }
+    dither->strip = config->strip;
+    dither->num_leds = config->num_leds;
+    dither->num_components = config->num_components;
+    *ret_dither = dither;
+    return ESP_OK;
+err:
+    if (dither) {
+        led_strip_dither_del(dither);
+    }
+    return ret;
+}
+
+esp_err_t led_strip_dither_set_pixels(led_strip_dither_handle_t dither, uint32_t start, uint32_t count, const uint16_t *components)
+{
+    ESP_RETURN_ON_FALSE(dither && (components || count == 0), ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(start <= dither->num_leds && count <= dither->num_leds - start, ESP_ERR_INVALID_ARG, TAG,
+                        "pixels out of the framebuffer");
+    memcpy(dither->frame + start * dither->num_components, components, count * dither->num_components * sizeof(uint16_t));
+    return ESP_OK;
+}
+
+esp_err_t led_strip_dither_refresh_async(led_strip_dither_handle_t dither)
+{
+    ESP_RETURN_ON_FALSE(dither, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    uint8_t num_components = dither->num_components;
+    // one more pair, for a chunk of an odd number of values
+    uint8_t out[LED_STRIP_DITHER_CHUNK_PIXELS * 4 + 2];
+    for (uint32_t start = 0; start < dither->num_leds; start += LED_STRIP_DITHER_CHUNK_PIXELS) {
+        uint32_t count = dither->num_leds - start;
+        if (count > LED_STRIP_DITHER_CHUNK_PIXELS) {
+            count = LED_STRIP_DITHER_CHUNK_PIXELS;
+        }
+        // chunks start on an even value, 64 pixels are an even number of values
+        led_strip_dither_quantise(dither, start * num_components, count * num_components, out);
+        if (num_components == 4) {
+            ESP_RETURN_ON_ERROR(led_strip_set_pixels_rgbw(dither->strip, start, count, out), TAG, "set pixels failed");
+        } else {
+            ESP_RETURN_ON_ERROR(led_strip_set_pixels(dither->strip, start, count, out), TAG, "set pixels failed");
+        }
+    }
+    return led_strip_refresh_async(dither->strip);
+}
+
+esp_err_t led_strip_dither_del(led_strip_dither_handle_t dither)
+{
+    ESP_RETURN_ON_FALSE(dither, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    free(dither->frame);
+    free(dither->error);
+    free(dither);
+    return ESP_OK;
+}
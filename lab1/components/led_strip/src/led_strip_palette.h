@@ -0,0 +1,67 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "led_strip_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bytes of count palette indices, 4 bit indices are packed two per byte, the even pixel in the low nibble
+static inline size_t led_strip_palette_frame_size(uint8_t palette_bits, uint32_t count)
+{
+    return ((size_t)count * palette_bits + 7) / 8;
+}
+
+static inline uint8_t led_strip_palette_get_index(const uint8_t *indices, uint8_t palette_bits, uint32_t pixel)
+{
+    if (palette_bits == 8) {
+        return indices[pixel];
+    }
+    return (indices[pixel / 2] >> (pixel % 2 * 4)) & 0x0F;
+}
+
+// store an index and return whether it changed
+static inline bool led_strip_palette_put_index(uint8_t *indices, uint8_t palette_bits, uint32_t pixel, uint8_t index)
+{
+    if (palette_bits == 8) {
+        bool changed = indices[pixel] != index;
+        indices[pixel] = index;
+        return changed;
+    }
+    uint8_t shift = pixel % 2 * 4;
+    uint8_t byte = (indices[pixel / 2] & ~(0x0F << shift)) | index << shift;
+    bool changed = indices[pixel / 2] != byte;
+    indices[pixel / 2] = byte;
+    return changed;
+}
+
+// store count R, G, B(, W) colors as palette entries in wire order, and return whether any changed
+static inline bool led_strip_palette_put_colors(uint8_t *palette, led_color_component_format_t component_fmt, uint32_t start,
+                                                uint32_t count, const uint8_t *colors)
+{
+    uint8_t num_components = component_fmt.format.num_components;
+    const uint8_t pos[4] = {component_fmt.format.r_pos, component_fmt.format.g_pos, component_fmt.format.b_pos, component_fmt.format.w_pos};
+    uint8_t *entry = palette + start * num_components;
+    bool changed = false;
+    for (uint32_t i = 0; i < count; i++) {
+        for (uint8_t c = 0; c < num_components; c++) {
+            changed |= entry[pos[c]] != colors[c];
+            entry[pos[c]] = colors[c];
+        }
+        entry += num_components;
+        colors += num_components;
+    }
+    return changed;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,188 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "led_strip_rle.h"
+
+static const char *TAG = "led_strip_rle";
+
+static inline uint32_t led_strip_rle_get_u16(const uint8_t *p)
+{
+    return p[0] | (uint32_t)p[1] << 8;
+}
+
+static inline uint32_t led_strip_rle_get_u32(const uint8_t *p)
+{
+    return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static inline void led_strip_rle_put_u32(uint8_t *p, uint32_t value)
+{
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+}
+
+// pixels of well formed runs, or UINT32_MAX if they overrun their size
+static uint32_t led_strip_rle_count_pixels(const uint8_t *runs, size_t size, uint8_t num_components)
+{
+    uint32_t pixels = 0;
+    size_t offset = 0;
+    while (offset < size) {
+        uint8_t control = runs[offset++];
+        uint32_t count = (control & 0x7F) + 1;
+        size_t bytes = control & 0x80 ? num_components : count * num_components;
+        if (bytes > size - offset) {
+            return UINT32_MAX;
+        }
+        offset += bytes;
+        pixels += count;
+    }
+    return pixels;
+}
+
+esp_err_t led_strip_rle_open(const void *data, size_t size, led_strip_rle_show_t *show)
+{
+    ESP_RETURN_ON_FALSE(data && show, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    const uint8_t *header = data;
+    ESP_RETURN_ON_FALSE(size >= LED_STRIP_RLE_HEADER_SIZE && memcmp(header, "LRLE", 4) == 0 && header[4] == LED_STRIP_RLE_VERSION,
+                        ESP_ERR_INVALID_VERSION, TAG, "not a run-length encoded show of version %d", LED_STRIP_RLE_VERSION);
+    uint8_t num_components = header[5];
+    ESP_RETURN_ON_FALSE(num_components == 3 || num_components == 4, ESP_ERR_INVALID_VERSION, TAG,
+                        "invalid number of color components: %d", num_components);
+    uint32_t num_leds = led_strip_rle_get_u16(header + 6);
+    uint32_t num_frames = led_strip_rle_get_u32(header + 8);
+
+    // the frames are walked once here, the decoders then run without checks
+    const uint8_t *frames = header + LED_STRIP_RLE_HEADER_SIZE;
+    size_t frames_size = size - LED_STRIP_RLE_HEADER_SIZE;
+    size_t offset = 0;
+    for (uint32_t f = 0; f < num_frames; f++) {
+        ESP_RETURN_ON_FALSE(frames_size - offset >= 4, ESP_ERR_INVALID_SIZE, TAG, "frame %lu truncated", (unsigned long)f);
+        size_t runs_size = led_strip_rle_get_u32(frames + offset);
+        offset += 4;
+        ESP_RETURN_ON_FALSE(runs_size <= frames_size - offset, ESP_ERR_INVALID_SIZE, TAG, "frame %lu truncated", (unsigned long)f);
+        ESP_RETURN_ON_FALSE(led_strip_rle_count_pixels(frames + offset, runs_size, num_components) == num_leds, ESP_ERR_INVALID_SIZE,
+                            TAG, "frame %lu is not %lu LEDs", (unsigned long)f, (unsigned long)num_leds);
+        offset += runs_size;
+    }
+
+    show->num_components = num_components;
+    show->num_leds = num_leds;
+    show->num_frames = num_frames;
+    show->frame_period_us = led_strip_rle_get_u32(header + 12);
+    show->frames = frames;
+    // a show mapped from a partition is followed by the rest of the partition
+    show->frames_size = offset;
+    return ESP_OK;
+}
+
+bool led_strip_rle_next_frame(const led_strip_rle_show_t *show, size_t *offset, led_strip_rle_frame_t *frame)
+{
+    if (*offset + 4 > show->frames_size) {
+        return false;
+    }
+    frame->size = led_strip_rle_get_u32(show->frames + *offset);
+    frame->runs = show->frames + *offset + 4;
+    *offset += 4 + frame->size;
+    return true;
+}
+
+esp_err_t led_strip_rle_write_header(const led_strip_rle_show_t *show, uint8_t *header)
+{
+    ESP_RETURN_ON_FALSE(show && header, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE((show->num_components == 3 || show->num_components == 4) && show->num_leds <= UINT16_MAX,
+                        ESP_ERR_INVALID_ARG, TAG, "invalid show");
+    memcpy(header, "LRLE", 4);
+    header[4] = LED_STRIP_RLE_VERSION;
+    header[5] = show->num_components;
+    header[6] = show->num_leds;
+    header[7] = show->num_leds >> 8;
+    led_strip_rle_put_u32(header + 8, show->num_frames);
+    led_strip_rle_put_u32(header + 12, show->frame_period_us);
+    return ESP_OK;
+}
+
+esp_err_t led_strip_rle_pack_frame(const uint8_t *pixels, uint32_t num_leds, uint8_t num_components,
+                                   uint8_t *out, size_t out_size, size_t *ret_size)
+{
+    ESP_RETURN_ON_FALSE(pixels && out && ret_size && (num_components == 3 || num_components == 4), ESP_ERR_INVALID_ARG, TAG,
+                        "invalid argument");
+    ESP_RETURN_ON_FALSE(out_size >= 4, ESP_ERR_INVALID_SIZE, TAG, "frame does not fit");
+    size_t size = 4;
+    uint32_t i = 0;
+    while (i < num_leds) {
+        const uint8_t *first = pixels + i * num_components;
+        uint32_t count = 1;
+        while (i + count < num_leds && count < LED_STRIP_RLE_MAX_RUN &&
+                memcmp(first + count * num_components, first, num_components) == 0) {
+            count++;
+        }
+        size_t bytes = num_components;
+        if (count > 1) {
+            out[size] = 0x80 | (count - 1);
+        } else {
+            // up to the next pair of equal pixels, which starts a repeat run
+            while (i + count < num_leds && count < LED_STRIP_RLE_MAX_RUN &&
+                    !(i + count + 1 < num_leds && memcmp(first + count * num_components, first + (count + 1) * num_components, num_components) == 0)) {
+                count++;
+            }
+            out[size] = count - 1;
+            bytes = count * num_components;
+        }
+        ESP_RETURN_ON_FALSE(1 + bytes <= out_size - size, ESP_ERR_INVALID_SIZE, TAG, "frame does not fit");
+        memcpy(out + size + 1, first, bytes);
+        size += 1 + bytes;
+        i += count;
+    }
+    led_strip_rle_put_u32(out, size - 4);
+    *ret_size = size;
+    return ESP_OK;
+}
+
+void led_strip_rle_decoder_init(led_strip_rle_decoder_t *decoder, const led_strip_rle_frame_t *frame)
+{
+    decoder->runs = frame->runs;
+    decoder->size = frame->size;
+    decoder->offset = 0;
+    decoder->remaining = 0;
+    decoder->repeat = false;
+}
+
+uint32_t led_strip_rle_decode(led_strip_rle_decoder_t *decoder, uint8_t num_components, uint8_t *pixels, uint32_t max_pixels)
+{
+    uint32_t decoded = 0;
+    while (decoded < max_pixels) {
+        if (!decoder->remaining) {
+            if (decoder->offset >= decoder->size) {
+                break;
+            }
+            uint8_t control = decoder->runs[decoder->offset++];
+            decoder->repeat = control & 0x80;
+            decoder->remaining = (control & 0x7F) + 1;
+        }
+        uint32_t count = decoder->remaining < max_pixels - decoded ? decoder->remaining : max_pixels - decoded;
+        const uint8_t *src = decoder->runs + decoder->offset;
+        if (decoder->repeat) {
+            for (uint32_t i = 0; i < count; i++, pixels += num_components) {
+                memcpy(pixels, src, num_components);
+            }
+            // the color stays at offset until the last pixel of the run
+            if (count == decoder->remaining) {
+                decoder->offset += num_components;
+            }
+        } else {
+            memcpy(pixels, src, count * num_components);
+            pixels += count * num_components;
+            decoder->offset += count * num_components;
+        }
+        decoder->remaining -= count;
+        decoded += count;
+    }
+    return decoded;
+}
@@ -0,0 +1,425 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <sys/cdefs.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_attr.h"
+#include "driver/rmt_tx.h"
+#include "led_strip.h"
+#include "led_strip_interface.h"
+#include "led_strip_rmt_encoder.h"
+#include "led_strip_rmt_dev.h"
+#include "led_strip_palette.h"
+
+#define LED_STRIP_RMT_DEFAULT_RESOLUTION 10000000 // 10MHz resolution
+#define LED_STRIP_RMT_DEFAULT_TRANS_QUEUE_SIZE 4
+// the memory size of each RMT channel, in words (4 bytes)
+#if CONFIG_IDF_TARGET_ESP32 || CONFIG_IDF_TARGET_ESP32S2
+#define LED_STRIP_RMT_DEFAULT_MEM_BLOCK_SYMBOLS 64
+#else
+#define LED_STRIP_RMT_DEFAULT_MEM_BLOCK_SYMBOLS 48
+#endif
+
+static const char *TAG = "led_strip_rmt";
+
+typedef struct {
+    led_strip_t base;
+    rmt_channel_handle_t rmt_chan;
+    rmt_encoder_handle_t strip_encoder;
+    uint32_t strip_len;
+    uint8_t bytes_per_pixel;
+    size_t frame_size;          // bytes of the pixels of a frame
+    led_color_component_format_t component_fmt;
+    uint8_t palette_bits;       // 0 unless the pixels are palette indices
+    uint8_t *palette;           // entries being set, in wire order
+    uint8_t *tx_palette;        // entries read by the encoder, copied from palette by each refresh
+    led_strip_refresh_done_cb_t on_refresh_done;
+    void *user_ctx;
+    const uint8_t *color_lut;   // applied by the encoder from the next refresh, NULL if none
+    uint8_t *pixel_buf;     // pixels being set
+    uint8_t *front_buf;     // pixels being transmitted with double buffering, NULL otherwise
+    uint8_t pixel_mem[];
+} led_strip_rmt_obj;
+
+static esp_err_t led_strip_rmt_set_pixel(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_FALSE(index < rmt_strip->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    ESP_RETURN_ON_FALSE(!rmt_strip->palette_bits, ESP_ERR_INVALID_STATE, TAG, "palette strip, set palette indices");
+
+    led_color_component_format_t component_fmt = rmt_strip->component_fmt;
+    uint32_t start = index * rmt_strip->bytes_per_pixel;
+    uint8_t *pixel_buf = rmt_strip->pixel_buf;
+
+    pixel_buf[start + component_fmt.format.r_pos] = red & 0xFF;
+    pixel_buf[start + component_fmt.format.g_pos] = green & 0xFF;
+    pixel_buf[start + component_fmt.format.b_pos] = blue & 0xFF;
+    if (component_fmt.format.num_components > 3) {
+        pixel_buf[start + component_fmt.format.w_pos] = 0;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_set_pixel_rgbw(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    led_color_component_format_t component_fmt = rmt_strip->component_fmt;
+    ESP_RETURN_ON_FALSE(index < rmt_strip->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    ESP_RETURN_ON_FALSE(component_fmt.format.num_components == 4, ESP_ERR_INVALID_ARG, TAG, "led doesn't have 4 components");
+    ESP_RETURN_ON_FALSE(!rmt_strip->palette_bits, ESP_ERR_INVALID_STATE, TAG, "palette strip, set palette indices");
+
+    uint32_t start = index * rmt_strip->bytes_per_pixel;
+    uint8_t *pixel_buf = rmt_strip->pixel_buf;
+
+    pixel_buf[start + component_fmt.format.r_pos] = red & 0xFF;
+    pixel_buf[start + component_fmt.format.g_pos] = green & 0xFF;
+    pixel_buf[start + component_fmt.format.b_pos] = blue & 0xFF;
+    pixel_buf[start + component_fmt.format.w_pos] = white & 0xFF;
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_set_pixels(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *rgb)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_FALSE(start <= rmt_strip->strip_len && count <= rmt_strip->strip_len - start, ESP_ERR_INVALID_ARG, TAG,
+                        "pixels out of maximum number of LEDs");
+    ESP_RETURN_ON_FALSE(!rmt_strip->palette_bits, ESP_ERR_INVALID_STATE, TAG, "palette strip, set palette indices");
+
+    led_color_component_format_t component_fmt = rmt_strip->component_fmt;
+    uint8_t bytes_per_pixel = rmt_strip->bytes_per_pixel;
+    uint8_t *pixel_buf = rmt_strip->pixel_buf + start * bytes_per_pixel;
+    if (bytes_per_pixel == 3 && component_fmt.format.r_pos == 0 && component_fmt.format.g_pos == 1 && component_fmt.format.b_pos == 2) {
+        // same layout as the input
+        memcpy(pixel_buf, rgb, count * 3);
+        return ESP_OK;
+    }
+
+    uint8_t r_pos = component_fmt.format.r_pos;
+    uint8_t g_pos = component_fmt.format.g_pos;
+    uint8_t b_pos = component_fmt.format.b_pos;
+    uint8_t w_pos = component_fmt.format.w_pos;
+    bool has_white = component_fmt.format.num_components > 3;
+    for (uint32_t i = 0; i < count; i++) {
+        pixel_buf[r_pos] = rgb[0];
+        pixel_buf[g_pos] = rgb[1];
+        pixel_buf[b_pos] = rgb[2];
+        if (has_white) {
+            pixel_buf[w_pos] = 0;
+        }
+        pixel_buf += bytes_per_pixel;
+        rgb += 3;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_set_pixels_rgbw(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *rgbw)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    led_color_component_format_t component_fmt = rmt_strip->component_fmt;
+    ESP_RETURN_ON_FALSE(start <= rmt_strip->strip_len && count <= rmt_strip->strip_len - start, ESP_ERR_INVALID_ARG, TAG,
+                        "pixels out of maximum number of LEDs");
+    ESP_RETURN_ON_FALSE(component_fmt.format.num_components == 4, ESP_ERR_INVALID_ARG, TAG, "led doesn't have 4 components");
+    ESP_RETURN_ON_FALSE(!rmt_strip->palette_bits, ESP_ERR_INVALID_STATE, TAG, "palette strip, set palette indices");
+
+    uint8_t *pixel_buf = rmt_strip->pixel_buf + start * 4;
+    if (component_fmt.format.r_pos == 0 && component_fmt.format.g_pos == 1 && component_fmt.format.b_pos == 2 && component_fmt.format.w_pos == 3) {
+        // same layout as the input
+        memcpy(pixel_buf, rgbw, count * 4);
+        return ESP_OK;
+    }
+
+    uint8_t r_pos = component_fmt.format.r_pos;
+    uint8_t g_pos = component_fmt.format.g_pos;
+    uint8_t b_pos = component_fmt.format.b_pos;
+    uint8_t w_pos = component_fmt.format.w_pos;
+    for (uint32_t i = 0; i < count; i++) {
+        pixel_buf[r_pos] = rgbw[0];
+        pixel_buf[g_pos] = rgbw[1];
+        pixel_buf[b_pos] = rgbw[2];
+        pixel_buf[w_pos] = rgbw[3];
+        pixel_buf += 4;
+        rgbw += 4;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_set_palette(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *colors)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_FALSE(rmt_strip->palette_bits, ESP_ERR_INVALID_STATE, TAG, "not a palette strip");
+    uint32_t palette_len = 1 << rmt_strip->palette_bits;
+    ESP_RETURN_ON_FALSE(start <= palette_len && count <= palette_len - start, ESP_ERR_INVALID_ARG, TAG, "entries out of the palette");
+    // the encoder reads its own copy, taken by the next refresh
+    led_strip_palette_put_colors(rmt_strip->palette, rmt_strip->component_fmt, start, count, colors);
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_set_pixels_index(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *indices)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    uint8_t palette_bits = rmt_strip->palette_bits;
+    ESP_RETURN_ON_FALSE(palette_bits, ESP_ERR_INVALID_STATE, TAG, "not a palette strip");
+    ESP_RETURN_ON_FALSE(start <= rmt_strip->strip_len && count <= rmt_strip->strip_len - start, ESP_ERR_INVALID_ARG, TAG,
+                        "pixels out of maximum number of LEDs");
+    if (palette_bits == 8) {
+        memcpy(rmt_strip->pixel_buf + start, indices, count);
+        return ESP_OK;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        ESP_RETURN_ON_FALSE(indices[i] < 16, ESP_ERR_INVALID_ARG, TAG, "index out of the palette");
+        led_strip_palette_put_index(rmt_strip->pixel_buf, palette_bits, start + i, indices[i]);
+    }
+    return ESP_OK;
+}
+
+static bool IRAM_ATTR led_strip_rmt_trans_done(rmt_channel_handle_t tx_chan, const rmt_tx_done_event_data_t *edata, void *user_ctx)
+{
+    led_strip_rmt_obj *rmt_strip = (led_strip_rmt_obj *)user_ctx;
+    if (rmt_strip->on_refresh_done) {
+        return rmt_strip->on_refresh_done(&rmt_strip->base, rmt_strip->user_ctx);
+    }
+    return false;
+}
+
+static esp_err_t led_strip_rmt_wait_refresh_done(led_strip_t *strip, int32_t timeout_ms)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    return rmt_tx_wait_all_done(rmt_strip->rmt_chan, timeout_ms);
+}
+
+static esp_err_t led_strip_rmt_refresh_async(led_strip_t *strip)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    rmt_transmit_config_t tx_conf = {
+        .loop_count = 0,
+    };
+    size_t frame_size = rmt_strip->frame_size;
+
+    // the buffer of the previous frame is reused below
+    ESP_RETURN_ON_ERROR(rmt_tx_wait_all_done(rmt_strip->rmt_chan, -1), TAG, "flush RMT channel failed");
+    if (rmt_strip->palette_bits) {
+        // the palette can be changed again as soon as the refresh is started
+        memcpy(rmt_strip->tx_palette, rmt_strip->palette, (1 << rmt_strip->palette_bits) * rmt_strip->bytes_per_pixel);
+    }
+    // the encoder is idle now, a new table applies to the whole frame
+    ESP_RETURN_ON_ERROR(rmt_led_strip_encoder_set_color_lut(rmt_strip->strip_encoder, rmt_strip->color_lut), TAG, "set color LUT failed");
+    ESP_RETURN_ON_ERROR(rmt_led_strip_encoder_set_rle(rmt_strip->strip_encoder, 0), TAG, "set encoder mode failed");
+    uint8_t *tx_buf = rmt_strip->pixel_buf;
+    if (rmt_strip->front_buf) {
+        // swap, then start the next frame from this one as the pixels are set incrementally
+        rmt_strip->pixel_buf = rmt_strip->front_buf;
+        rmt_strip->front_buf = tx_buf;
+        memcpy(rmt_strip->pixel_buf, tx_buf, frame_size);
+    }
+    ESP_RETURN_ON_ERROR(rmt_transmit(rmt_strip->rmt_chan, rmt_strip->strip_encoder, tx_buf, frame_size, &tx_conf),
+                        TAG, "transmit pixels by RMT failed");
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_refresh_rle_async(led_strip_t *strip, const led_strip_rle_show_t *show, const led_strip_rle_frame_t *frame)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_FALSE(!rmt_strip->palette_bits, ESP_ERR_INVALID_STATE, TAG, "palette strip, shows are colors");
+    ESP_RETURN_ON_FALSE(show->num_components == rmt_strip->bytes_per_pixel && show->num_leds <= rmt_strip->strip_len,
+                        ESP_ERR_INVALID_ARG, TAG, "show of %lu LEDs of %d components", (unsigned long)show->num_leds, show->num_components);
+    rmt_transmit_config_t tx_conf = {
+        .loop_count = 0,
+    };
+
+    ESP_RETURN_ON_ERROR(rmt_tx_wait_all_done(rmt_strip->rmt_chan, -1), TAG, "flush RMT channel failed");
+    ESP_RETURN_ON_ERROR(rmt_led_strip_encoder_set_color_lut(rmt_strip->strip_encoder, rmt_strip->color_lut), TAG, "set color LUT failed");
+    // the runs are decoded by the encoder, the pixel buffers are left for the next refresh
+    ESP_RETURN_ON_ERROR(rmt_led_strip_encoder_set_rle(rmt_strip->strip_encoder, show->num_components), TAG, "set encoder mode failed");
+    ESP_RETURN_ON_ERROR(rmt_transmit(rmt_strip->rmt_chan, rmt_strip->strip_encoder, frame->runs, frame->size, &tx_conf),
+                        TAG, "transmit runs by RMT failed");
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_refresh(led_strip_t *strip)
+{
+    ESP_RETURN_ON_ERROR(led_strip_rmt_refresh_async(strip), TAG, "start refresh failed");
+    ESP_RETURN_ON_ERROR(led_strip_rmt_wait_refresh_done(strip, -1), TAG, "flush RMT channel failed");
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_register_event_callbacks(led_strip_t *strip, const led_strip_event_callbacks_t *cbs, void *user_ctx)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    // the RMT callback is always registered, it only forwards to these
+    rmt_strip->user_ctx = user_ctx;
+    rmt_strip->on_refresh_done = cbs->on_refresh_done;
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_set_color_lut(led_strip_t *strip, const uint8_t *lut)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    rmt_strip->color_lut = lut;
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_clear(led_strip_t *strip)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    if (!rmt_strip->front_buf) {
+        // the single buffer may still be on the wire
+        ESP_RETURN_ON_ERROR(rmt_tx_wait_all_done(rmt_strip->rmt_chan, -1), TAG, "flush RMT channel failed");
+    }
+    // Write zero to turn off all leds
+    memset(rmt_strip->pixel_buf, 0, rmt_strip->frame_size);
+    return led_strip_rmt_refresh(strip);
+}
+
+static esp_err_t led_strip_rmt_del(led_strip_t *strip)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_ERROR(rmt_tx_wait_all_done(rmt_strip->rmt_chan, -1), TAG, "flush RMT channel failed");
+    ESP_RETURN_ON_ERROR(rmt_disable(rmt_strip->rmt_chan), TAG, "disable RMT channel failed");
+    ESP_RETURN_ON_ERROR(rmt_del_channel(rmt_strip->rmt_chan), TAG, "delete RMT channel failed");
+    ESP_RETURN_ON_ERROR(rmt_del_encoder(rmt_strip->strip_encoder), TAG, "delete strip encoder failed");
+    free(rmt_strip);
+    return ESP_OK;
+}
+
+esp_err_t led_strip_rmt_get_channel(led_strip_handle_t strip, rmt_channel_handle_t *ret_chan)
+{
+    ESP_RETURN_ON_FALSE(strip && ret_chan, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(strip->del == led_strip_rmt_del, ESP_ERR_INVALID_ARG, TAG, "not an RMT strip");
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    *ret_chan = rmt_strip->rmt_chan;
+    return ESP_OK;
+}
+
+esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const led_strip_rmt_config_t *rmt_config, led_strip_handle_t *ret_strip)
+{
+    led_strip_rmt_obj *rmt_strip = NULL;
+    esp_err_t ret = ESP_OK;
+    ESP_GOTO_ON_FALSE(led_config && rmt_config && ret_strip, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
+    led_color_component_format_t component_fmt = led_config->color_component_format;
+    // If R/G/B order is not specified, set default GRB order as fallback
+    if (component_fmt.format_id == 0) {
+        component_fmt = LED_STRIP_COLOR_COMPONENT_FMT_GRB;
+    }
+    // check the validation of the color component format
+    uint8_t mask = 0;
+    if (component_fmt.format.num_components == 3) {
+        mask = BIT(component_fmt.format.r_pos) | BIT(component_fmt.format.g_pos) | BIT(component_fmt.format.b_pos);
+        // Check for invalid values
+        ESP_RETURN_ON_FALSE(mask == 0x07, ESP_ERR_INVALID_ARG, TAG, "invalid order argument");
+    } else if (component_fmt.format.num_components == 4) {
+        mask = BIT(component_fmt.format.r_pos) | BIT(component_fmt.format.g_pos) | BIT(component_fmt.format.b_pos) | BIT(component_fmt.format.w_pos);
+        // Check for invalid values
+        ESP_RETURN_ON_FALSE(mask == 0x0F, ESP_ERR_INVALID_ARG, TAG, "invalid order argument");
+    } else {
+        ESP_RETURN_ON_FALSE(false, ESP_ERR_INVALID_ARG, TAG, "invalid number of color components: %d", component_fmt.format.num_components);
+    }
+    uint8_t palette_bits = led_config->palette_bits;
+    ESP_RETURN_ON_FALSE(palette_bits == 0 || palette_bits == 4 || palette_bits == 8, ESP_ERR_INVALID_ARG, TAG,
+                        "invalid palette bits: %d", palette_bits);
+    // TODO: we assume each color component is 8 bits, may need to support other configurations in the future, e.g. 10bits per color component?
+    uint8_t bytes_per_pixel = component_fmt.format.num_components;
+    size_t frame_size = palette_bits ? led_strip_palette_frame_size(palette_bits, led_config->max_leds) : led_config->max_leds * bytes_per_pixel;
+    size_t num_buffers = led_config->flags.double_buffer ? 2 : 1;
+    // the palette being set and the one of the frame in flight
+    size_t palette_size = palette_bits ? (1 << palette_bits) * bytes_per_pixel : 0;
+    rmt_strip = calloc(1, sizeof(led_strip_rmt_obj) + num_buffers * frame_size + 2 * palette_size);
+    ESP_GOTO_ON_FALSE(rmt_strip, ESP_ERR_NO_MEM, err, TAG, "no mem for rmt strip");
+    rmt_strip->pixel_buf = rmt_strip->pixel_mem;
+    if (led_config->flags.double_buffer) {
+        rmt_strip->front_buf = rmt_strip->pixel_mem + frame_size;
+    }
+    if (palette_bits) {
+        rmt_strip->palette = rmt_strip->pixel_mem + num_buffers * frame_size;
+        rmt_strip->tx_palette = rmt_strip->palette + palette_size;
+    }
+    uint32_t resolution = rmt_config->resolution_hz ? rmt_config->resolution_hz : LED_STRIP_RMT_DEFAULT_RESOLUTION;
+
+    // for backward compatibility, if the user does not set the clk_src, use the default value
+    rmt_clock_source_t clk_src = RMT_CLK_SRC_DEFAULT;
+    if (rmt_config->clk_src) {
+        clk_src = rmt_config->clk_src;
+    }
+    size_t mem_block_symbols = LED_STRIP_RMT_DEFAULT_MEM_BLOCK_SYMBOLS;
+    // override the default value if the user sets it
+    if (rmt_config->mem_block_symbols) {
+        mem_block_symbols = rmt_config->mem_block_symbols;
+    }
+    rmt_tx_channel_config_t rmt_chan_config = {
+        .clk_src = clk_src,
+        .gpio_num = led_config->strip_gpio_num,
+        .mem_block_symbols = mem_block_symbols,
+        .resolution_hz = resolution,
+        .trans_queue_depth = LED_STRIP_RMT_DEFAULT_TRANS_QUEUE_SIZE,
+        .flags.with_dma = rmt_config->flags.with_dma,
+        .flags.invert_out = led_config->flags.invert_out,
+    };
+    ESP_GOTO_ON_ERROR(rmt_new_tx_channel(&rmt_chan_config, &rmt_strip->rmt_chan), err, TAG, "create RMT TX channel failed");
+
+    led_strip_encoder_config_t strip_encoder_conf = {
+        .resolution = resolution,
+        .led_model = led_config->led_model
+    };
+    if (palette_bits) {
+        // the entries are kept in wire order, the pixels are only indices
+        strip_encoder_conf.palette.bits = palette_bits;
+        strip_encoder_conf.palette.num_components = bytes_per_pixel;
+        strip_encoder_conf.palette.num_pixels = led_config->max_leds;
+        strip_encoder_conf.palette.colors = rmt_strip->tx_palette;
+    } else if (rmt_config->flags.encoder_reorder) {
+        // the pixels are kept in R, G, B(, W) order, the encoder sends them in the order of the LEDs
+        strip_encoder_conf.reorder_fmt = component_fmt;
+        uint8_t num_components = component_fmt.format.num_components;
+        component_fmt = num_components > 3 ? LED_STRIP_COLOR_COMPONENT_FMT_RGBW : LED_STRIP_COLOR_COMPONENT_FMT_RGB;
+    }
+    ESP_GOTO_ON_ERROR(rmt_new_led_strip_encoder(&strip_encoder_conf, &rmt_strip->strip_encoder), err, TAG, "create LED strip encoder failed");
+
+    rmt_tx_event_callbacks_t rmt_cbs = {
+        .on_trans_done = led_strip_rmt_trans_done,
+    };
+    ESP_GOTO_ON_ERROR(rmt_tx_register_event_callbacks(rmt_strip->rmt_chan, &rmt_cbs, rmt_strip), err, TAG, "register RMT callbacks failed");
+    // the channel stays enabled between frames, the refresh only has to queue a transmission
+    ESP_GOTO_ON_ERROR(rmt_enable(rmt_strip->rmt_chan), err, TAG, "enable RMT channel failed");
+
+    rmt_strip->component_fmt = component_fmt;
+    rmt_strip->bytes_per_pixel = bytes_per_pixel;
+    rmt_strip->frame_size = frame_size;
+    rmt_strip->palette_bits = palette_bits;
+    rmt_strip->strip_len = led_config->max_leds;
+    rmt_strip->base.set_pixel = led_strip_rmt_set_pixel;
+    rmt_strip->base.set_pixel_rgbw = led_strip_rmt_set_pixel_rgbw;
+    rmt_strip->base.set_pixels = led_strip_rmt_set_pixels;
+    rmt_strip->base.set_pixels_rgbw = led_strip_rmt_set_pixels_rgbw;
+    rmt_strip->base.refresh = led_strip_rmt_refresh;
+    rmt_strip->base.refresh_async = led_strip_rmt_refresh_async;
+    rmt_strip->base.wait_refresh_done = led_strip_rmt_wait_refresh_done;
+    rmt_strip->base.refresh_rle_async = led_strip_rmt_refresh_rle_async;
+    rmt_strip->base.register_event_callbacks = led_strip_rmt_register_event_callbacks;
+    rmt_strip->base.set_color_lut = led_strip_rmt_set_color_lut;
+    rmt_strip->base.set_palette = led_strip_rmt_set_palette;
+    rmt_strip->base.set_pixels_index = led_strip_rmt_set_pixels_index;
+    rmt_strip->base.clear = led_strip_rmt_clear;
+    rmt_strip->base.del = led_strip_rmt_del;
+
+    *ret_strip = &rmt_strip->base;
+    return ESP_OK;
+err:
+    if (rmt_strip) {
+        if (rmt_strip->rmt_chan) {
+            rmt_del_channel(rmt_strip->rmt_chan);
+        }
+        if (rmt_strip->strip_encoder) {
+            rmt_del_encoder(rmt_strip->strip_encoder);
+        }
+        free(rmt_strip);
+    }
+    return ret;
+}
@@ -0,0 +1,29 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include "esp_err.h"
+#include "driver/rmt_types.h"
+#include "led_strip_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Get the RMT TX channel that drives an LED strip
+ *
+ * @param[in] strip LED strip
+ * @param[out] ret_chan Returned RMT channel handle
+ * @return
+ *      - ESP_ERR_INVALID_ARG for any invalid arguments, or if the strip is not driven by the RMT backend
+ *      - ESP_OK if the channel is returned successfully
+ */
+esp_err_t led_strip_rmt_get_channel(led_strip_handle_t strip, rmt_channel_handle_t *ret_chan);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,320 @@
+/*
+ * SPDX-FileCopyrightText: 2022 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_check.h"
+#include "led_strip_rmt_encoder.h"
+#include "led_strip_palette.h"
+#include "led_strip_rle.h"
+
+static const char *TAG = "led_rmt_encoder";
+
+// bytes transformed at a time, a whole number of 3 and 4 component pixels
+#define LED_STRIP_ENCODER_CHUNK_SIZE 48
+
+typedef struct {
+    rmt_encoder_t base;
+    rmt_encoder_t *bytes_encoder;
+    rmt_encoder_t *copy_encoder;
+    int state;
+    rmt_symbol_word_t reset_code;
+    const uint8_t *lut;         // color lookup table, NULL if none
+    uint8_t num_components;     // 0 if the pixels are in wire order
+    uint8_t src_index[4];       // component of the R, G, B(, W) pixel sent at each wire position
+    uint8_t palette_bits;       // 0 unless the pixels are palette indices
+    uint8_t palette_components;
+    uint32_t palette_pixels;
+    const uint8_t *palette;     // entries in wire order
+    uint8_t rle_components;     // bytes of a pixel when the frame is run-length encoded, 0 otherwise
+    led_strip_rle_decoder_t rle;
+    size_t data_offset;         // bytes of the pixels transformed so far in this frame, pixels with a palette,
+                                // bytes of the runs decoded so far when run-length encoded
+    size_t chunk_size;          // bytes in chunk, 0 once they are all encoded
+    uint8_t chunk[LED_STRIP_ENCODER_CHUNK_SIZE];
+} rmt_led_strip_encoder_t;
+
+// expand the next palette indices of the frame
+static void rmt_led_strip_fill_chunk_palette(rmt_led_strip_encoder_t *led_encoder, const uint8_t *data)
+{
+    const uint8_t *lut = led_encoder->lut;
+    uint8_t num_components = led_encoder->palette_components;
+    uint32_t pixel = led_encoder->data_offset;
+    uint32_t count = led_encoder->palette_pixels - pixel;
+    if (count > LED_STRIP_ENCODER_CHUNK_SIZE / num_components) {
+        count = LED_STRIP_ENCODER_CHUNK_SIZE / num_components;
+    }
+    uint8_t *chunk = led_encoder->chunk;
+    for (uint32_t i = 0; i < count; i++, chunk += num_components) {
+        const uint8_t *entry = led_encoder->palette + led_strip_palette_get_index(data, led_encoder->palette_bits, pixel + i) * num_components;
+        for (uint8_t c = 0; c < num_components; c++) {
+            chunk[c] = lut ? lut[entry[c]] : entry[c];
+        }
+    }
+    led_encoder->data_offset += count;
+    led_encoder->chunk_size = count * num_components;
+}
+
+// decode the next runs of the frame, straight from where they are stored
+static void rmt_led_strip_fill_chunk_rle(rmt_led_strip_encoder_t *led_encoder, const uint8_t *data, size_t data_size)
+{
+    if (!led_encoder->data_offset) {
+        led_strip_rle_frame_t frame = {
+            .runs = data,
+            .size = data_size,
+        };
+        led_strip_rle_decoder_init(&led_encoder->rle, &frame);
+    }
+    uint8_t num_components = led_encoder->rle_components;
+    uint32_t count = led_strip_rle_decode(&led_encoder->rle, num_components, led_encoder->chunk,
+                                          LED_STRIP_ENCODER_CHUNK_SIZE / num_components);
+    const uint8_t *lut = led_encoder->lut;
+    if (lut) {
+        for (uint32_t i = 0; i < count * num_components; i++) {
+            led_encoder->chunk[i] = lut[led_encoder->chunk[i]];
+        }
+    }
+    led_encoder->data_offset = led_encoder->rle.offset;
+    led_encoder->chunk_size = count * num_components;
+}
+
+// transform the next pixels of the frame, while the previous ones are on the wire
+static void rmt_led_strip_fill_chunk(rmt_led_strip_encoder_t *led_encoder, const uint8_t *data, size_t data_size)
+{
+    if (led_encoder->rle_components) {
+        rmt_led_strip_fill_chunk_rle(led_encoder, data, data_size);
+        return;
+    }
+    if (led_encoder->palette) {
+        rmt_led_strip_fill_chunk_palette(led_encoder, data);
+        return;
+    }
+    const uint8_t *lut = led_encoder->lut;
+    const uint8_t *src = data + led_encoder->data_offset;
+    size_t size = data_size - led_encoder->data_offset;
+    if (size > LED_STRIP_ENCODER_CHUNK_SIZE) {
+        size = LED_STRIP_ENCODER_CHUNK_SIZE;
+    }
+    uint8_t num_components = led_encoder->num_components;
+    if (num_components) {
+        const uint8_t *src_index = led_encoder->src_index;
+        for (size_t i = 0; i + num_components <= size; i += num_components) {
+            for (uint8_t c = 0; c < num_components; c++) {
+                uint8_t value = src[i + src_index[c]];
+                led_encoder->chunk[i + c] = lut ? lut[value] : value;
+            }
+        }
+    } else {
+        for (size_t i = 0; i < size; i++) {
+            led_encoder->chunk[i] = lut[src[i]];
+        }
+    }
+    led_encoder->data_offset += size;
+    led_encoder->chunk_size = size;
+}
+
+static size_t rmt_encode_led_strip(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state)
+{
+    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+    rmt_encoder_handle_t bytes_encoder = led_encoder->bytes_encoder;
+    rmt_encoder_handle_t copy_encoder = led_encoder->copy_encoder;
+    rmt_encode_state_t session_state = 0;
+    rmt_encode_state_t state = 0;
+    size_t encoded_symbols = 0;
+    // a palette frame is counted in pixels
+    size_t frame_end = led_encoder->palette && !led_encoder->rle_components ? led_encoder->palette_pixels : data_size;
+    switch (led_encoder->state) {
+    case 0: // send RGB data
+        if (led_encoder->lut || led_encoder->num_components || led_encoder->palette || led_encoder->rle_components) {
+            // the pixels go through the chunk, the bytes encoder resumes in it after a yield
+            while (led_encoder->chunk_size || led_encoder->data_offset < frame_end) {
+                if (!led_encoder->chunk_size) {
+                    rmt_led_strip_fill_chunk(led_encoder, primary_data, data_size);
+                }
+                encoded_symbols += bytes_encoder->encode(bytes_encoder, channel, led_encoder->chunk, led_encoder->chunk_size, &session_state);
+                if (session_state & RMT_ENCODING_COMPLETE) {
+                    led_encoder->chunk_size = 0;
+                }
+                if (session_state & RMT_ENCODING_MEM_FULL) {
+                    state |= RMT_ENCODING_MEM_FULL;
+                    goto out; // yield if there's no free space for encoding artifacts
+                }
+            }
+            led_encoder->data_offset = 0;
+            led_encoder->state = 1;
+        } else {
+            encoded_symbols += bytes_encoder->encode(bytes_encoder, channel, primary_data, data_size, &session_state);
+            if (session_state & RMT_ENCODING_COMPLETE) {
+                led_encoder->state = 1; // switch to next state when current encoding session finished
+            }
+            if (session_state & RMT_ENCODING_MEM_FULL) {
+                state |= RMT_ENCODING_MEM_FULL;
+                goto out; // yield if there's no free space for encoding artifacts
+            }
+        }
+    // fall-through
+    case 1: // send reset code
+        encoded_symbols += copy_encoder->encode(copy_encoder, channel, &led_encoder->reset_code,
+                                                sizeof(led_encoder->reset_code), &session_state);
+        if (session_state & RMT_ENCODING_COMPLETE) {
+            led_encoder->state = 0; // back to the initial encoding session
+            state |= RMT_ENCODING_COMPLETE;
+        }
+        if (session_state & RMT_ENCODING_MEM_FULL) {
+            state |= RMT_ENCODING_MEM_FULL;
+            goto out; // yield if there's no free space for encoding artifacts
+        }
+    }
+out:
+    *ret_state = state;
+    return encoded_symbols;
+}
+
+static esp_err_t rmt_del_led_strip_encoder(rmt_encoder_t *encoder)
+{
+    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+    rmt_del_encoder(led_encoder->bytes_encoder);
+    rmt_del_encoder(led_encoder->copy_encoder);
+    free(led_encoder);
+    return ESP_OK;
+}
+
+static esp_err_t rmt_led_strip_encoder_reset(rmt_encoder_t *encoder)
+{
+    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+    rmt_encoder_reset(led_encoder->bytes_encoder);
+    rmt_encoder_reset(led_encoder->copy_encoder);
+    led_encoder->state = 0;
+    led_encoder->data_offset = 0;
+    led_encoder->chunk_size = 0;
+    return ESP_OK;
+}
+
+esp_err_t rmt_led_strip_encoder_set_color_lut(rmt_encoder_handle_t encoder, const uint8_t *lut)
+{
+    ESP_RETURN_ON_FALSE(encoder, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+    led_encoder->lut = lut;
+    return ESP_OK;
+}
+
+esp_err_t rmt_led_strip_encoder_set_rle(rmt_encoder_handle_t encoder, uint8_t num_components)
+{
+    ESP_RETURN_ON_FALSE(encoder && (num_components == 0 || num_components == 3 || num_components == 4), ESP_ERR_INVALID_ARG, TAG,
+                        "invalid argument");
+    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+    led_encoder->rle_components = num_components;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+    esp_err_t ret = ESP_OK;
+    rmt_led_strip_encoder_t *led_encoder = NULL;
+    ESP_GOTO_ON_FALSE(config && ret_encoder, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
+    ESP_GOTO_ON_FALSE(config->led_model < LED_MODEL_INVALID, ESP_ERR_INVALID_ARG, err, TAG, "invalid led model");
+    led_encoder = calloc(1, sizeof(rmt_led_strip_encoder_t));
+    ESP_GOTO_ON_FALSE(led_encoder, ESP_ERR_NO_MEM, err, TAG, "no mem for led strip encoder");
+    led_encoder->base.encode = rmt_encode_led_strip;
+    led_encoder->base.del = rmt_del_led_strip_encoder;
+    led_encoder->base.reset = rmt_led_strip_encoder_reset;
+    if (config->palette.bits) {
+        ESP_GOTO_ON_FALSE((config->palette.bits == 4 || config->palette.bits == 8) && config->palette.colors &&
+                          (config->palette.num_components == 3 || config->palette.num_components == 4),
+                          ESP_ERR_INVALID_ARG, err, TAG, "invalid palette");
+        // the entries are in wire order already
+        led_encoder->palette_bits = config->palette.bits;
+        led_encoder->palette_components = config->palette.num_components;
+        led_encoder->palette_pixels = config->palette.num_pixels;
+        led_encoder->palette = config->palette.colors;
+    } else if (config->reorder_fmt.format.num_components) {
+        led_color_component_format_t fmt = config->reorder_fmt;
+        led_encoder->num_components = fmt.format.num_components;
+        led_encoder->src_index[fmt.format.r_pos] = 0;
+        led_encoder->src_index[fmt.format.g_pos] = 1;
+        led_encoder->src_index[fmt.format.b_pos] = 2;
+        if (fmt.format.num_components > 3) {
+            led_encoder->src_index[fmt.format.w_pos] = 3;
+        }
+    }
+    rmt_bytes_encoder_config_t bytes_encoder_config;
+    uint32_t reset_ticks = config->resolution / 1000000 * 280 / 2; // reset code duration defaults to 280us to accomodate WS2812B-V5
+    if (config->led_model == LED_MODEL_SK6812) {
+        bytes_encoder_config = (rmt_bytes_encoder_config_t) {
+            .bit0 = {
+                .level0 = 1,
+                .duration0 = 0.3 * config->resolution / 1000000, // T0H=0.3us
+                .level1 = 0,
+                .duration1 = 0.9 * config->resolution / 1000000, // T0L=0.9us
+            },
+            .bit1 = {
+                .level0 = 1,
+                .duration0 = 0.6 * config->resolution / 1000000, // T1H=0.6us
+                .level1 = 0,
+                .duration1 = 0.6 * config->resolution / 1000000, // T1L=0.6us
+            },
+            .flags.msb_first = 1 // SK6812 transfer bit order: G7...G0R7...R0B7...B0(W7...W0)
+        };
+    } else if (config->led_model == LED_MODEL_WS2812) {
+        // different led strip might have its own timing requirements, following parameter is for WS2812
+        bytes_encoder_config = (rmt_bytes_encoder_config_t) {
+            .bit0 = {
+                .level0 = 1,
+                .duration0 = 0.3 * config->resolution / 1000000, // T0H=0.3us
+                .level1 = 0,
+                .duration1 = 0.9 * config->resolution / 1000000, // T0L=0.9us
+            },
+            .bit1 = {
+                .level0 = 1,
+                .duration0 = 0.9 * config->resolution / 1000000, // T1H=0.9us
+                .level1 = 0,
+                .duration1 = 0.3 * config->resolution / 1000000, // T1L=0.3us
+            },
+            .flags.msb_first = 1 // WS2812 transfer bit order: G7...G0R7...R0B7...B0
+        };
+    } else if (config->led_model == LED_MODEL_WS2811) {
+        // different led strip might have its own timing requirements, following parameter is for WS2811
+        bytes_encoder_config = (rmt_bytes_encoder_config_t) {
+            .bit0 = {
+                .level0 = 1,
+                .duration0 = 0.5 * config->resolution / 1000000., // T0H=0.5us
+                .level1 = 0,
+                .duration1 = 2.0 * config->resolution / 1000000., // T0L=2.0us
+            },
+            .bit1 = {
+                .level0 = 1,
+                .duration0 = 1.2 * config->resolution / 1000000., // T1H=1.2us
+                .level1 = 0,
+                .duration1 = 1.3 * config->resolution / 1000000., // T1L=1.3us
+            },
+            .flags.msb_first = 1
+        };
+        reset_ticks = config->resolution / 1000000 * 50 / 2; // divide by 2... signal is sent twice
+    } else {
+        assert(false);
+    }
+    ESP_GOTO_ON_ERROR(rmt_new_bytes_encoder(&bytes_encoder_config, &led_encoder->bytes_encoder), err, TAG, "create bytes encoder failed");
+    rmt_copy_encoder_config_t copy_encoder_config = {};
+    ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&copy_encoder_config, &led_encoder->copy_encoder), err, TAG, "create copy encoder failed");
+
+    led_encoder->reset_code = (rmt_symbol_word_t) {
+        .level0 = 0,
+        .duration0 = reset_ticks,
+        .level1 = 0,
+        .duration1 = reset_ticks,
+    };
+    *ret_encoder = &led_encoder->base;
+    return ESP_OK;
+err:
+    if (led_encoder) {
+        if (led_encoder->bytes_encoder) {
+            rmt_del_encoder(led_encoder->bytes_encoder);
+        }
+        if (led_encoder->copy_encoder) {
+            rmt_del_encoder(led_encoder->copy_encoder);
+        }
+        free(led_encoder);
+    }
+    return ret;
+}
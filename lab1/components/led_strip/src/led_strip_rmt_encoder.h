@@ -0,0 +1,75 @@
+/*
+ * SPDX-FileCopyrightText: 2022 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include "driver/rmt_encoder.h"
+#include "led_strip_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Type of led strip encoder configuration
+ */
+typedef struct {
+    uint32_t resolution;   /*!< Encoder resolution, in Hz */
+    led_model_t led_model; /*!< LED model */
+    led_color_component_format_t reorder_fmt; /*!< If num_components is set, the pixels are kept in R, G, B(, W) order
+                                                   and reordered to this format while encoding. Leave zero when the pixels
+                                                   are already in wire order */
+    struct {
+        uint8_t bits;               /*!< 4 or 8 when the pixels are indices in this palette, 0 otherwise */
+        uint8_t num_components;     /*!< Bytes of an entry */
+        uint32_t num_pixels;        /*!< Pixels of a frame, the frame bytes may hold a padding nibble */
+        const uint8_t *colors;      /*!< Entries in wire order, kept by reference and read while encoding */
+    } palette;                      /*!< Palette the pixels are expanded from, ignoring `reorder_fmt` */
+} led_strip_encoder_config_t;
+
+/**
+ * @brief Create RMT encoder for encoding LED strip pixels into RMT symbols
+ *
+ * @param[in] config Encoder configuration
+ * @param[out] ret_encoder Returned encoder handle
+ * @return
+ *      - ESP_ERR_INVALID_ARG for any invalid arguments
+ *      - ESP_ERR_NO_MEM out of memory when creating led strip encoder
+ *      - ESP_OK if creating encoder successfully
+ */
+esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder);
+
+/**
+ * @brief Set the lookup table every color byte goes through while encoding
+ *
+ * @note Must not be called while the encoder is in use by a transmission
+ *
+ * @param[in] encoder Encoder created by rmt_new_led_strip_encoder
+ * @param[in] lut 256 entries, kept by reference. NULL to send the bytes as they are
+ * @return
+ *      - ESP_ERR_INVALID_ARG for any invalid arguments
+ *      - ESP_OK if the table is set successfully
+ */
+esp_err_t rmt_led_strip_encoder_set_color_lut(rmt_encoder_handle_t encoder, const uint8_t *lut);
+
+/**
+ * @brief Set whether the next transmissions are the runs of a frame of a run-length encoded show
+ *
+ * @note Must not be called while the encoder is in use by a transmission. The runs are decoded into the
+ *       chunk of the encoder while transmitting, so they can stay in flash; the color table still applies,
+ *       the palette and the reordering do not.
+ *
+ * @param[in] encoder Encoder created by rmt_new_led_strip_encoder
+ * @param[in] num_components Bytes of a pixel of the show, 0 to send frame buffers again
+ * @return
+ *      - ESP_ERR_INVALID_ARG for any invalid arguments
+ *      - ESP_OK if the mode is set successfully
+ */
+esp_err_t rmt_led_strip_encoder_set_rle(rmt_encoder_handle_t encoder, uint8_t num_components);
+
+#ifdef __cplusplus
+}
+#endif
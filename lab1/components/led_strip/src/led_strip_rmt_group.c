@@ -0,0 +1,98 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "driver/rmt_tx.h"
+#include "led_strip.h"
+#include "led_strip_group.h"
+#include "led_strip_rmt_dev.h"
+
+static const char *TAG = "led_strip_group";
+
+struct led_strip_group_t {
+    rmt_sync_manager_handle_t sync_manager;
+    size_t num_strips;
+    led_strip_handle_t *strips;
+    rmt_channel_handle_t *channels;
+};
+
+static void led_strip_group_free(led_strip_group_handle_t group)
+{
+    free(group->strips);
+    free(group->channels);
+    free(group);
+}
+
+esp_err_t led_strip_new_rmt_group(const led_strip_group_config_t *config, led_strip_group_handle_t *ret_group)
+{
+    esp_err_t ret = ESP_OK;
+    led_strip_group_handle_t group = NULL;
+    ESP_RETURN_ON_FALSE(config && config->strips && config->num_strips && ret_group, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    group = calloc(1, sizeof(struct led_strip_group_t));
+    ESP_GOTO_ON_FALSE(group, ESP_ERR_NO_MEM, err, TAG, "no mem for group");
+    group->strips = calloc(config->num_strips, sizeof(led_strip_handle_t));
+    group->channels = calloc(config->num_strips, sizeof(rmt_channel_handle_t));
+    ESP_GOTO_ON_FALSE(group->strips && group->channels, ESP_ERR_NO_MEM, err, TAG, "no mem for group strips");
+    for (size_t i = 0; i < config->num_strips; i++) {
+        group->strips[i] = config->strips[i];
+        ESP_GOTO_ON_ERROR(led_strip_rmt_get_channel(config->strips[i], &group->channels[i]), err, TAG, "strip %d is not an RMT strip", (int)i);
+    }
+    group->num_strips = config->num_strips;
+
+    // the channels are enabled at strip creation, as the sync manager requires
+    rmt_sync_manager_config_t sync_config = {
+        .tx_channel_array = group->channels,
+        .array_size = group->num_strips,
+    };
+    ESP_GOTO_ON_ERROR(rmt_new_sync_manager(&sync_config, &group->sync_manager), err, TAG, "create sync manager failed");
+
+    *ret_group = group;
+    return ESP_OK;
+err:
+    if (group) {
+        led_strip_group_free(group);
+    }
+    return ret;
+}
+
+esp_err_t led_strip_group_wait_done(led_strip_group_handle_t group, int32_t timeout_ms)
+{
+    ESP_RETURN_ON_FALSE(group, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    for (size_t i = 0; i < group->num_strips; i++) {
+        ESP_RETURN_ON_ERROR(led_strip_refresh_wait_done(group->strips[i], timeout_ms), TAG, "wait strip %d failed", (int)i);
+    }
+    return ESP_OK;
+}
+
+esp_err_t led_strip_group_refresh_async(led_strip_group_handle_t group)
+{
+    ESP_RETURN_ON_FALSE(group, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    // the sync manager is re-armed once the previous round is over on every channel
+    ESP_RETURN_ON_ERROR(led_strip_group_wait_done(group, -1), TAG, "flush group failed");
+    ESP_RETURN_ON_ERROR(rmt_sync_reset(group->sync_manager), TAG, "reset sync manager failed");
+    // the transmissions are queued, the last one starts them all
+    for (size_t i = 0; i < group->num_strips; i++) {
+        ESP_RETURN_ON_ERROR(led_strip_refresh_async(group->strips[i]), TAG, "refresh strip %d failed", (int)i);
+    }
+    return ESP_OK;
+}
+
+esp_err_t led_strip_group_refresh(led_strip_group_handle_t group)
+{
+    ESP_RETURN_ON_ERROR(led_strip_group_refresh_async(group), TAG, "start group refresh failed");
+    ESP_RETURN_ON_ERROR(led_strip_group_wait_done(group, -1), TAG, "flush group failed");
+    return ESP_OK;
+}
+
+esp_err_t led_strip_group_del(led_strip_group_handle_t group)
+{
+    ESP_RETURN_ON_FALSE(group, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_ERROR(led_strip_group_wait_done(group, -1), TAG, "flush group failed");
+    ESP_RETURN_ON_ERROR(rmt_del_sync_manager(group->sync_manager), TAG, "delete sync manager failed");
+    led_strip_group_free(group);
+    return ESP_OK;
+}
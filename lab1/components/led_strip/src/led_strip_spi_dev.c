@@ -0,0 +1,538 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <sys/cdefs.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_rom_gpio.h"
+#include "soc/spi_periph.h"
+#include "led_strip.h"
+#include "led_strip_interface.h"
+#include "led_strip_spi_encoder.h"
+#include "led_strip_palette.h"
+
+#define LED_STRIP_SPI_DEFAULT_RESOLUTION (2.5 * 1000 * 1000) // 2.5MHz resolution
+#define LED_STRIP_SPI_DEFAULT_TRANS_QUEUE_SIZE 4
+// pixels expanded in each of the two DMA chunks in streaming mode
+#define LED_STRIP_SPI_STREAM_CHUNK_PIXELS 64
+
+static const char *TAG = "led_strip_spi";
+
+typedef struct {
+    led_strip_t base;
+    spi_host_device_t spi_host;
+    spi_device_handle_t spi_device;
+    uint32_t strip_len;
+    uint8_t bytes_per_pixel;
+    uint32_t pixel_stride;      // bytes of a pixel in pixel_buf
+    led_color_component_format_t component_fmt;
+    uint8_t palette_bits;       // 0 unless the pixels are palette indices, always streamed
+    uint8_t *palette;           // entries in wire order
+    spi_transaction_t trans[2]; // transactions of the refresh in progress, both used in streaming mode only
+    uint8_t trans_pending;      // transactions queued whose result is not collected yet
+    uint8_t *stream_chunks[2];  // DMA chunks the pixels are expanded into in streaming mode, NULL otherwise
+    uint32_t stream_chunk_pixels;
+    uint32_t stream_next;       // next pixel to expand
+    uint32_t stream_end;        // pixels sent by the refresh in progress
+    uint32_t dirty_start;       // pixels [dirty_start, dirty_end) changed since the last refresh
+    uint32_t dirty_end;
+    led_strip_refresh_done_cb_t on_refresh_done;
+    void *user_ctx;
+    uint8_t *pixel_buf;         // pixels being set
+    uint8_t *front_buf;         // pixels being transmitted with double buffering, NULL otherwise
+    uint8_t pixel_mem[];
+} led_strip_spi_obj;
+
+static inline void led_strip_spi_mark_dirty(led_strip_spi_obj *spi_strip, uint32_t first, uint32_t last)
+{
+    if (first < spi_strip->dirty_start) {
+        spi_strip->dirty_start = first;
+    }
+    if (last >= spi_strip->dirty_end) {
+        spi_strip->dirty_end = last + 1;
+    }
+}
+
+// store a pixel, encoded unless streaming, and return whether it changed
+static inline bool led_strip_spi_update(const led_strip_spi_obj *spi_strip, const uint8_t *wire, uint8_t bytes_per_pixel, uint8_t *pixel)
+{
+    if (spi_strip->stream_chunks[0]) {
+        // the components are kept as they are, expanded while transmitting
+        if (memcmp(pixel, wire, bytes_per_pixel) == 0) {
+            return false;
+        }
+        memcpy(pixel, wire, bytes_per_pixel);
+        return true;
+    }
+    return led_strip_spi_update_pixel(wire, bytes_per_pixel, pixel);
+}
+
+// a pixel that does not change is not sent again
+static inline void led_strip_spi_store_pixel(led_strip_spi_obj *spi_strip, uint32_t index, const uint8_t *wire)
+{
+    uint8_t *pixel = spi_strip->pixel_buf + index * spi_strip->pixel_stride;
+    if (led_strip_spi_update(spi_strip, wire, spi_strip->bytes_per_pixel, pixel)) {
+        led_strip_spi_mark_dirty(spi_strip, index, index);
+    }
+}
+
+static esp_err_t led_strip_spi_set_pixel(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    ESP_RETURN_ON_FALSE(index < spi_strip->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    ESP_RETURN_ON_FALSE(!spi_strip->palette_bits, ESP_ERR_INVALID_STATE, TAG, "palette strip, set palette indices");
+    led_color_component_format_t component_fmt = spi_strip->component_fmt;
+    // components in wire order, white stays 0
+    uint8_t wire[4] = {0};
+    wire[component_fmt.format.r_pos] = red & 0xFF;
+    wire[component_fmt.format.g_pos] = green & 0xFF;
+    wire[component_fmt.format.b_pos] = blue & 0xFF;
+    // 3 pixels take 72bits(9bytes)
+    led_strip_spi_store_pixel(spi_strip, index, wire);
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_set_pixel_rgbw(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    led_color_component_format_t component_fmt = spi_strip->component_fmt;
+    ESP_RETURN_ON_FALSE(index < spi_strip->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    ESP_RETURN_ON_FALSE(component_fmt.format.num_components == 4, ESP_ERR_INVALID_ARG, TAG, "led doesn't have 4 components");
+    ESP_RETURN_ON_FALSE(!spi_strip->palette_bits, ESP_ERR_INVALID_STATE, TAG, "palette strip, set palette indices");
+
+    uint8_t wire[4];
+    wire[component_fmt.format.r_pos] = red & 0xFF;
+    wire[component_fmt.format.g_pos] = green & 0xFF;
+    wire[component_fmt.format.b_pos] = blue & 0xFF;
+    wire[component_fmt.format.w_pos] = white & 0xFF;
+    // LED_PIXEL_FORMAT_GRBW takes 96bits(12bytes)
+    led_strip_spi_store_pixel(spi_strip, index, wire);
+
+    return ESP_OK;
+}
+
+// store count pixels from start, marking the range that changed.
+// Inlined with a constant number of components, so that the compares are a few word moves
+static inline void led_strip_spi_store_pixels(led_strip_spi_obj *spi_strip, uint32_t start, uint32_t count, uint8_t bytes_per_pixel,
+                                              const uint8_t *colors, uint8_t stride, const uint8_t *pos)
+{
+    uint32_t pixel_stride = spi_strip->pixel_stride;
+    uint8_t *pixel_buf = spi_strip->pixel_buf + start * pixel_stride;
+    uint32_t first = UINT32_MAX;
+    uint32_t last = 0;
+    // components in wire order, white stays 0 without a white input
+    uint8_t wire[4] = {0};
+    for (uint32_t i = 0; i < count; i++) {
+        for (uint8_t c = 0; c < stride; c++) {
+            wire[pos[c]] = colors[c];
+        }
+        if (led_strip_spi_update(spi_strip, wire, bytes_per_pixel, pixel_buf)) {
+            if (first == UINT32_MAX) {
+                first = start + i;
+            }
+            last = start + i;
+        }
+        pixel_buf += pixel_stride;
+        colors += stride;
+    }
+    if (first != UINT32_MAX) {
+        led_strip_spi_mark_dirty(spi_strip, first, last);
+    }
+}
+
+static esp_err_t led_strip_spi_set_pixels(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *rgb)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    ESP_RETURN_ON_FALSE(start <= spi_strip->strip_len && count <= spi_strip->strip_len - start, ESP_ERR_INVALID_ARG, TAG,
+                        "pixels out of maximum number of LEDs");
+    ESP_RETURN_ON_FALSE(!spi_strip->palette_bits, ESP_ERR_INVALID_STATE, TAG, "palette strip, set palette indices");
+
+    led_color_component_format_t component_fmt = spi_strip->component_fmt;
+    const uint8_t pos[3] = {component_fmt.format.r_pos, component_fmt.format.g_pos, component_fmt.format.b_pos};
+    if (spi_strip->bytes_per_pixel == 3) {
+        led_strip_spi_store_pixels(spi_strip, start, count, 3, rgb, 3, pos);
+    } else {
+        led_strip_spi_store_pixels(spi_strip, start, count, 4, rgb, 3, pos);
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_set_pixels_rgbw(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *rgbw)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    led_color_component_format_t component_fmt = spi_strip->component_fmt;
+    ESP_RETURN_ON_FALSE(start <= spi_strip->strip_len && count <= spi_strip->strip_len - start, ESP_ERR_INVALID_ARG, TAG,
+                        "pixels out of maximum number of LEDs");
+    ESP_RETURN_ON_FALSE(component_fmt.format.num_components == 4, ESP_ERR_INVALID_ARG, TAG, "led doesn't have 4 components");
+    ESP_RETURN_ON_FALSE(!spi_strip->palette_bits, ESP_ERR_INVALID_STATE, TAG, "palette strip, set palette indices");
+
+    const uint8_t pos[4] = {component_fmt.format.r_pos, component_fmt.format.g_pos, component_fmt.format.b_pos, component_fmt.format.w_pos};
+    led_strip_spi_store_pixels(spi_strip, start, count, 4, rgbw, 4, pos);
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_set_palette(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *colors)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    ESP_RETURN_ON_FALSE(spi_strip->palette_bits, ESP_ERR_INVALID_STATE, TAG, "not a palette strip");
+    uint32_t palette_len = 1 << spi_strip->palette_bits;
+    ESP_RETURN_ON_FALSE(start <= palette_len && count <= palette_len - start, ESP_ERR_INVALID_ARG, TAG, "entries out of the palette");
+    // the streamed pixels are expanded when the refresh returns, the palette is not read until the next one
+    if (led_strip_palette_put_colors(spi_strip->palette, spi_strip->component_fmt, start, count, colors)) {
+        // any pixel may use a changed entry
+        led_strip_spi_mark_dirty(spi_strip, 0, spi_strip->strip_len - 1);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_set_pixels_index(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *indices)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    uint8_t palette_bits = spi_strip->palette_bits;
+    ESP_RETURN_ON_FALSE(palette_bits, ESP_ERR_INVALID_STATE, TAG, "not a palette strip");
+    ESP_RETURN_ON_FALSE(start <= spi_strip->strip_len && count <= spi_strip->strip_len - start, ESP_ERR_INVALID_ARG, TAG,
+                        "pixels out of maximum number of LEDs");
+    uint32_t first = UINT32_MAX;
+    uint32_t last = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        ESP_RETURN_ON_FALSE(indices[i] < (1 << palette_bits), ESP_ERR_INVALID_ARG, TAG, "index out of the palette");
+        if (led_strip_palette_put_index(spi_strip->pixel_buf, palette_bits, start + i, indices[i])) {
+            if (first == UINT32_MAX) {
+                first = start + i;
+            }
+            last = start + i;
+        }
+    }
+    if (first != UINT32_MAX) {
+        led_strip_spi_mark_dirty(spi_strip, first, last);
+    }
+    return ESP_OK;
+}
+
+static void IRAM_ATTR led_strip_spi_trans_done(spi_transaction_t *trans)
+{
+    // only the last transaction of a frame carries the strip
+    led_strip_spi_obj *spi_strip = (led_strip_spi_obj *)trans->user;
+    if (spi_strip && spi_strip->on_refresh_done) {
+        BaseType_t need_yield = spi_strip->on_refresh_done(&spi_strip->base, spi_strip->user_ctx);
+        portYIELD_FROM_ISR(need_yield);
+    }
+}
+
+static esp_err_t led_strip_spi_wait_refresh_done(led_strip_t *strip, int32_t timeout_ms)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    spi_transaction_t *done = NULL;
+    TickType_t ticks = timeout_ms < 0 ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    while (spi_strip->trans_pending) {
+        ESP_RETURN_ON_ERROR(spi_device_get_trans_result(spi_strip->spi_device, &done, ticks), TAG, "wait for SPI transaction failed");
+        spi_strip->trans_pending--;
+    }
+    return ESP_OK;
+}
+
+// expand the next pixels of the frame into a chunk and queue it
+static esp_err_t led_strip_spi_queue_chunk(led_strip_spi_obj *spi_strip, int slot)
+{
+    uint8_t bytes_per_pixel = spi_strip->bytes_per_pixel;
+    uint32_t spi_bytes_per_pixel = bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE;
+    uint32_t count = spi_strip->stream_end - spi_strip->stream_next;
+    if (count > spi_strip->stream_chunk_pixels) {
+        count = spi_strip->stream_chunk_pixels;
+    }
+    uint8_t *chunk = spi_strip->stream_chunks[slot];
+    if (spi_strip->palette_bits) {
+        for (uint32_t i = spi_strip->stream_next; i < spi_strip->stream_next + count; i++) {
+            uint8_t index = led_strip_palette_get_index(spi_strip->pixel_buf, spi_strip->palette_bits, i);
+            led_strip_spi_encode_pixel(spi_strip->palette + index * bytes_per_pixel, bytes_per_pixel, chunk);
+            chunk += spi_bytes_per_pixel;
+        }
+    } else {
+        const uint8_t *pixel = spi_strip->pixel_buf + spi_strip->stream_next * bytes_per_pixel;
+        for (uint32_t i = 0; i < count; i++) {
+            led_strip_spi_encode_pixel(pixel, bytes_per_pixel, chunk);
+            pixel += bytes_per_pixel;
+            chunk += spi_bytes_per_pixel;
+        }
+    }
+    spi_strip->stream_next += count;
+
+    spi_transaction_t *trans = &spi_strip->trans[slot];
+    memset(trans, 0, sizeof(spi_transaction_t));
+    trans->length = count * spi_bytes_per_pixel * 8;
+    trans->tx_buffer = spi_strip->stream_chunks[slot];
+    trans->user = spi_strip->stream_next == spi_strip->stream_end ? spi_strip : NULL;
+    ESP_RETURN_ON_ERROR(spi_device_queue_trans(spi_strip->spi_device, trans, portMAX_DELAY), TAG, "transmit pixels by SPI failed");
+    spi_strip->trans_pending++;
+    return ESP_OK;
+}
+
+// The post_cb runs in the ISR, where spi_device_queue_trans cannot be called, so the chunks are refilled here:
+// one chunk is always queued behind the one on the wire. The driver ISR starts it once the previous one has ended,
+// so the line stays low between chunks for the interrupt latency plus the driver setup, see led_strip_spi.h
+static esp_err_t led_strip_spi_stream(led_strip_spi_obj *spi_strip, uint32_t tx_pixels)
+{
+    spi_strip->stream_next = 0;
+    spi_strip->stream_end = tx_pixels;
+    ESP_RETURN_ON_ERROR(led_strip_spi_queue_chunk(spi_strip, 0), TAG, "queue chunk failed");
+    if (spi_strip->stream_next < spi_strip->stream_end) {
+        ESP_RETURN_ON_ERROR(led_strip_spi_queue_chunk(spi_strip, 1), TAG, "queue chunk failed");
+    }
+    while (spi_strip->stream_next < spi_strip->stream_end) {
+        spi_transaction_t *done = NULL;
+        ESP_RETURN_ON_ERROR(spi_device_get_trans_result(spi_strip->spi_device, &done, portMAX_DELAY), TAG, "wait for SPI transaction failed");
+        spi_strip->trans_pending--;
+        ESP_RETURN_ON_ERROR(led_strip_spi_queue_chunk(spi_strip, done == &spi_strip->trans[0] ? 0 : 1), TAG, "queue chunk failed");
+    }
+    // every pixel is expanded, the last chunks are still on the wire
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_refresh_async(led_strip_t *strip)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    uint32_t pixel_stride = spi_strip->pixel_stride;
+
+    // the transaction and the buffer of the previous frame are reused below
+    ESP_RETURN_ON_ERROR(led_strip_spi_wait_refresh_done(strip, -1), TAG, "flush SPI device failed");
+    uint8_t *tx_buf = spi_strip->pixel_buf;
+    if (spi_strip->front_buf) {
+        // swap, then start the next frame from this one as the pixels are set incrementally.
+        // The other buffer holds the previous frame, it only misses the pixels changed since
+        spi_strip->pixel_buf = spi_strip->front_buf;
+        spi_strip->front_buf = tx_buf;
+        if (spi_strip->dirty_start < spi_strip->dirty_end) {
+            size_t offset = spi_strip->dirty_start * pixel_stride;
+            memcpy(spi_strip->pixel_buf + offset, tx_buf + offset,
+                   (spi_strip->dirty_end - spi_strip->dirty_start) * pixel_stride);
+        }
+    }
+    // LEDs latch the first pixels of a frame and keep their color when the frame stops short,
+    // so the unchanged pixels after the last change are not sent. An unchanged frame still
+    // sends the first pixel, the refresh then completes like any other.
+    uint32_t tx_pixels = spi_strip->dirty_end ? spi_strip->dirty_end : 1;
+    spi_strip->dirty_start = spi_strip->strip_len;
+    spi_strip->dirty_end = 0;
+    if (spi_strip->stream_chunks[0]) {
+        return led_strip_spi_stream(spi_strip, tx_pixels);
+    }
+    memset(&spi_strip->trans[0], 0, sizeof(spi_transaction_t));
+    spi_strip->trans[0].length = tx_pixels * pixel_stride * 8;
+    spi_strip->trans[0].tx_buffer = tx_buf;
+    spi_strip->trans[0].user = spi_strip;
+    ESP_RETURN_ON_ERROR(spi_device_queue_trans(spi_strip->spi_device, &spi_strip->trans[0], portMAX_DELAY),
+                        TAG, "transmit pixels by SPI failed");
+    spi_strip->trans_pending = 1;
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_refresh(led_strip_t *strip)
+{
+    ESP_RETURN_ON_ERROR(led_strip_spi_refresh_async(strip), TAG, "start refresh failed");
+    ESP_RETURN_ON_ERROR(led_strip_spi_wait_refresh_done(strip, -1), TAG, "flush SPI device failed");
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_register_event_callbacks(led_strip_t *strip, const led_strip_event_callbacks_t *cbs, void *user_ctx)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    // the post_cb of the device is always set, it only forwards to these
+    spi_strip->user_ctx = user_ctx;
+    spi_strip->on_refresh_done = cbs->on_refresh_done;
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_clear(led_strip_t *strip)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    if (!spi_strip->front_buf) {
+        // the single buffer may still be on the wire
+        ESP_RETURN_ON_ERROR(led_strip_spi_wait_refresh_done(strip, -1), TAG, "flush SPI device failed");
+    }
+    //Write zero to turn off all leds, the LEDs already off are not sent again
+    const uint8_t off[4] = {0};
+    for (uint32_t index = 0; index < spi_strip->strip_len; index++) {
+        if (!spi_strip->palette_bits) {
+            led_strip_spi_store_pixel(spi_strip, index, off);
+        } else if (led_strip_palette_put_index(spi_strip->pixel_buf, spi_strip->palette_bits, index, 0)) {
+            // palette strips go back to the first entry
+            led_strip_spi_mark_dirty(spi_strip, index, index);
+        }
+    }
+
+    return led_strip_spi_refresh(strip);
+}
+
+static esp_err_t led_strip_spi_del(led_strip_t *strip)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+
+    ESP_RETURN_ON_ERROR(led_strip_spi_wait_refresh_done(strip, -1), TAG, "flush SPI device failed");
+    ESP_RETURN_ON_ERROR(spi_bus_remove_device(spi_strip->spi_device), TAG, "delete spi device failed");
+    ESP_RETURN_ON_ERROR(spi_bus_free(spi_strip->spi_host), TAG, "free spi bus failed");
+
+    free(spi_strip->stream_chunks[0]);
+    free(spi_strip);
+    return ESP_OK;
+}
+
+esp_err_t led_strip_new_spi_device(const led_strip_config_t *led_config, const led_strip_spi_config_t *spi_config, led_strip_handle_t *ret_strip)
+{
+    led_strip_spi_obj *spi_strip = NULL;
+    esp_err_t ret = ESP_OK;
+    ESP_GOTO_ON_FALSE(led_config && spi_config && ret_strip, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
+    led_color_component_format_t component_fmt = led_config->color_component_format;
+    // If R/G/B order is not specified, set default GRB order as fallback
+    if (component_fmt.format_id == 0) {
+        component_fmt = LED_STRIP_COLOR_COMPONENT_FMT_GRB;
+    }
+    // check the validation of the color component format
+    uint8_t mask = 0;
+    if (component_fmt.format.num_components == 3) {
+        mask = BIT(component_fmt.format.r_pos) | BIT(component_fmt.format.g_pos) | BIT(component_fmt.format.b_pos);
+        // Check for invalid values
+        ESP_RETURN_ON_FALSE(mask == 0x07, ESP_ERR_INVALID_ARG, TAG, "invalid order argument");
+    } else if (component_fmt.format.num_components == 4) {
+        mask = BIT(component_fmt.format.r_pos) | BIT(component_fmt.format.g_pos) | BIT(component_fmt.format.b_pos) | BIT(component_fmt.format.w_pos);
+        // Check for invalid values
+        ESP_RETURN_ON_FALSE(mask == 0x0F, ESP_ERR_INVALID_ARG, TAG, "invalid order argument");
+    } else {
+        ESP_RETURN_ON_FALSE(false, ESP_ERR_INVALID_ARG, TAG, "invalid number of color components: %d", component_fmt.format.num_components);
+    }
+    uint8_t palette_bits = led_config->palette_bits;
+    ESP_RETURN_ON_FALSE(palette_bits == 0 || palette_bits == 4 || palette_bits == 8, ESP_ERR_INVALID_ARG, TAG,
+                        "invalid palette bits: %d", palette_bits);
+    // TODO: we assume each color component is 8 bits, may need to support other configurations in the future, e.g. 10bits per color component?
+    uint8_t bytes_per_pixel = component_fmt.format.num_components;
+    uint32_t mem_caps = MALLOC_CAP_DEFAULT;
+    if (spi_config->flags.with_dma) {
+        // DMA buffer must be placed in internal SRAM
+        mem_caps |= MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA;
+    }
+    // palette indices are expanded by the chunk filler, so palette strips are always streamed
+    bool streaming = spi_config->flags.streaming || palette_bits;
+    // streaming keeps the components in RAM of any kind, only the chunks are expanded into SPI bytes
+    uint32_t pixel_stride = streaming ? bytes_per_pixel : bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE;
+    size_t frame_size = palette_bits ? led_strip_palette_frame_size(palette_bits, led_config->max_leds) : led_config->max_leds * pixel_stride;
+    size_t palette_size = palette_bits ? (1 << palette_bits) * bytes_per_pixel : 0;
+    // the pixels are all expanded when a streaming refresh returns, they can be set at once without a second buffer
+    size_t num_buffers = led_config->flags.double_buffer && !streaming ? 2 : 1;
+    size_t transfer_size = frame_size;
+    if (streaming) {
+        spi_strip = calloc(1, sizeof(led_strip_spi_obj) + frame_size + palette_size);
+    } else {
+        spi_strip = heap_caps_calloc(1, sizeof(led_strip_spi_obj) + num_buffers * frame_size, mem_caps);
+    }
+    ESP_GOTO_ON_FALSE(spi_strip, ESP_ERR_NO_MEM, err, TAG, "no mem for spi strip");
+    if (streaming) {
+        uint32_t chunk_pixels = led_config->max_leds < LED_STRIP_SPI_STREAM_CHUNK_PIXELS ? led_config->max_leds : LED_STRIP_SPI_STREAM_CHUNK_PIXELS;
+        transfer_size = chunk_pixels * bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE;
+        spi_strip->stream_chunks[0] = heap_caps_calloc(2, transfer_size, mem_caps);
+        ESP_GOTO_ON_FALSE(spi_strip->stream_chunks[0], ESP_ERR_NO_MEM, err, TAG, "no mem for spi chunks");
+        spi_strip->stream_chunks[1] = spi_strip->stream_chunks[0] + transfer_size;
+        spi_strip->stream_chunk_pixels = chunk_pixels;
+    }
+
+    spi_strip->spi_host = spi_config->spi_bus;
+    // for backward compatibility, if the user does not set the clk_src, use the default value
+    spi_clock_source_t clk_src = SPI_CLK_SRC_DEFAULT;
+    if (spi_config->clk_src) {
+        clk_src = spi_config->clk_src;
+    }
+
+    spi_bus_config_t spi_bus_cfg = {
+        .mosi_io_num = led_config->strip_gpio_num,
+        //Only use MOSI to generate the signal, set -1 when other pins are not used.
+        .miso_io_num = -1,
+        .sclk_io_num = -1,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = transfer_size,
+    };
+    ESP_GOTO_ON_ERROR(spi_bus_initialize(spi_strip->spi_host, &spi_bus_cfg, spi_config->flags.with_dma ? SPI_DMA_CH_AUTO : SPI_DMA_DISABLED), err, TAG, "create SPI bus failed");
+
+    if (led_config->flags.invert_out == true) {
+        esp_rom_gpio_connect_out_signal(led_config->strip_gpio_num, spi_periph_signal[spi_strip->spi_host].spid_out, true, false);
+    }
+
+    spi_device_interface_config_t spi_dev_cfg = {
+        .clock_source = clk_src,
+        .command_bits = 0,
+        .address_bits = 0,
+        .dummy_bits = 0,
+        .clock_speed_hz = LED_STRIP_SPI_DEFAULT_RESOLUTION,
+        .mode = 0,
+        //set -1 when CS is not used
+        .spics_io_num = -1,
+        .queue_size = LED_STRIP_SPI_DEFAULT_TRANS_QUEUE_SIZE,
+        .post_cb = led_strip_spi_trans_done,
+    };
+
+    ESP_GOTO_ON_ERROR(spi_bus_add_device(spi_strip->spi_host, &spi_dev_cfg, &spi_strip->spi_device), err, TAG, "Failed to add spi device");
+    //ensure the reset time is enough
+    esp_rom_delay_us(10);
+    int clock_resolution_khz = 0;
+    spi_device_get_actual_freq(spi_strip->spi_device, &clock_resolution_khz);
+    // TODO: ideally we should decide the SPI_BYTES_PER_COLOR_BYTE by the real clock resolution
+    // But now, let's fixed the resolution, the downside is, we don't support a clock source whose frequency is not multiple of LED_STRIP_SPI_DEFAULT_RESOLUTION
+    // clock_resolution between 2.2MHz to 2.8MHz is supported
+    ESP_GOTO_ON_FALSE((clock_resolution_khz < LED_STRIP_SPI_DEFAULT_RESOLUTION / 1000 + 300) && (clock_resolution_khz > LED_STRIP_SPI_DEFAULT_RESOLUTION / 1000 - 300), ESP_ERR_NOT_SUPPORTED, err,
+                      TAG, "unsupported clock resolution:%dKHz", clock_resolution_khz);
+
+    spi_strip->component_fmt = component_fmt;
+    spi_strip->bytes_per_pixel = bytes_per_pixel;
+    spi_strip->pixel_stride = pixel_stride;
+    spi_strip->strip_len = led_config->max_leds;
+    spi_strip->pixel_buf = spi_strip->pixel_mem;
+    spi_strip->palette_bits = palette_bits;
+    if (palette_bits) {
+        spi_strip->palette = spi_strip->pixel_mem + frame_size;
+    }
+    // start from all LEDs off, sent whole by the first refresh. Streamed pixels are cleared already
+    const uint8_t off[4] = {0};
+    for (uint32_t index = 0; index < spi_strip->strip_len && !streaming; index++) {
+        led_strip_spi_encode_pixel(off, bytes_per_pixel, spi_strip->pixel_buf + index * pixel_stride);
+    }
+    spi_strip->dirty_start = 0;
+    spi_strip->dirty_end = spi_strip->strip_len;
+    if (num_buffers > 1) {
+        spi_strip->front_buf = spi_strip->pixel_mem + frame_size;
+        memcpy(spi_strip->front_buf, spi_strip->pixel_buf, frame_size);
+    }
+    spi_strip->base.set_pixel = led_strip_spi_set_pixel;
+    spi_strip->base.set_pixel_rgbw = led_strip_spi_set_pixel_rgbw;
+    spi_strip->base.set_pixels = led_strip_spi_set_pixels;
+    spi_strip->base.set_pixels_rgbw = led_strip_spi_set_pixels_rgbw;
+    spi_strip->base.refresh = led_strip_spi_refresh;
+    spi_strip->base.refresh_async = led_strip_spi_refresh_async;
+    spi_strip->base.wait_refresh_done = led_strip_spi_wait_refresh_done;
+    spi_strip->base.register_event_callbacks = led_strip_spi_register_event_callbacks;
+    spi_strip->base.set_palette = led_strip_spi_set_palette;
+    spi_strip->base.set_pixels_index = led_strip_spi_set_pixels_index;
+    spi_strip->base.clear = led_strip_spi_clear;
+    spi_strip->base.del = led_strip_spi_del;
+
+    *ret_strip = &spi_strip->base;
+    return ESP_OK;
+err:
+    if (spi_strip) {
+        if (spi_strip->spi_device) {
+            spi_bus_remove_device(spi_strip->spi_device);
+        }
+        if (spi_strip->spi_host) {
+            spi_bus_free(spi_strip->spi_host);
+        }
+        free(spi_strip->stream_chunks[0]);
+        free(spi_strip);
+    }
+    return ret;
+}
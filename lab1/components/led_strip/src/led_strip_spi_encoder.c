@@ -0,0 +1,29 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "esp_attr.h"
+#include "led_strip_spi_encoder.h"
+
+// Bit n of the color byte goes to bit 3n+1 of the 24 bit SPI pattern, every bit 3n+2 is the leading 1
+#define SPI_EXPAND(d) (0x924924 | ((d) & 0x01) << 1 | ((d) & 0x02) << 3 | ((d) & 0x04) << 5 | ((d) & 0x08) << 7 | \
+                       ((d) & 0x10) << 9 | ((d) & 0x20) << 11 | ((d) & 0x40) << 13 | ((d) & 0x80) << 15)
+
+#define SPI_WORD_4(d) SPI_EXPAND(d), SPI_EXPAND(d + 1), SPI_EXPAND(d + 2), SPI_EXPAND(d + 3)
+#define SPI_WORD_16(d) SPI_WORD_4(d), SPI_WORD_4(d + 4), SPI_WORD_4(d + 8), SPI_WORD_4(d + 12)
+#define SPI_WORD_64(d) SPI_WORD_16(d), SPI_WORD_16(d + 16), SPI_WORD_16(d + 32), SPI_WORD_16(d + 48)
+
+#define SPI_BYTES(d) { SPI_EXPAND(d) >> 16, (SPI_EXPAND(d) >> 8) & 0xFF, SPI_EXPAND(d) & 0xFF }
+#define SPI_BYTES_4(d) SPI_BYTES(d), SPI_BYTES(d + 1), SPI_BYTES(d + 2), SPI_BYTES(d + 3)
+#define SPI_BYTES_16(d) SPI_BYTES_4(d), SPI_BYTES_4(d + 4), SPI_BYTES_4(d + 8), SPI_BYTES_4(d + 12)
+#define SPI_BYTES_64(d) SPI_BYTES_16(d), SPI_BYTES_16(d + 16), SPI_BYTES_16(d + 32), SPI_BYTES_16(d + 48)
+
+// In DRAM: the tables are read for every color byte, keep them out of the flash cache
+DRAM_ATTR const uint8_t led_strip_spi_bit_lut[256][SPI_BYTES_PER_COLOR_BYTE] = {
+    SPI_BYTES_64(0), SPI_BYTES_64(64), SPI_BYTES_64(128), SPI_BYTES_64(192),
+};
+
+DRAM_ATTR const uint32_t led_strip_spi_word_lut[256] = {
+    SPI_WORD_64(0), SPI_WORD_64(64), SPI_WORD_64(128), SPI_WORD_64(192),
+};
@@ -0,0 +1,111 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SPI_BYTES_PER_COLOR_BYTE 3
+#define SPI_BITS_PER_COLOR_BYTE (SPI_BYTES_PER_COLOR_BYTE * 8)
+
+/**
+ * @brief Each color bit is sent as 3 SPI bits, 100 for a 0 and 110 for a 1, MSB first
+ *
+ * led_strip_spi_bit_lut[data] are the 3 SPI bytes of the color byte `data`, in wire order.
+ * led_strip_spi_word_lut[data] holds the same 24 bits in the low bits of a word, first wire byte in bits 23..16.
+ */
+extern const uint8_t led_strip_spi_bit_lut[256][SPI_BYTES_PER_COLOR_BYTE];
+extern const uint32_t led_strip_spi_word_lut[256];
+
+/**
+ * @brief Expand a color byte into 3 SPI bytes, the destination does not need to be cleared
+ */
+static inline void led_strip_spi_encode_byte(uint8_t data, uint8_t *buf)
+{
+    const uint8_t *bits = led_strip_spi_bit_lut[data];
+    buf[0] = bits[0];
+    buf[1] = bits[1];
+    buf[2] = bits[2];
+}
+
+// Store a word MSB first, the ESP targets and the host are little endian
+static inline void led_strip_spi_store_be32(uint8_t *buf, uint32_t word)
+{
+    word = __builtin_bswap32(word);
+    memcpy(buf, &word, sizeof(word));
+}
+
+static inline uint32_t led_strip_spi_load_be32(const uint8_t *buf)
+{
+    uint32_t word;
+    memcpy(&word, buf, sizeof(word));
+    return __builtin_bswap32(word);
+}
+
+/**
+ * @brief Expand a whole pixel into SPI bytes with word stores
+ *
+ * @param wire: color components in wire order
+ * @param num_components: 3 or 4, the pixel then takes 9 or 12 SPI bytes
+ * @param buf: destination, does not need to be cleared
+ */
+static inline void led_strip_spi_encode_pixel(const uint8_t *wire, uint8_t num_components, uint8_t *buf)
+{
+    uint32_t w0 = led_strip_spi_word_lut[wire[0]];
+    uint32_t w1 = led_strip_spi_word_lut[wire[1]];
+    uint32_t w2 = led_strip_spi_word_lut[wire[2]];
+    // 3 x 24 bits regrouped in 32 bit words
+    led_strip_spi_store_be32(buf, w0 << 8 | w1 >> 16);
+    led_strip_spi_store_be32(buf + 4, w1 << 16 | w2 >> 8);
+    if (num_components > 3) {
+        led_strip_spi_store_be32(buf + 8, w2 << 24 | led_strip_spi_word_lut[wire[3]]);
+    } else {
+        buf[8] = w2 & 0xFF;
+    }
+}
+
+/**
+ * @brief Like led_strip_spi_encode_pixel, but leave the buffer untouched when it already holds the pixel
+ *
+ * @note The compare is done on the words in registers, before anything is stored
+ *
+ * @return Whether the buffer changed
+ */
+static inline bool led_strip_spi_update_pixel(const uint8_t *wire, uint8_t num_components, uint8_t *buf)
+{
+    uint32_t w0 = led_strip_spi_word_lut[wire[0]];
+    uint32_t w1 = led_strip_spi_word_lut[wire[1]];
+    uint32_t w2 = led_strip_spi_word_lut[wire[2]];
+    uint32_t head0 = w0 << 8 | w1 >> 16;
+    uint32_t head1 = w1 << 16 | w2 >> 8;
+    uint32_t diff = (led_strip_spi_load_be32(buf) ^ head0) | (led_strip_spi_load_be32(buf + 4) ^ head1);
+    if (num_components > 3) {
+        uint32_t tail = w2 << 24 | led_strip_spi_word_lut[wire[3]];
+        diff |= led_strip_spi_load_be32(buf + 8) ^ tail;
+        if (diff) {
+            led_strip_spi_store_be32(buf + 8, tail);
+        }
+    } else {
+        diff |= buf[8] ^ (w2 & 0xFF);
+        if (diff) {
+            buf[8] = w2 & 0xFF;
+        }
+    }
+    if (diff) {
+        led_strip_spi_store_be32(buf, head0);
+        led_strip_spi_store_be32(buf + 4, head1);
+    }
+    return diff != 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
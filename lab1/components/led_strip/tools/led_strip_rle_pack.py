@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+"""Pack raw LED frames into a run-length encoded show for led_strip_refresh_rle_async.
+
+The input is the frames one after the other, each LEDS pixels of R, G, B(, W) bytes.
+The show is written in the byte order of the LEDs given by --order, in the format
+described in include/led_strip_rle.h, and can be embedded with EMBED_FILES or written
+to a data partition, e.g.
+
+    led_strip_rle_pack.py frames.raw show.lrle --leds 300 --order GRB --fps 50
+    parttool.py write_partition --partition-name show --input show.lrle
+"""
+import argparse
+import struct
+import sys
+
+HEADER = struct.Struct('<4sBBHII')
+VERSION = 1
+MAX_RUN = 128
+
+
+def pack_frame(pixels, n):
+    """Runs of one frame, as led_strip_rle_pack_frame encodes them"""
+    count = len(pixels)
+    out = bytearray()
+    i = 0
+    while i < count:
+        run = 1
+        while i + run < count and run < MAX_RUN and pixels[i + run] == pixels[i]:
+            run += 1
+        if run > 1:
+            out.append(0x80 | (run - 1))
+            out += pixels[i]
+        else:
+            # up to the next pair of equal pixels, which starts a repeat run
+            while i + run < count and run < MAX_RUN and not (i + run + 1 < count and pixels[i + run] == pixels[i + run + 1]):
+                run += 1
+            out.append(run - 1)
+            for p in pixels[i:i + run]:
+                out += p
+        i += run
+    return struct.pack('<I', len(out)) + bytes(out)
+
+
+def wire_order(order):
+    """Index in the R, G, B(, W) input of the component sent at each position"""
+    order = order.upper()
+    if sorted(order) not in (sorted('RGB'), sorted('RGBW')):
+        raise argparse.ArgumentTypeError('order must be a permutation of RGB or RGBW, not %s' % order)
+    return ['RGBW'.index(c) for c in order]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('input', type=argparse.FileType('rb'), help='raw frames, - for stdin')
+    parser.add_argument('output', type=argparse.FileType('wb'), help='show')
+    parser.add_argument('--leds', type=int, required=True, help='pixels of a frame, up to 65535')
+    parser.add_argument('--order', type=wire_order, default='GRB', help='byte order of the LEDs, e.g. GRB or GRBW (default GRB)')
+    parser.add_argument('--fps', type=float, default=50, help='frames per second (default 50)')
+    args = parser.parse_args()
+
+    n = len(args.order)
+    if not 0 < args.leds <= 0xFFFF:
+        parser.error('--leds must be 1 to 65535')
+    data = args.input.read()
+    frame_size = args.leds * n
+    if len(data) % frame_size:
+        parser.error('input of %d bytes is not a whole number of frames of %d bytes' % (len(data), frame_size))
+
+    frames = []
+    for start in range(0, len(data), frame_size):
+        frame = data[start:start + frame_size]
+        pixels = [bytes(frame[p + c] for c in args.order) for p in range(0, frame_size, n)]
+        frames.append(pack_frame(pixels, n))
+
+    args.output.write(HEADER.pack(b'LRLE', VERSION, n, args.leds, len(frames), round(1e6 / args.fps)))
+    for frame in frames:
+        args.output.write(frame)
+    packed = HEADER.size + sum(len(f) for f in frames)
+    print('%d frames of %d LEDs: %d bytes, %.1f%% of the raw frames' % (len(frames), args.leds, packed, 100.0 * packed / max(len(data), 1)),
+          file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
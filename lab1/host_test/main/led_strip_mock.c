@@ -0,0 +1,181 @@
+/* Mock led_strip backend, see led_strip_mock.h
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <sys/cdefs.h>
+#include "esp_check.h"
+#include "led_strip_interface.h"
+#include "led_strip_spi_encoder.h"
+#include "led_strip_mock.h"
+
+static const char *TAG = "led_strip_mock";
+
+typedef struct {
+    led_strip_t base;
+    uint32_t strip_len;
+    uint8_t bytes_per_pixel;
+    led_color_component_format_t component_fmt;
+    bool spi_format;
+    led_strip_refresh_done_cb_t on_refresh_done;
+    void *user_ctx;
+    size_t frame_size;
+    uint32_t max_frames;
+    uint32_t frame_count;
+    uint8_t *frames;            // ring of max_frames frames
+    uint8_t pixel_buf[];
+} led_strip_mock_obj;
+
+static void mock_put(led_strip_mock_obj *mock, uint32_t index, const uint8_t *rgbw, bool has_white)
+{
+    led_color_component_format_t fmt = mock->component_fmt;
+    uint8_t *pixel = &mock->pixel_buf[index * mock->bytes_per_pixel];
+    pixel[fmt.format.r_pos] = rgbw[0];
+    pixel[fmt.format.g_pos] = rgbw[1];
+    pixel[fmt.format.b_pos] = rgbw[2];
+    if (fmt.format.num_components > 3) {
+        pixel[fmt.format.w_pos] = has_white ? rgbw[3] : 0;
+    }
+}
+
+static esp_err_t mock_set_pixel(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue)
+{
+    led_strip_mock_obj *mock = __containerof(strip, led_strip_mock_obj, base);
+    ESP_RETURN_ON_FALSE(index < mock->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    mock_put(mock, index, (const uint8_t[]) { red, green, blue }, false);
+    return ESP_OK;
+}
+
+static esp_err_t mock_set_pixel_rgbw(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white)
+{
+    led_strip_mock_obj *mock = __containerof(strip, led_strip_mock_obj, base);
+    ESP_RETURN_ON_FALSE(index < mock->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    ESP_RETURN_ON_FALSE(mock->bytes_per_pixel == 4, ESP_ERR_INVALID_ARG, TAG, "led doesn't have 4 components");
+    mock_put(mock, index, (const uint8_t[]) { red, green, blue, white }, true);
+    return ESP_OK;
+}
+
+static esp_err_t mock_set_pixels(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *rgb)
+{
+    led_strip_mock_obj *mock = __containerof(strip, led_strip_mock_obj, base);
+    ESP_RETURN_ON_FALSE(start <= mock->strip_len && count <= mock->strip_len - start, ESP_ERR_INVALID_ARG, TAG,
+                        "pixels out of maximum number of LEDs");
+    for (uint32_t i = 0; i < count; i++, rgb += 3) {
+        mock_put(mock, start + i, rgb, false);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t mock_set_pixels_rgbw(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *rgbw)
+{
+    led_strip_mock_obj *mock = __containerof(strip, led_strip_mock_obj, base);
+    ESP_RETURN_ON_FALSE(start <= mock->strip_len && count <= mock->strip_len - start, ESP_ERR_INVALID_ARG, TAG,
+                        "pixels out of maximum number of LEDs");
+    ESP_RETURN_ON_FALSE(mock->bytes_per_pixel == 4, ESP_ERR_INVALID_ARG, TAG, "led doesn't have 4 components");
+    for (uint32_t i = 0; i < count; i++, rgbw += 4) {
+        mock_put(mock, start + i, rgbw, true);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t mock_refresh(led_strip_t *strip)
+{
+    led_strip_mock_obj *mock = __containerof(strip, led_strip_mock_obj, base);
+    uint8_t *frame = mock->frames + (mock->frame_count % mock->max_frames) * mock->frame_size;
+    if (mock->spi_format) {
+        for (uint32_t i = 0; i < mock->strip_len; i++) {
+            led_strip_spi_encode_pixel(&mock->pixel_buf[i * mock->bytes_per_pixel], mock->bytes_per_pixel,
+                                       &frame[i * mock->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE]);
+        }
+    } else {
+        memcpy(frame, mock->pixel_buf, mock->frame_size);
+    }
+    mock->frame_count++;
+    if (mock->on_refresh_done) {
+        mock->on_refresh_done(strip, mock->user_ctx);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t mock_wait_refresh_done(led_strip_t *strip, int32_t timeout_ms)
+{
+    // refreshes are done when they return
+    return ESP_OK;
+}
+
+static esp_err_t mock_register_event_callbacks(led_strip_t *strip, const led_strip_event_callbacks_t *cbs, void *user_ctx)
+{
+    led_strip_mock_obj *mock = __containerof(strip, led_strip_mock_obj, base);
+    mock->on_refresh_done = cbs->on_refresh_done;
+    mock->user_ctx = user_ctx;
+    return ESP_OK;
+}
+
+static esp_err_t mock_clear(led_strip_t *strip)
+{
+    led_strip_mock_obj *mock = __containerof(strip, led_strip_mock_obj, base);
+    memset(mock->pixel_buf, 0, mock->strip_len * mock->bytes_per_pixel);
+    return mock_refresh(strip);
+}
+
+static esp_err_t mock_del(led_strip_t *strip)
+{
+    led_strip_mock_obj *mock = __containerof(strip, led_strip_mock_obj, base);
+    free(mock->frames);
+    free(mock);
+    return ESP_OK;
+}
+
+esp_err_t led_strip_new_mock_device(const led_strip_mock_config_t *config, led_strip_handle_t *ret_strip)
+{
+    ESP_RETURN_ON_FALSE(config && config->max_leds && ret_strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    led_color_component_format_t component_fmt = config->color_component_format;
+    if (component_fmt.format_id == 0) {
+        component_fmt = LED_STRIP_COLOR_COMPONENT_FMT_GRB;
+    }
+    uint8_t bytes_per_pixel = component_fmt.format.num_components;
+    ESP_RETURN_ON_FALSE(bytes_per_pixel == 3 || bytes_per_pixel == 4, ESP_ERR_INVALID_ARG, TAG, "invalid number of color components");
+    led_strip_mock_obj *mock = calloc(1, sizeof(led_strip_mock_obj) + config->max_leds * bytes_per_pixel);
+    ESP_RETURN_ON_FALSE(mock, ESP_ERR_NO_MEM, TAG, "no mem for mock strip");
+    mock->strip_len = config->max_leds;
+    mock->bytes_per_pixel = bytes_per_pixel;
+    mock->component_fmt = component_fmt;
+    mock->spi_format = config->spi_format;
+    mock->frame_size = config->max_leds * bytes_per_pixel * (config->spi_format ? SPI_BYTES_PER_COLOR_BYTE : 1);
+    mock->max_frames = config->max_frames ? config->max_frames : 1;
+    mock->frames = malloc(mock->frame_size * mock->max_frames);
+    if (!mock->frames) {
+        free(mock);
+        ESP_RETURN_ON_FALSE(false, ESP_ERR_NO_MEM, TAG, "no mem for mock frames");
+    }
+
+    mock->base.set_pixel = mock_set_pixel;
+    mock->base.set_pixel_rgbw = mock_set_pixel_rgbw;
+    mock->base.set_pixels = mock_set_pixels;
+    mock->base.set_pixels_rgbw = mock_set_pixels_rgbw;
+    mock->base.refresh = mock_refresh;
+    mock->base.refresh_async = mock_refresh;
+    mock->base.wait_refresh_done = mock_wait_refresh_done;
+    mock->base.register_event_callbacks = mock_register_event_callbacks;
+    mock->base.clear = mock_clear;
+    mock->base.del = mock_del;
+    *ret_strip = &mock->base;
+    return ESP_OK;
+}
+
+uint32_t led_strip_mock_frame_count(led_strip_handle_t strip)
+{
+    led_strip_mock_obj *mock = __containerof(strip, led_strip_mock_obj, base);
+    return mock->frame_count;
+}
+
+const uint8_t *led_strip_mock_frame(led_strip_handle_t strip, uint32_t back, size_t *size)
+{
+    led_strip_mock_obj *mock = __containerof(strip, led_strip_mock_obj, base);
+    if (back >= mock->frame_count || back >= mock->max_frames) {
+        return NULL;
+    }
+    if (size) {
+        *size = mock->frame_size;
+    }
+    return mock->frames + ((mock->frame_count - 1 - back) % mock->max_frames) * mock->frame_size;
+}
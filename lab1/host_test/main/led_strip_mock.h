@@ -0,0 +1,38 @@
+/* Mock led_strip backend that records the frames it is refreshed with
+
+   Pixels are kept in the component order of the strip, the bytes the RMT
+   backend hands to its encoder. With spi_format a refresh expands them like
+   the SPI backend, 3 bits per bit, so the frames are what either backend
+   would put on the wire, and the time of a refresh is the time of that
+   encoding. The last frames are kept in a ring; refresh_async behaves like
+   refresh and the done callback runs from it.
+*/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "led_strip.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t max_leds;
+    led_color_component_format_t color_component_format;   // 0 for GRB, like the backends
+    uint32_t max_frames;        // Frames kept, the oldest are dropped first. 0 for 1
+    bool spi_format;            // Record the SPI bit stream rather than the color bytes
+} led_strip_mock_config_t;
+
+esp_err_t led_strip_new_mock_device(const led_strip_mock_config_t *config, led_strip_handle_t *ret_strip);
+
+// Frames refreshed since the strip was created
+uint32_t led_strip_mock_frame_count(led_strip_handle_t strip);
+
+// Frame refreshed `back` frames before the last one, NULL if it is not kept
+const uint8_t *led_strip_mock_frame(led_strip_handle_t strip, uint32_t back, size_t *size);
+
+#ifdef __cplusplus
+}
+#endif
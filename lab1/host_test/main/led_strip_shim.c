@@ -0,0 +1,548 @@
+/* Host shims of the RMT and SPI drivers under the led_strip backends
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <sys/cdefs.h>
+#include "driver/rmt_tx.h"
+#include "driver/spi_master.h"
+#include "led_strip_shim.h"
+
+// Free symbols of the channel memory at each refill, the default of the RMT backend
+#define SHIM_RMT_MEM_SYMBOLS 64
+
+static uint8_t *s_last_tx;
+static size_t s_last_tx_size;
+static uint32_t s_tx_count;
+static int64_t s_wire_time_us;
+
+// SPI transactions in flight, the first one on the wire. Transactions that follow each other
+// without the queue running empty make one frame, like the LEDs see them
+#define SHIM_SPI_MAX_QUEUE 8
+static spi_transaction_t *s_spi_queue[SHIM_SPI_MAX_QUEUE];
+static size_t s_spi_queued;
+static spi_transaction_t *s_spi_done[SHIM_SPI_MAX_QUEUE];  // Completed, for spi_device_get_trans_result()
+static size_t s_spi_done_count;
+static size_t s_spi_queue_size;
+static size_t s_spi_max_transfer_sz;   // Of the last bus initialized
+static uint8_t *s_spi_frame;
+static size_t s_spi_frame_size;
+static transaction_cb_t s_spi_post_cb;
+
+// An RMT channel runs the encoder when its transmission starts, into its own wire buffer
+struct rmt_channel_t {
+    uint32_t resolution_hz;
+    bool enabled;
+    rmt_tx_done_callback_t done_cb;
+    void *done_ctx;
+    rmt_sync_manager_handle_t sync;
+    bool pending;                   // Queued by rmt_transmit()
+    bool started;                   // On the wire, waits for the other channels of a sync manager before
+    size_t num_symbols;
+    uint64_t ticks;                 // Duration of the symbols made by the encoders
+    uint8_t *wire;
+    size_t wire_size;
+    size_t wire_capacity;
+    const void *payload;            // Transmission in flight
+    size_t payload_size;
+    rmt_encoder_handle_t encoder;
+    int64_t start_us;
+    int64_t end_us;
+    led_strip_shim_tx_t last;       // Last completed one
+    struct rmt_channel_t *next;
+};
+
+struct rmt_sync_manager_t {
+    bool armed;                     // The next round starts only when every channel has a transmission
+    size_t num_chans;
+    rmt_channel_handle_t chans[];
+};
+
+struct spi_device_t {
+    size_t max_transfer_sz;
+};
+
+static struct rmt_channel_t *s_rmt_chans;
+static size_t s_symbols_free;       // Channel memory while an encoder runs
+
+static void record_tx(const void *wire, size_t size)
+{
+    s_last_tx = realloc(s_last_tx, size ? size : 1);
+    memcpy(s_last_tx, wire, size);
+    s_last_tx_size = size;
+    s_tx_count++;
+}
+
+// Complete the transaction on the wire
+static void complete_spi_one(void)
+{
+    spi_transaction_t *trans = s_spi_queue[0];
+    s_spi_queued--;
+    memmove(s_spi_queue, s_spi_queue + 1, s_spi_queued * sizeof(spi_transaction_t *));
+    // Bytes read only now, like a DMA would
+    size_t size = trans->length / 8;
+    s_spi_frame = realloc(s_spi_frame, s_spi_frame_size + size + 1);
+    memcpy(s_spi_frame + s_spi_frame_size, trans->tx_buffer, size);
+    s_spi_frame_size += size;
+    s_spi_done[s_spi_done_count++] = trans;
+    if (s_spi_post_cb) {
+        s_spi_post_cb(trans);
+    }
+    if (!s_spi_queued) {
+        // Nothing chained behind it, the LEDs latch the frame
+        record_tx(s_spi_frame, s_spi_frame_size);
+        s_spi_frame_size = 0;
+    }
+}
+
+static void complete_spi(void)
+{
+    while (s_spi_queued) {
+        complete_spi_one();
+    }
+}
+
+// Run the encoder the way the driver does: refill the channel memory until the encoding completes
+static void start_rmt(rmt_channel_handle_t chan, int64_t start_us)
+{
+    chan->wire_size = 0;
+    chan->num_symbols = 0;
+    chan->ticks = 0;
+    rmt_encode_state_t state = 0;
+    do {
+        s_symbols_free = SHIM_RMT_MEM_SYMBOLS;
+        chan->num_symbols += chan->encoder->encode(chan->encoder, chan, chan->payload, chan->payload_size, &state);
+    } while (!(state & RMT_ENCODING_COMPLETE));
+    chan->started = true;
+    chan->start_us = start_us;
+    chan->end_us = start_us + (int64_t)(chan->ticks * 1000000 / chan->resolution_hz);
+}
+
+static void complete_rmt(rmt_channel_handle_t chan)
+{
+    chan->pending = false;
+    chan->started = false;
+    if (chan->end_us > s_wire_time_us) {
+        s_wire_time_us = chan->end_us;
+    }
+    chan->last.data = realloc((uint8_t *)chan->last.data, chan->wire_size ? chan->wire_size : 1);
+    memcpy((uint8_t *)chan->last.data, chan->wire, chan->wire_size);
+    chan->last.size = chan->wire_size;
+    chan->last.start_us = chan->start_us;
+    chan->last.end_us = chan->end_us;
+    record_tx(chan->wire, chan->wire_size);
+    if (chan->done_cb) {
+        rmt_tx_done_event_data_t edata = { .num_symbols = chan->num_symbols };
+        chan->done_cb(chan, &edata, chan->done_ctx);
+    }
+}
+
+void led_strip_shim_complete(void)
+{
+    complete_spi();
+    // Channels on the wire, in the order they end
+    while (1) {
+        rmt_channel_handle_t first = NULL;
+        for (rmt_channel_handle_t chan = s_rmt_chans; chan; chan = chan->next) {
+            if (chan->started && (!first || chan->end_us < first->end_us)) {
+                first = chan;
+            }
+        }
+        if (!first) {
+            return;
+        }
+        complete_rmt(first);
+    }
+}
+
+bool led_strip_shim_tx_pending(void)
+{
+    for (rmt_channel_handle_t chan = s_rmt_chans; chan; chan = chan->next) {
+        if (chan->pending) {
+            return true;
+        }
+    }
+    return s_spi_queued > 0;
+}
+
+const uint8_t *led_strip_shim_last_tx(size_t *size)
+{
+    *size = s_last_tx_size;
+    return s_last_tx;
+}
+
+uint32_t led_strip_shim_tx_count(void)
+{
+    return s_tx_count;
+}
+
+const led_strip_shim_tx_t *led_strip_shim_rmt_last_tx(rmt_channel_handle_t chan)
+{
+    return &chan->last;
+}
+
+int64_t led_strip_shim_wire_time_us(void)
+{
+    return s_wire_time_us;
+}
+
+size_t led_strip_shim_spi_max_transfer_sz(void)
+{
+    return s_spi_max_transfer_sz;
+}
+
+// ---- RMT ----
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t *config, rmt_channel_handle_t *ret_chan)
+{
+    rmt_channel_handle_t chan = calloc(1, sizeof(struct rmt_channel_t));
+    if (!chan) {
+        return ESP_ERR_NO_MEM;
+    }
+    chan->resolution_hz = config->resolution_hz;
+    chan->next = s_rmt_chans;
+    s_rmt_chans = chan;
+    *ret_chan = chan;
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_channel(rmt_channel_handle_t channel)
+{
+    if (channel->enabled || channel->sync) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (rmt_channel_handle_t *link = &s_rmt_chans; *link; link = &(*link)->next) {
+        if (*link == channel) {
+            *link = channel->next;
+            break;
+        }
+    }
+    free(channel->wire);
+    free((uint8_t *)channel->last.data);
+    free(channel);
+    return ESP_OK;
+}
+
+esp_err_t rmt_enable(rmt_channel_handle_t channel)
+{
+    channel->enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t rmt_disable(rmt_channel_handle_t channel)
+{
+    channel->enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t rmt_transmit(rmt_channel_handle_t tx_channel, rmt_encoder_handle_t encoder, const void *payload,
+                       size_t payload_bytes, const rmt_transmit_config_t *config)
+{
+    if (!tx_channel->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // Like the driver queue: the previous one is done before this one starts
+    if (tx_channel->started) {
+        complete_rmt(tx_channel);
+    }
+    if (tx_channel->pending) {
+        // Still waiting for the other channels of its sync manager, the backends never queue two
+        return ESP_ERR_INVALID_STATE;
+    }
+    tx_channel->pending = true;
+    tx_channel->payload = payload;
+    tx_channel->payload_size = payload_bytes;
+    tx_channel->encoder = encoder;
+    rmt_sync_manager_handle_t sync = tx_channel->sync;
+    if (!sync || !sync->armed) {
+        start_rmt(tx_channel, s_wire_time_us);
+        return ESP_OK;
+    }
+    for (size_t i = 0; i < sync->num_chans; i++) {
+        if (!sync->chans[i]->pending) {
+            return ESP_OK;
+        }
+    }
+    // The last channel of the round: all start on the same tick
+    sync->armed = false;
+    for (size_t i = 0; i < sync->num_chans; i++) {
+        start_rmt(sync->chans[i], s_wire_time_us);
+    }
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t tx_channel, int timeout_ms)
+{
+    if (!tx_channel->pending) {
+        return ESP_OK;
+    }
+    if (!tx_channel->started) {
+        // Would wait for the other channels of the sync manager forever
+        return ESP_ERR_TIMEOUT;
+    }
+    complete_rmt(tx_channel);
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_register_event_callbacks(rmt_channel_handle_t tx_channel, const rmt_tx_event_callbacks_t *cbs, void *user_data)
+{
+    tx_channel->done_cb = cbs->on_trans_done;
+    tx_channel->done_ctx = user_data;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_sync_manager(const rmt_sync_manager_config_t *config, rmt_sync_manager_handle_t *ret_synchro)
+{
+    if (!config->array_size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < config->array_size; i++) {
+        rmt_channel_handle_t chan = config->tx_channel_array[i];
+        // Like the driver: enabled channels, not in another manager
+        if (!chan->enabled || chan->sync) {
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+    rmt_sync_manager_handle_t sync = calloc(1, sizeof(struct rmt_sync_manager_t) + config->array_size * sizeof(rmt_channel_handle_t));
+    if (!sync) {
+        return ESP_ERR_NO_MEM;
+    }
+    sync->armed = true;
+    sync->num_chans = config->array_size;
+    for (size_t i = 0; i < config->array_size; i++) {
+        sync->chans[i] = config->tx_channel_array[i];
+        sync->chans[i]->sync = sync;
+    }
+    *ret_synchro = sync;
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_sync_manager(rmt_sync_manager_handle_t synchro)
+{
+    for (size_t i = 0; i < synchro->num_chans; i++) {
+        synchro->chans[i]->sync = NULL;
+    }
+    free(synchro);
+    return ESP_OK;
+}
+
+esp_err_t rmt_sync_reset(rmt_sync_manager_handle_t synchro)
+{
+    synchro->armed = true;
+    return ESP_OK;
+}
+
+static void append_wire(rmt_channel_handle_t chan, uint8_t byte)
+{
+    if (chan->wire_size == chan->wire_capacity) {
+        chan->wire_capacity = chan->wire_capacity ? 2 * chan->wire_capacity : 256;
+        chan->wire = realloc(chan->wire, chan->wire_capacity);
+    }
+    chan->wire[chan->wire_size++] = byte;
+}
+
+// Bytes encoder: one symbol per bit, the bytes are recorded as the wire content
+typedef struct {
+    rmt_encoder_t base;
+    size_t index;           // Next byte or symbol, to resume after a full channel memory
+    uint32_t bit_ticks[2];  // Duration of the symbols of a 0 and a 1 bit
+} shim_encoder_t;
+
+static uint32_t symbol_ticks(rmt_symbol_word_t symbol)
+{
+    return symbol.duration0 + symbol.duration1;
+}
+
+static size_t shim_encode_bytes(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data,
+                                size_t data_size, rmt_encode_state_t *ret_state)
+{
+    shim_encoder_t *bytes_encoder = __containerof(encoder, shim_encoder_t, base);
+    const uint8_t *data = primary_data;
+    size_t symbols = 0;
+    while (bytes_encoder->index < data_size && s_symbols_free >= 8) {
+        uint8_t byte = data[bytes_encoder->index++];
+        append_wire(channel, byte);
+        uint32_t ones = __builtin_popcount(byte);
+        channel->ticks += ones * bytes_encoder->bit_ticks[1] + (8 - ones) * bytes_encoder->bit_ticks[0];
+        s_symbols_free -= 8;
+        symbols += 8;
+    }
+    rmt_encode_state_t state = 0;
+    if (bytes_encoder->index == data_size) {
+        bytes_encoder->index = 0;
+        state |= RMT_ENCODING_COMPLETE;
+    }
+    if (s_symbols_free < 8) {
+        state |= RMT_ENCODING_MEM_FULL;
+    }
+    *ret_state = state;
+    return symbols;
+}
+
+// Copy encoder: symbols taken as they are, they only take channel memory and time
+static size_t shim_encode_copy(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data,
+                               size_t data_size, rmt_encode_state_t *ret_state)
+{
+    shim_encoder_t *copy_encoder = __containerof(encoder, shim_encoder_t, base);
+    const rmt_symbol_word_t *data = primary_data;
+    size_t total = data_size / sizeof(rmt_symbol_word_t);
+    size_t symbols = 0;
+    while (copy_encoder->index < total && s_symbols_free > 0) {
+        channel->ticks += symbol_ticks(data[copy_encoder->index++]);
+        s_symbols_free--;
+        symbols++;
+    }
+    rmt_encode_state_t state = 0;
+    if (copy_encoder->index == total) {
+        copy_encoder->index = 0;
+        state |= RMT_ENCODING_COMPLETE;
+    }
+    if (s_symbols_free == 0) {
+        state |= RMT_ENCODING_MEM_FULL;
+    }
+    *ret_state = state;
+    return symbols;
+}
+
+static esp_err_t shim_encoder_reset(rmt_encoder_t *encoder)
+{
+    __containerof(encoder, shim_encoder_t, base)->index = 0;
+    return ESP_OK;
+}
+
+static esp_err_t shim_encoder_del(rmt_encoder_t *encoder)
+{
+    free(__containerof(encoder, shim_encoder_t, base));
+    return ESP_OK;
+}
+
+static shim_encoder_t *new_shim_encoder(size_t (*encode)(rmt_encoder_t *, rmt_channel_handle_t, const void *, size_t, rmt_encode_state_t *))
+{
+    shim_encoder_t *encoder = calloc(1, sizeof(shim_encoder_t));
+    if (encoder) {
+        encoder->base.encode = encode;
+        encoder->base.reset = shim_encoder_reset;
+        encoder->base.del = shim_encoder_del;
+    }
+    return encoder;
+}
+
+esp_err_t rmt_new_bytes_encoder(const rmt_bytes_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+    shim_encoder_t *encoder = new_shim_encoder(shim_encode_bytes);
+    if (!encoder) {
+        return ESP_ERR_NO_MEM;
+    }
+    encoder->bit_ticks[0] = symbol_ticks(config->bit0);
+    encoder->bit_ticks[1] = symbol_ticks(config->bit1);
+    *ret_encoder = &encoder->base;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+    shim_encoder_t *encoder = new_shim_encoder(shim_encode_copy);
+    if (!encoder) {
+        return ESP_ERR_NO_MEM;
+    }
+    *ret_encoder = &encoder->base;
+    return ESP_OK;
+}
+
+esp_err_t rmt_encoder_reset(rmt_encoder_handle_t encoder)
+{
+    return encoder->reset(encoder);
+}
+
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder)
+{
+    return encoder->del(encoder);
+}
+
+// ---- SPI ----
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config, spi_dma_chan_t dma_chan)
+{
+    s_spi_max_transfer_sz = bus_config->max_transfer_sz;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_free(spi_host_device_t host_id)
+{
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interface_config_t *dev_config,
+                             spi_device_handle_t *handle)
+{
+    if (dev_config->queue_size < 1 || dev_config->queue_size > SHIM_SPI_MAX_QUEUE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // The tests keep several strips on one bus, each device remembers the bus it was added to
+    spi_device_handle_t dev = calloc(1, sizeof(struct spi_device_t));
+    if (!dev) {
+        return ESP_ERR_NO_MEM;
+    }
+    dev->max_transfer_sz = s_spi_max_transfer_sz;
+    *handle = dev;
+    s_spi_post_cb = dev_config->post_cb;
+    s_spi_queue_size = dev_config->queue_size;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle)
+{
+    free(handle);
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_actual_freq(spi_device_handle_t handle, int *freq_khz)
+{
+    // What the backend asks for
+    *freq_khz = 2500;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans_desc, TickType_t ticks_to_wait)
+{
+    // Like the driver: no more than the bus can take at once
+    if (trans_desc->length / 8 > handle->max_transfer_sz) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_spi_queued + s_spi_done_count == s_spi_queue_size) {
+        if (!s_spi_queued) {
+            // Full of results nobody collects, the driver would wait forever
+            return ESP_ERR_TIMEOUT;
+        }
+        // Waits for the one on the wire
+        complete_spi_one();
+    }
+    s_spi_queue[s_spi_queued++] = trans_desc;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans_desc, TickType_t ticks_to_wait)
+{
+    if (!s_spi_done_count) {
+        if (!s_spi_queued) {
+            return ESP_ERR_TIMEOUT;
+        }
+        // Complete the one on the wire as if the wait was long enough
+        complete_spi_one();
+    }
+    *trans_desc = s_spi_done[0];
+    s_spi_done_count--;
+    memmove(s_spi_done, s_spi_done + 1, s_spi_done_count * sizeof(spi_transaction_t *));
+    return ESP_OK;
+}
+
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t *trans_desc)
+{
+    esp_err_t ret = spi_device_queue_trans(handle, trans_desc, portMAX_DELAY);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    complete_spi();
+    // Its result is not left for spi_device_get_trans_result()
+    s_spi_done_count--;
+    return ESP_OK;
+}
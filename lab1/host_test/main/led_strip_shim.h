@@ -0,0 +1,55 @@
+/* Host shims of the RMT and SPI drivers under the led_strip backends
+
+   A transmission stays in flight until the backend waits for it or the
+   test calls led_strip_shim_complete(). SPI transactions queued back to
+   back are chained into one transmission. SPI bytes are read only then, like
+   a DMA would, an RMT encoder runs when its channel starts. The bytes of the
+   last transmission are kept so tests can check what a backend put on the
+   wire.
+
+   RMT channels also keep a wire clock: a transmission lasts as long as its
+   symbols, and waiting for it moves the clock to its end.
+*/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/rmt_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bytes of the last completed transmission, NULL if none yet
+const uint8_t *led_strip_shim_last_tx(size_t *size);
+
+// Number of completed transmissions since the start
+uint32_t led_strip_shim_tx_count(void);
+
+// Complete the transmission in flight, if any, and run its done callback
+void led_strip_shim_complete(void);
+
+// Whether a transmission is in flight
+bool led_strip_shim_tx_pending(void);
+
+// A completed RMT transmission
+typedef struct {
+    const uint8_t *data;    // Bytes put on the wire
+    size_t size;
+    int64_t start_us;       // On the wire clock
+    int64_t end_us;
+} led_strip_shim_tx_t;
+
+// Last completed transmission of an RMT channel, size 0 if none yet
+const led_strip_shim_tx_t *led_strip_shim_rmt_last_tx(rmt_channel_handle_t chan);
+
+// Wire clock: end of the last RMT transmission waited for or completed
+int64_t led_strip_shim_wire_time_us(void);
+
+// Largest SPI transaction, as the backend set up the bus
+size_t led_strip_shim_spi_max_transfer_sz(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,292 @@
+/* Replay harness for the lab1 cases on a virtual clock
+
+   Implements the GPIO, esp_timer and button_events APIs used by the cases.
+   The state below is set by the parent before fork() and only changed in
+   the child running the case.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "driver/gpio.h"
+#include "esp_timer.h"
+#include "button_events.h"
+#include "replay.h"
+
+#define REPLAY_TIMEOUT_S 10     // Wall clock limit of one run, a case stuck in a loop is a failure
+#define REPLAY_POLL_MS 10       // Period at which the parent checks the child
+
+static const replay_trace_t *s_trace;
+static replay_timeline_t *s_led;
+static size_t s_next_edge;
+static int64_t s_now_us;
+static int64_t s_deadline_us;
+static uint8_t s_button_level;
+static uint8_t s_led_level;
+static int s_pipe_fd;
+
+// ---- Traces ----
+
+void replay_trace_init(replay_trace_t *trace)
+{
+    trace->num_edges = 0;
+    trace->end_us = INT64_MAX;
+}
+
+static bool trace_append(replay_trace_t *trace, int64_t time_us, uint8_t level)
+{
+    if (trace->num_edges == REPLAY_MAX_EDGES) {
+        return false;
+    }
+    if (trace->num_edges && time_us < trace->edges[trace->num_edges - 1].time_us) {
+        return false;
+    }
+    trace->edges[trace->num_edges++] = (replay_edge_t) {
+        .time_us = time_us,
+        .level = level,
+    };
+    return true;
+}
+
+bool replay_trace_parse_csv(replay_trace_t *trace, const char *csv)
+{
+    replay_trace_init(trace);
+    const char *line = csv;
+    while (*line) {
+        const char *eol = strchr(line, '\n');
+        size_t len = eol ? (size_t)(eol - line) : strlen(line);
+        char buf[64];
+        if (len >= sizeof(buf)) {
+            return false;
+        }
+        memcpy(buf, line, len);
+        buf[len] = '\0';
+        line += eol ? len + 1 : len;
+
+        char *comment = strchr(buf, '#');
+        if (comment) {
+            *comment = '\0';
+        }
+        char *p = buf;
+        while (*p == ' ' || *p == '\t' || *p == '\r') {
+            p++;
+        }
+        if (*p == '\0') {
+            continue;
+        }
+        char *end;
+        double time_ms = strtod(p, &end);
+        if (end == p || *end != ',') {
+            return false;
+        }
+        int64_t time_us = (int64_t)(time_ms * 1000 + 0.5);
+        p = end + 1;
+        while (*p == ' ') {
+            p++;
+        }
+        if (strncmp(p, "end", 3) == 0) {
+            trace->end_us = time_us;
+        } else if ((*p == '0' || *p == '1') && (p[1] == '\0' || strchr(" \t\r", p[1]))) {
+            if (!trace_append(trace, time_us, *p - '0')) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return trace->num_edges == 0 || trace->end_us >= trace->edges[trace->num_edges - 1].time_us;
+}
+
+bool replay_trace_press(replay_trace_t *trace, int64_t start_ms, int64_t duration_ms, int bounces)
+{
+    int64_t t = start_ms * 1000;
+    bool ok = trace_append(trace, t, 1);
+    for (int i = 0; i < bounces; i++) {
+        ok = ok && trace_append(trace, t + (2 * i + 1) * 1000, 0);
+        ok = ok && trace_append(trace, t + (2 * i + 2) * 1000, 1);
+    }
+    return ok && trace_append(trace, (start_ms + duration_ms) * 1000, 0);
+}
+
+// ---- Child side: shims used by the case ----
+
+// Trace over: hand the timeline to the parent and leave, the case never returns by itself
+static void finish(int status)
+{
+    const char *data = (const char *)s_led->changes;
+    size_t left = s_led->num_changes * sizeof(replay_edge_t);
+    while (left) {
+        ssize_t n = write(s_pipe_fd, data, left);
+        if (n <= 0) {
+            _exit(3);
+        }
+        data += n;
+        left -= n;
+    }
+    _exit(status);
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return s_now_us;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num)
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode)
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_pull_mode(gpio_num_t gpio_num, gpio_pull_mode_t pull)
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    if (gpio_num != REPLAY_LED_GPIO || !!level == s_led_level) {
+        return ESP_OK;
+    }
+    if (s_led->num_changes == REPLAY_MAX_LED_CHANGES) {
+        finish(2);
+    }
+    s_led_level = !!level;
+    s_led->changes[s_led->num_changes++] = (replay_edge_t) {
+        .time_us = s_now_us,
+        .level = s_led_level,
+    };
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+    return gpio_num == REPLAY_BUTTON_GPIO ? s_button_level : s_led_level;
+}
+
+esp_err_t button_events_init(gpio_num_t gpio, gpio_num_t led_gpio)
+{
+    return ESP_OK;
+}
+
+void button_events_set_deadline(int64_t deadline_us)
+{
+    s_deadline_us = deadline_us;
+}
+
+// Next edge or deadline in time order, a deadline first when both fall at the same time
+bool button_events_wait(button_event_t *evt, TickType_t timeout)
+{
+    const replay_edge_t *edge = s_next_edge < s_trace->num_edges ? &s_trace->edges[s_next_edge] : NULL;
+    if (s_deadline_us != BUTTON_NO_DEADLINE && s_deadline_us <= s_trace->end_us &&
+        (!edge || s_deadline_us <= edge->time_us)) {
+        if (s_deadline_us > s_now_us) {
+            s_now_us = s_deadline_us;
+        }
+        s_deadline_us = BUTTON_NO_DEADLINE;
+        *evt = (button_event_t) {
+            .time_us = s_now_us,
+            .type = BUTTON_EVENT_DEADLINE,
+        };
+        return true;
+    }
+    if (!edge) {
+        finish(0);
+    }
+    s_next_edge++;
+    s_now_us = edge->time_us;
+    s_button_level = edge->level;
+    *evt = (button_event_t) {
+        .time_us = s_now_us,
+        .type = BUTTON_EVENT_EDGE,
+        .level = edge->level,
+    };
+    return true;
+}
+
+uint32_t button_events_dropped(void)
+{
+    return 0;
+}
+
+// ---- Parent side ----
+
+static int64_t monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Append what the child has written so far, the pipe being non-blocking
+static void read_changes(int fd, replay_timeline_t *led, size_t *size)
+{
+    char *data = (char *)led->changes;
+    ssize_t n;
+    while (*size < sizeof(led->changes) && (n = read(fd, data + *size, sizeof(led->changes) - *size)) > 0) {
+        *size += n;
+    }
+}
+
+bool replay_run(void (*case_main)(void), const replay_trace_t *trace, replay_timeline_t *led)
+{
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    led->num_changes = 0;
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        s_trace = trace;
+        s_led = led;
+        s_next_edge = 0;
+        s_now_us = 0;
+        s_deadline_us = BUTTON_NO_DEADLINE;
+        s_button_level = 0;
+        s_led_level = 0;
+        s_pipe_fd = fds[1];
+        case_main();
+        // app_main returned: the case gave up
+        finish(1);
+    }
+
+    close(fds[1]);
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    // The timeout is enforced from here: the FreeRTOS port of the linux target runs its tick
+    // on signals and timers, an alarm() in the child could be swallowed or disturb it
+    int64_t deadline_ms = monotonic_ms() + REPLAY_TIMEOUT_S * 1000;
+    size_t size = 0;
+    int status;
+    pid_t done;
+    while ((done = waitpid(pid, &status, WNOHANG)) == 0) {
+        if (monotonic_ms() >= deadline_ms) {
+            kill(pid, SIGKILL);
+            waitpid(pid, &status, 0);
+            close(fds[0]);
+            return false;
+        }
+        // Also drained while it runs, so that the child never blocks on a full pipe
+        struct pollfd pfd = { .fd = fds[0], .events = POLLIN };
+        poll(&pfd, 1, REPLAY_POLL_MS);
+        read_changes(fds[0], led, &size);
+    }
+    read_changes(fds[0], led, &size);
+    close(fds[0]);
+    led->num_changes = size / sizeof(replay_edge_t);
+    return done == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
@@ -0,0 +1,61 @@
+/* Replay harness for the lab1 cases on a virtual clock
+
+   Runs the app_main of A.c, B.c or C_improved.c, built against the GPIO,
+   esp_timer and button_events shims, over a trace of button edges. Time only
+   advances from one edge or deadline to the next, so minutes of button
+   activity replay in microseconds. Every run happens in a forked child, so
+   each case starts from its initial static state, and the LED level changes
+   are streamed back to the caller.
+
+   Traces are CSV, one "time_ms,level" edge per line in time order, '#'
+   starting a comment. An optional "time_ms,end" line sets how long the
+   replay goes on after the last edge.
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define REPLAY_MAX_EDGES 1024
+#define REPLAY_MAX_LED_CHANGES 4096
+#define REPLAY_BUTTON_GPIO 0
+#define REPLAY_LED_GPIO 4
+
+typedef struct {
+    int64_t time_us;
+    uint8_t level;
+} replay_edge_t;
+
+// Button edges fed to the case
+typedef struct {
+    replay_edge_t edges[REPLAY_MAX_EDGES];
+    size_t num_edges;
+    int64_t end_us;             // Deadlines after this time are not served
+} replay_trace_t;
+
+// LED level changes produced by the case
+typedef struct {
+    replay_edge_t changes[REPLAY_MAX_LED_CHANGES];
+    size_t num_changes;
+} replay_timeline_t;
+
+// Empty trace, button released
+void replay_trace_init(replay_trace_t *trace);
+
+// Parse a CSV trace. Returns false on a syntax error, an edge out of order or too many edges
+bool replay_trace_parse_csv(replay_trace_t *trace, const char *csv);
+
+// Append a press at start_ms held for duration_ms. bounces extra edge pairs 1 ms apart on the press
+bool replay_trace_press(replay_trace_t *trace, int64_t start_ms, int64_t duration_ms, int bounces);
+
+// Run case_main over trace and record the LED changes. Returns false if the case crashed or hung
+bool replay_run(void (*case_main)(void), const replay_trace_t *trace, replay_timeline_t *led);
+
+#ifdef __cplusplus
+}
+#endif
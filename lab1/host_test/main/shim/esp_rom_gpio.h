@@ -0,0 +1,10 @@
+/* Host shim of the ROM GPIO matrix functions
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+static inline void esp_rom_gpio_connect_out_signal(uint32_t gpio_num, uint32_t signal_idx, bool out_inv, bool oen_inv)
+{
+}
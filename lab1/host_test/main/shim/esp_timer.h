@@ -0,0 +1,15 @@
+/* Host replay shim of esp_timer: the virtual clock of the replay harness
+*/
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,11 @@
+/* Host shim of the SPI peripheral signal table
+*/
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+    uint32_t spid_out;
+} spi_signal_conn_t;
+
+static const spi_signal_conn_t spi_periph_signal[3] = {};
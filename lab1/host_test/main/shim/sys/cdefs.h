@@ -0,0 +1,10 @@
+/* Host shim adding the newlib __containerof to the C library sys/cdefs.h
+*/
+#pragma once
+
+#include_next <sys/cdefs.h>
+#include <stddef.h>
+
+#ifndef __containerof
+#define __containerof(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
+#endif
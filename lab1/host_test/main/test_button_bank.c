@@ -0,0 +1,116 @@
+/* Tests and scaling benchmark for the struct-of-arrays button bank
+*/
+#include <stdio.h>
+#include <time.h>
+#include "unity.h"
+#include "button_bank.h"
+
+#define MS(ms) ((int64_t)(ms) * 1000)
+
+static button_bank_t s_bank;
+static fsm_t s_ref_fsm[BUTTON_BANK_MAX_CHANNELS];
+static button_case_ctx_t s_ref_ctx[BUTTON_BANK_MAX_CHANNELS];
+
+static uint32_t s_rng = 777;
+
+static uint32_t rng_next(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+// Random button levels: each channel holds its level for a random number of ticks
+typedef struct {
+    uint64_t levels;
+    uint32_t hold[BUTTON_BANK_MAX_CHANNELS];
+} panel_t;
+
+static uint64_t panel_step(panel_t *panel, int channels, uint32_t max_hold)
+{
+    for (int i = 0; i < channels; i++) {
+        if (panel->hold[i] == 0) {
+            panel->levels ^= 1ULL << i;
+            panel->hold[i] = 1 + rng_next() % max_hold;
+        }
+        panel->hold[i]--;
+    }
+    return panel->levels;
+}
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint32_t ns_counter(void)
+{
+    return (uint32_t)now_ns();
+}
+
+TEST_CASE("button bank rejects invalid channel counts", "[button_bank]")
+{
+    button_case_ctx_t config = BUTTON_CASE_CTX_DEFAULT();
+    TEST_ASSERT_FALSE(button_bank_init(&s_bank, BUTTON_CASE_C, &config, 0));
+    TEST_ASSERT_FALSE(button_bank_init(&s_bank, BUTTON_CASE_C, &config, BUTTON_BANK_MAX_CHANNELS + 1));
+    TEST_ASSERT_TRUE(button_bank_init(&s_bank, BUTTON_CASE_C, &config, 3));
+    // Levels of channels past num_channels are ignored
+    TEST_ASSERT_EQUAL(0, button_bank_update(&s_bank, 0xF0, MS(0)));
+    TEST_ASSERT_EQUAL(BUTTON_CASE_NO_DEADLINE, button_bank_next_deadline(&s_bank));
+}
+
+TEST_CASE("button bank channels match independent machines", "[button_bank]")
+{
+    button_case_ctx_t config = BUTTON_CASE_CTX_DEFAULT();
+    for (int which = 0; which < BUTTON_CASE_COUNT; which++) {
+        TEST_ASSERT_TRUE(button_bank_init(&s_bank, which, &config, BUTTON_BANK_MAX_CHANNELS));
+        for (int i = 0; i < BUTTON_BANK_MAX_CHANNELS; i++) {
+            s_ref_ctx[i] = (button_case_ctx_t)BUTTON_CASE_CTX_DEFAULT();
+            TEST_ASSERT_TRUE(button_case_init(&s_ref_fsm[i], which, &s_ref_ctx[i]));
+        }
+        panel_t panel = { 0 };
+        uint64_t prev = 0;
+        // 2 minutes at a 1 ms tick, presses and gaps up to 1.5 s
+        for (int64_t t = 0; t < MS(120000); t += MS(1)) {
+            uint64_t levels = panel_step(&panel, BUTTON_BANK_MAX_CHANNELS, 1500);
+            uint64_t leds = button_bank_update(&s_bank, levels, t);
+            for (int i = 0; i < BUTTON_BANK_MAX_CHANNELS; i++) {
+                button_case_fire_due(&s_ref_fsm[i], t);
+                if (((levels ^ prev) >> i) & 1) {
+                    button_case_edge(&s_ref_fsm[i], (levels >> i) & 1, t);
+                }
+                TEST_ASSERT_EQUAL(s_ref_ctx[i].led, (leds >> i) & 1);
+            }
+            prev = levels;
+        }
+    }
+}
+
+TEST_CASE("button bank cost per channel", "[button_bank][bench]")
+{
+    static const int channel_counts[] = { 1, 8, 64 };
+    button_case_ctx_t config = BUTTON_CASE_CTX_DEFAULT();
+    for (size_t c = 0; c < sizeof(channel_counts) / sizeof(channel_counts[0]); c++) {
+        int channels = channel_counts[c];
+        TEST_ASSERT_TRUE(button_bank_init(&s_bank, BUTTON_CASE_C, &config, channels));
+        s_bank.get_cycles = ns_counter;
+        panel_t panel = { 0 };
+        const int ticks = 10 * 60 * 1000;   // 10 minutes at 1 ms
+        int64_t start = now_ns();
+        for (int t = 0; t < ticks; t++) {
+            button_bank_update(&s_bank, panel_step(&panel, channels, 3000), MS(t));
+        }
+        int64_t elapsed = now_ns() - start;
+        uint64_t steps = 0;
+        uint64_t cycles = 0;
+        for (int i = 0; i < channels; i++) {
+            steps += s_bank.steps[i];
+            cycles += s_bank.cycles[i];
+        }
+        printf("button bank: %2d channels, %.1f ns/tick (random panel included), %lu channel steps, %.1f ns/step\n",
+               channels, (double)elapsed / ticks, (unsigned long)steps, steps ? (double)cycles / steps : 0.0);
+    }
+}
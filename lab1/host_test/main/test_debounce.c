@@ -0,0 +1,186 @@
+/* Tests and benchmark for the bit-parallel debouncer
+*/
+#include <stdio.h>
+#include <time.h>
+#include "unity.h"
+#include "debounce.h"
+
+// Per-input reference model: a plain counter of consecutive differing samples
+typedef struct {
+    uint8_t state[32];
+    uint8_t count[32];
+} scalar_debounce_t;
+
+static uint32_t scalar_update(scalar_debounce_t *ref, uint32_t sample, uint32_t *pressed, uint32_t *released)
+{
+    uint32_t toggled = 0;
+    *pressed = 0;
+    *released = 0;
+    for (int i = 0; i < 32; i++) {
+        uint8_t level = (sample >> i) & 1;
+        if (level == ref->state[i]) {
+            ref->count[i] = 0;
+        } else if (++ref->count[i] == DEBOUNCE_SAMPLES) {
+            ref->count[i] = 0;
+            ref->state[i] = level;
+            toggled |= 1u << i;
+            if (level) {
+                *pressed |= 1u << i;
+            } else {
+                *released |= 1u << i;
+            }
+        }
+    }
+    return toggled;
+}
+
+static uint32_t s_rng = 12345;
+
+static uint32_t rng_next(void)
+{
+    // xorshift32
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+TEST_CASE("debounce accepts a clean press after the sample count", "[debounce]")
+{
+    debounce_t db;
+    debounce_init(&db, 0x1, 0, 0);
+    for (int i = 1; i < DEBOUNCE_SAMPLES; i++) {
+        debounce_edges_t e = debounce_update(&db, 0x1);
+        TEST_ASSERT_EQUAL(0, e.pressed);
+    }
+    debounce_edges_t e = debounce_update(&db, 0x1);
+    TEST_ASSERT_EQUAL(0x1, e.pressed);
+    TEST_ASSERT_EQUAL(0, e.released);
+    TEST_ASSERT_EQUAL(0x1, db.state);
+}
+
+TEST_CASE("debounce filters contact bounce", "[debounce]")
+{
+    // Typical bounce: the contact chatters for a few samples before settling
+    static const uint8_t press[] = { 1, 0, 1, 1, 0, 1, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1 };
+    static const uint8_t release[] = { 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0 };
+    debounce_t db;
+    debounce_init(&db, 0x1, 0, 0);
+    int presses = 0;
+    int releases = 0;
+    int press_at = -1;
+    for (size_t i = 0; i < sizeof(press); i++) {
+        debounce_edges_t e = debounce_update(&db, press[i]);
+        if (e.pressed) {
+            presses++;
+            press_at = i;
+        }
+        releases += e.released != 0;
+    }
+    TEST_ASSERT_EQUAL(1, presses);
+    TEST_ASSERT_EQUAL(0, releases);
+    // Accepted on the fourth sample of the final stable run (starting at index 8)
+    TEST_ASSERT_EQUAL(8 + DEBOUNCE_SAMPLES - 1, press_at);
+    for (size_t i = 0; i < sizeof(release); i++) {
+        debounce_edges_t e = debounce_update(&db, release[i]);
+        presses += e.pressed != 0;
+        releases += e.released != 0;
+    }
+    TEST_ASSERT_EQUAL(1, presses);
+    TEST_ASSERT_EQUAL(1, releases);
+    TEST_ASSERT_EQUAL(0, db.state);
+}
+
+TEST_CASE("debounce ignores short glitches", "[debounce]")
+{
+    debounce_t db;
+    debounce_init(&db, UINT32_MAX, 0, 0);
+    // Glitches shorter than the sample count on every input, with random phases
+    for (int n = 0; n < 10000; n++) {
+        uint32_t glitch = rng_next();
+        for (int i = 0; i < DEBOUNCE_SAMPLES - 1; i++) {
+            debounce_edges_t e = debounce_update(&db, glitch);
+            TEST_ASSERT_EQUAL(0, e.pressed | e.released);
+        }
+        debounce_update(&db, 0);
+    }
+    TEST_ASSERT_EQUAL(0, db.state);
+}
+
+TEST_CASE("debounce handles active low inputs and masks", "[debounce]")
+{
+    debounce_t db;
+    // Pin 0 active high, pin 1 active low idling high, pin 2 not debounced
+    debounce_init(&db, 0x3, 0x2, 0x2);
+    TEST_ASSERT_EQUAL(0, db.state);
+    debounce_edges_t e = { 0 };
+    for (int i = 0; i < DEBOUNCE_SAMPLES; i++) {
+        e = debounce_update(&db, 0x4);
+    }
+    TEST_ASSERT_EQUAL(0x2, e.pressed);
+    TEST_ASSERT_EQUAL(0x2, db.state);
+}
+
+TEST_CASE("debounce matches the per-input reference on random noise", "[debounce]")
+{
+    debounce_t db;
+    scalar_debounce_t ref = { 0 };
+    debounce_init(&db, UINT32_MAX, 0, 0);
+    uint32_t level = 0;
+    for (int n = 0; n < 200000; n++) {
+        // Inputs flip rarely and carry heavy bounce noise around the level
+        level ^= rng_next() & rng_next() & rng_next() & rng_next();
+        uint32_t noise = rng_next() & rng_next();
+        uint32_t sample = level ^ noise;
+        uint32_t pressed;
+        uint32_t released;
+        scalar_update(&ref, sample, &pressed, &released);
+        debounce_edges_t e = debounce_update(&db, sample);
+        TEST_ASSERT_EQUAL_HEX32(pressed, e.pressed);
+        TEST_ASSERT_EQUAL_HEX32(released, e.released);
+    }
+}
+
+TEST_CASE("debounce throughput", "[debounce][bench]")
+{
+    enum { SAMPLES = 4096 };
+    static uint32_t samples[SAMPLES];
+    for (int i = 0; i < SAMPLES; i++) {
+        samples[i] = rng_next() & rng_next();
+    }
+    const int rounds = 5000;
+    debounce_t db;
+    debounce_init(&db, UINT32_MAX, 0, 0);
+    uint32_t sink = 0;
+
+    int64_t start = now_ns();
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < SAMPLES; i++) {
+            debounce_edges_t e = debounce_update(&db, samples[i]);
+            sink ^= e.pressed ^ e.released;
+        }
+    }
+    int64_t fast = now_ns() - start;
+
+    scalar_debounce_t ref = { 0 };
+    start = now_ns();
+    for (int r = 0; r < rounds / 50; r++) {
+        for (int i = 0; i < SAMPLES; i++) {
+            uint32_t pressed;
+            uint32_t released;
+            sink ^= scalar_update(&ref, samples[i], &pressed, &released);
+        }
+    }
+    int64_t slow = (now_ns() - start) * 50;
+
+    double ticks = (double)rounds * SAMPLES;
+    printf("debounce 32 inputs: vertical %.2f ns/tick, per-input loop %.2f ns/tick, %.1fx (sink %08x)\n",
+           fast / ticks, slow / ticks, (double)slow / fast, (unsigned)sink);
+}
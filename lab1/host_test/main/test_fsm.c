@@ -0,0 +1,222 @@
+/* Tests and dispatch benchmark for the table-driven FSM engine
+*/
+#include <stdio.h>
+#include <time.h>
+#include "unity.h"
+#include "fsm.h"
+#include "button_cases.h"
+
+#define MS(ms) ((int64_t)(ms) * 1000)
+
+static int s_led_changes;
+
+static void record_led(void *arg, uint8_t level)
+{
+    (void)arg;
+    (void)level;
+    s_led_changes++;
+}
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Run edges and deadlines in time order up to end_us, like the app main loop does
+static void run_until(fsm_t *fsm, int64_t end_us)
+{
+    button_case_fire_due(fsm, end_us);
+}
+
+static void edge(fsm_t *fsm, uint8_t level, int64_t time_us)
+{
+    button_case_fire_due(fsm, time_us);
+    button_case_edge(fsm, level, time_us);
+}
+
+static bool always_false(fsm_t *fsm, const fsm_event_t *evt)
+{
+    (void)fsm;
+    (void)evt;
+    return false;
+}
+
+TEST_CASE("fsm rejects non contiguous alternatives", "[fsm]")
+{
+    static const fsm_transition_t rows[] = {
+        { 0, 0, NULL, NULL, 1 },
+        { 1, 0, NULL, NULL, 0 },
+        { 0, 0, NULL, NULL, 0 },
+    };
+    fsm_table_t table;
+    TEST_ASSERT_FALSE(fsm_table_init(&table, rows, 3, 2, 1));
+    TEST_ASSERT_TRUE(fsm_table_init(&table, rows, 2, 2, 1));
+}
+
+TEST_CASE("fsm rejects out of range states and events", "[fsm]")
+{
+    static const fsm_transition_t rows[] = {
+        { 0, 1, NULL, NULL, 2 },
+    };
+    fsm_table_t table;
+    TEST_ASSERT_FALSE(fsm_table_init(&table, rows, 1, 2, 2));
+    TEST_ASSERT_FALSE(fsm_table_init(&table, rows, 1, 3, 1));
+    TEST_ASSERT_TRUE(fsm_table_init(&table, rows, 1, 3, 2));
+}
+
+TEST_CASE("fsm evaluates guarded alternatives in order", "[fsm]")
+{
+    static const fsm_transition_t rows[] = {
+        { 0, 0, always_false, NULL, 1 },
+        { 0, 0, NULL,         NULL, 2 },
+    };
+    fsm_table_t table;
+    fsm_t fsm;
+    TEST_ASSERT_TRUE(fsm_table_init(&table, rows, 2, 3, 2));
+    fsm_init(&fsm, &table, 0, NULL);
+
+    fsm_event_t unknown = { .id = 1 };
+    TEST_ASSERT_FALSE(fsm_dispatch(&fsm, &unknown));
+    TEST_ASSERT_EQUAL(0, fsm.state);
+
+    fsm_event_t evt = { .id = 0 };
+    TEST_ASSERT_TRUE(fsm_dispatch(&fsm, &evt));
+    TEST_ASSERT_EQUAL(2, fsm.state);
+}
+
+TEST_CASE("case A toggles on presses and ignores bounces", "[fsm][case_a]")
+{
+    fsm_t fsm;
+    button_case_ctx_t ctx = BUTTON_CASE_CTX_DEFAULT();
+    TEST_ASSERT_TRUE(button_case_init(&fsm, BUTTON_CASE_A, &ctx));
+
+    edge(&fsm, 1, MS(100));
+    TEST_ASSERT_EQUAL(1, ctx.led);
+    // Bounce 5 ms later
+    edge(&fsm, 0, MS(103));
+    edge(&fsm, 1, MS(105));
+    TEST_ASSERT_EQUAL(1, ctx.led);
+    edge(&fsm, 0, MS(200));
+    edge(&fsm, 1, MS(400));
+    TEST_ASSERT_EQUAL(0, ctx.led);
+}
+
+TEST_CASE("case B toggles only on long presses", "[fsm][case_b]")
+{
+    fsm_t fsm;
+    button_case_ctx_t ctx = BUTTON_CASE_CTX_DEFAULT();
+    TEST_ASSERT_TRUE(button_case_init(&fsm, BUTTON_CASE_B, &ctx));
+
+    // Short press
+    edge(&fsm, 1, MS(0));
+    edge(&fsm, 0, MS(300));
+    run_until(&fsm, MS(1000));
+    TEST_ASSERT_EQUAL(0, ctx.led);
+    TEST_ASSERT_EQUAL(BUTTON_CASE_NO_DEADLINE, button_case_next_deadline(&ctx));
+
+    // Long press toggles exactly at the threshold, while still held
+    edge(&fsm, 1, MS(2000));
+    TEST_ASSERT_EQUAL(MS(2500), button_case_next_deadline(&ctx));
+    run_until(&fsm, MS(2499));
+    TEST_ASSERT_EQUAL(0, ctx.led);
+    run_until(&fsm, MS(2500));
+    TEST_ASSERT_EQUAL(1, ctx.led);
+    edge(&fsm, 0, MS(4000));
+    TEST_ASSERT_EQUAL(1, ctx.led);
+}
+
+TEST_CASE("case C blinks for the configured duration", "[fsm][case_c]")
+{
+    fsm_t fsm;
+    button_case_ctx_t ctx = BUTTON_CASE_CTX_DEFAULT();
+    ctx.set_led = record_led;
+    s_led_changes = 0;
+    TEST_ASSERT_TRUE(button_case_init(&fsm, BUTTON_CASE_C, &ctx));
+
+    edge(&fsm, 1, MS(0));
+    run_until(&fsm, MS(500));
+    TEST_ASSERT_EQUAL(1, ctx.led);
+    edge(&fsm, 0, MS(700));
+    run_until(&fsm, MS(10499));
+    TEST_ASSERT_TRUE(button_case_next_deadline(&ctx) != BUTTON_CASE_NO_DEADLINE);
+    run_until(&fsm, MS(10500));
+    TEST_ASSERT_EQUAL(0, ctx.led);
+    TEST_ASSERT_EQUAL(BUTTON_CASE_NO_DEADLINE, button_case_next_deadline(&ctx));
+    // On at 500 ms, one toggle every 100 ms up to 10.4 s, off at 10.5 s
+    TEST_ASSERT_EQUAL(1 + 99 + 1, s_led_changes);
+}
+
+TEST_CASE("case C second long press cancels blinking", "[fsm][case_c]")
+{
+    fsm_t fsm;
+    button_case_ctx_t ctx = BUTTON_CASE_CTX_DEFAULT();
+    TEST_ASSERT_TRUE(button_case_init(&fsm, BUTTON_CASE_C, &ctx));
+
+    edge(&fsm, 1, MS(0));
+    edge(&fsm, 0, MS(600));
+    // Short press during blinking keeps it going
+    edge(&fsm, 1, MS(1000));
+    edge(&fsm, 0, MS(1200));
+    run_until(&fsm, MS(3000));
+    TEST_ASSERT_TRUE(button_case_next_deadline(&ctx) != BUTTON_CASE_NO_DEADLINE);
+    // Long press cancels and the LED stays off until released
+    edge(&fsm, 1, MS(3000));
+    run_until(&fsm, MS(3500));
+    TEST_ASSERT_EQUAL(0, ctx.led);
+    TEST_ASSERT_EQUAL(BUTTON_CASE_NO_DEADLINE, button_case_next_deadline(&ctx));
+    edge(&fsm, 0, MS(4000));
+    run_until(&fsm, MS(20000));
+    TEST_ASSERT_EQUAL(0, ctx.led);
+}
+
+static int s_hw_blinks;
+
+static void record_hw_blink(void *arg, uint32_t period_ms, uint32_t duration_ms)
+{
+    (void)arg;
+    TEST_ASSERT_EQUAL(200, period_ms);
+    TEST_ASSERT_EQUAL(10000, duration_ms);
+    s_hw_blinks++;
+}
+
+TEST_CASE("case C with hardware blink only times the blink end", "[fsm][case_c]")
+{
+    fsm_t fsm;
+    button_case_ctx_t ctx = BUTTON_CASE_CTX_DEFAULT();
+    ctx.set_led = record_led;
+    ctx.start_blink = record_hw_blink;
+    s_led_changes = 0;
+    s_hw_blinks = 0;
+    TEST_ASSERT_TRUE(button_case_init(&fsm, BUTTON_CASE_C, &ctx));
+
+    edge(&fsm, 1, MS(0));
+    edge(&fsm, 0, MS(600));
+    TEST_ASSERT_EQUAL(1, s_hw_blinks);
+    TEST_ASSERT_EQUAL(0, s_led_changes);
+    // The only deadline left is the end of the blink
+    TEST_ASSERT_EQUAL(MS(10500), button_case_next_deadline(&ctx));
+    run_until(&fsm, MS(10500));
+    TEST_ASSERT_EQUAL(1, s_led_changes);
+    TEST_ASSERT_EQUAL(0, ctx.led);
+}
+
+TEST_CASE("fsm dispatch throughput", "[fsm][bench]")
+{
+    const int iterations = 10 * 1000 * 1000;
+    fsm_t fsm;
+    button_case_ctx_t ctx = BUTTON_CASE_CTX_DEFAULT();
+    TEST_ASSERT_TRUE(button_case_init(&fsm, BUTTON_CASE_C, &ctx));
+
+    // Short presses: IDLE <-> BUTTON_PRESSED, each one arming and disarming a deadline
+    int64_t start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        button_case_edge(&fsm, !(i & 1), i);
+    }
+    int64_t elapsed = now_ns() - start;
+    TEST_ASSERT_EQUAL(0, fsm.state);
+
+    printf("fsm dispatch: %d events in %.1f ms, %.1f Mevents/s, %.2f ns/event\n",
+           iterations, elapsed / 1e6, iterations * 1e3 / elapsed, (double)elapsed / iterations);
+}
@@ -0,0 +1,120 @@
+/* Replay tests for the gesture recognizer
+
+   Each timeline is a recorded list of "time_ms:level" button edges. It is
+   replayed through the recognizer and the gestures it produced are compared
+   with the expected transcript.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "gesture.h"
+
+typedef struct {
+    char text[256];
+    size_t len;
+} transcript_t;
+
+static void record_gesture(const gesture_event_t *evt, void *arg)
+{
+    static const char *const names[GESTURE_TYPE_COUNT] = {
+        [GESTURE_PRESS] = "P",
+        [GESTURE_RELEASE] = "R",
+        [GESTURE_CLICK] = "C",
+        [GESTURE_LONG_PRESS] = "L",
+        [GESTURE_HOLD_REPEAT] = "H",
+        [GESTURE_LONG_RELEASE] = "U",
+    };
+    transcript_t *t = (transcript_t *)arg;
+    t->len += snprintf(t->text + t->len, sizeof(t->text) - t->len, "%s%s%u@%lld",
+                       t->len ? " " : "", names[evt->type], evt->count, (long long)(evt->time_us / 1000));
+}
+
+// Replay "t:level t:level ..." and run the clock until end_ms
+static void replay(gesture_t *g, const char *timeline, int64_t end_ms)
+{
+    const char *p = timeline;
+    char *next;
+    while (*p) {
+        long t = strtol(p, &next, 10);
+        TEST_ASSERT_TRUE(*next == ':');
+        long level = strtol(next + 1, &next, 10);
+        gesture_edge(g, level, (int64_t)t * 1000);
+        p = next;
+        while (*p == ' ') {
+            p++;
+        }
+    }
+    gesture_poll(g, end_ms * 1000);
+}
+
+static void check_timeline(const gesture_config_t *config, const char *timeline, const char *expected)
+{
+    gesture_t g;
+    transcript_t t = { 0 };
+    gesture_init(&g, config);
+    TEST_ASSERT_TRUE(gesture_subscribe(&g, GESTURE_MASK_ALL & ~(GESTURE_MASK(GESTURE_PRESS) | GESTURE_MASK(GESTURE_RELEASE)),
+                                       record_gesture, &t));
+    replay(&g, timeline, 5000);
+    if (strcmp(expected, t.text) != 0) {
+        printf("timeline: %s\nexpected: %s\ngot:      %s\n", timeline, expected, t.text);
+    }
+    TEST_ASSERT_EQUAL_STRING(expected, t.text);
+    TEST_ASSERT_EQUAL(GESTURE_NO_DEADLINE, gesture_next_deadline(&g));
+}
+
+TEST_CASE("gesture single, double and triple click", "[gesture]")
+{
+    gesture_config_t config = GESTURE_CONFIG_DEFAULT();
+    check_timeline(&config, "0:1 80:0", "C1@330");
+    check_timeline(&config, "0:1 80:0 200:1 280:0", "C2@530");
+    check_timeline(&config, "0:1 80:0 200:1 280:0 400:1 480:0", "C3@730");
+    // Gap longer than multi_click_gap_ms splits the sequence
+    check_timeline(&config, "0:1 80:0 400:1 480:0", "C1@330 C1@730");
+}
+
+TEST_CASE("gesture ignores contact bounce", "[gesture]")
+{
+    gesture_config_t config = GESTURE_CONFIG_DEFAULT();
+    check_timeline(&config, "0:1 2:0 5:1 90:0 93:1 95:0 200:1 203:0 204:1 260:0 400:1 480:0", "C3@730");
+    // A tap shorter than the debounce time is released once the level settles
+    check_timeline(&config, "0:1 10:0", "C1@270");
+}
+
+TEST_CASE("gesture long press, hold repeat and release", "[gesture]")
+{
+    gesture_config_t config = GESTURE_CONFIG_DEFAULT();
+    check_timeline(&config, "0:1 1000:0", "L1@500 H1@700 H2@900 U1@1000");
+    // Click then hold
+    check_timeline(&config, "0:1 100:0 200:1 900:0", "L2@700 U2@900");
+
+    config.repeat_interval_ms = 0;
+    check_timeline(&config, "0:1 1000:0", "L1@500 U1@1000");
+}
+
+TEST_CASE("gesture reports max_clicks without waiting", "[gesture]")
+{
+    gesture_config_t config = GESTURE_CONFIG_DEFAULT();
+    config.max_clicks = 2;
+    check_timeline(&config, "0:1 80:0 200:1 280:0", "C2@280");
+    check_timeline(&config, "0:1 80:0", "C1@330");
+}
+
+TEST_CASE("gesture delivers only subscribed types", "[gesture]")
+{
+    gesture_config_t config = GESTURE_CONFIG_DEFAULT();
+    gesture_t g;
+    transcript_t clicks = { 0 };
+    transcript_t raw = { 0 };
+    gesture_init(&g, &config);
+    TEST_ASSERT_TRUE(gesture_subscribe(&g, GESTURE_MASK(GESTURE_CLICK), record_gesture, &clicks));
+    TEST_ASSERT_TRUE(gesture_subscribe(&g, GESTURE_MASK(GESTURE_PRESS) | GESTURE_MASK(GESTURE_RELEASE), record_gesture, &raw));
+    replay(&g, "0:1 80:0 1000:1 1700:0", 5000);
+    TEST_ASSERT_EQUAL_STRING("C1@330", clicks.text);
+    TEST_ASSERT_EQUAL_STRING("P0@0 R0@80 P0@1000 R0@1700", raw.text);
+
+    for (int i = 2; i < GESTURE_MAX_SUBSCRIBERS; i++) {
+        TEST_ASSERT_TRUE(gesture_subscribe(&g, GESTURE_MASK_ALL, record_gesture, &raw));
+    }
+    TEST_ASSERT_FALSE(gesture_subscribe(&g, GESTURE_MASK_ALL, record_gesture, &raw));
+}
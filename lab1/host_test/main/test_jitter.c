@@ -0,0 +1,48 @@
+/* Tests for the period jitter statistics and the drift-free blink schedule
+*/
+#include "unity.h"
+#include "jitter.h"
+#include "button_cases.h"
+
+#define MS(ms) ((int64_t)(ms) * 1000)
+
+TEST_CASE("jitter reports interval errors and drift", "[jitter]")
+{
+    jitter_t j;
+    jitter_start(&j, MS(100), MS(0));
+    TEST_ASSERT_EQUAL(0, jitter_mean_abs_err_us(&j));
+
+    jitter_add(&j, MS(100) + 300);      // 300 us late
+    jitter_add(&j, MS(200) - 200);      // 500 us short
+    jitter_add(&j, MS(300));            // 200 us long
+    TEST_ASSERT_EQUAL(3, j.count);
+    TEST_ASSERT_EQUAL(-500, j.min_err_us);
+    TEST_ASSERT_EQUAL(300, j.max_err_us);
+    TEST_ASSERT_EQUAL(1000 / 3, jitter_mean_abs_err_us(&j));
+    TEST_ASSERT_EQUAL(0, jitter_drift_us(&j));
+
+    // Re-arming from the wake-up time accumulates the latency
+    jitter_start(&j, MS(100), MS(0));
+    for (int i = 1; i <= 10; i++) {
+        jitter_add(&j, j.last_us + MS(100) + 50);
+    }
+    TEST_ASSERT_EQUAL(50, j.min_err_us);
+    TEST_ASSERT_EQUAL(500, jitter_drift_us(&j));
+}
+
+TEST_CASE("case C blink schedule does not drift with late wake-ups", "[jitter][case_c]")
+{
+    fsm_t fsm;
+    button_case_ctx_t ctx = BUTTON_CASE_CTX_DEFAULT();
+    TEST_ASSERT_TRUE(button_case_init(&fsm, BUTTON_CASE_C, &ctx));
+
+    button_case_edge(&fsm, 1, MS(0));
+    button_case_fire_due(&fsm, MS(500));
+    button_case_edge(&fsm, 0, MS(600));
+    // Every deadline is served 3 ms late, the toggles stay on the 100 ms grid
+    for (int i = 1; i <= 50; i++) {
+        int64_t deadline = button_case_next_deadline(&ctx);
+        TEST_ASSERT_EQUAL(MS(500) + i * MS(100), deadline);
+        button_case_fire_due(&fsm, deadline + MS(3));
+    }
+}
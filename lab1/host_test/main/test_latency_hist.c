@@ -0,0 +1,44 @@
+/* Tests for the log-scale latency histogram
+*/
+#include "unity.h"
+#include "latency_hist.h"
+
+TEST_CASE("latency histogram buckets are contiguous and within 25%", "[latency_hist]")
+{
+    for (int b = 0; b < LATENCY_HIST_NUM_BUCKETS; b++) {
+        uint32_t lower = latency_hist_bucket_lower(b);
+        TEST_ASSERT_EQUAL(b, latency_hist_bucket(lower));
+        if (b + 1 < LATENCY_HIST_NUM_BUCKETS) {
+            uint32_t next = latency_hist_bucket_lower(b + 1);
+            TEST_ASSERT_TRUE(next > lower);
+            TEST_ASSERT_EQUAL(b, latency_hist_bucket(next - 1));
+            // Width at most a quarter of the lower bound, past the exact small buckets
+            TEST_ASSERT_TRUE(lower < LATENCY_HIST_SUB_BUCKETS || (next - lower) * 4 <= lower);
+        }
+    }
+    TEST_ASSERT_EQUAL(LATENCY_HIST_NUM_BUCKETS - 1, latency_hist_bucket(UINT32_MAX));
+}
+
+TEST_CASE("latency histogram percentiles", "[latency_hist]")
+{
+    latency_hist_t hist;
+    latency_hist_reset(&hist);
+    TEST_ASSERT_EQUAL(0, latency_hist_percentile(&hist, 50));
+
+    // 98 fast values around 1000, two slow ones
+    for (int i = 0; i < 98; i++) {
+        latency_hist_record(&hist, 950 + i);
+    }
+    latency_hist_record(&hist, 40000);
+    latency_hist_record(&hist, 100000);
+    TEST_ASSERT_EQUAL(100, hist.count);
+    TEST_ASSERT_EQUAL(950, hist.min);
+    TEST_ASSERT_EQUAL(100000, hist.max);
+
+    uint32_t p50 = latency_hist_percentile(&hist, 50);
+    TEST_ASSERT_TRUE(p50 >= 950 + 49 && p50 <= (950 + 49) * 5 / 4);
+    uint32_t p99 = latency_hist_percentile(&hist, 99);
+    TEST_ASSERT_TRUE(p99 >= 40000 && p99 <= 40000 * 5 / 4);
+    TEST_ASSERT_EQUAL(100000, latency_hist_percentile(&hist, 100));
+    TEST_ASSERT_TRUE(latency_hist_percentile(&hist, 0) >= 950);
+}
@@ -0,0 +1,172 @@
+/* Tests and micro-benchmark of the layered LED strip animations
+*/
+#include <stdio.h>
+#include <time.h>
+#include "unity.h"
+#include "led_anim.h"
+
+#define MS(ms) ((int64_t)(ms) * 1000)
+
+static void check_pixel(const uint8_t *rgb, uint32_t index, uint8_t r, uint8_t g, uint8_t b)
+{
+    const uint8_t expected[3] = { r, g, b };
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, &rgb[index * 3], 3);
+}
+
+TEST_CASE("led_anim solid layers and blend modes", "[led_anim]")
+{
+    led_anim_t anim;
+    uint8_t rgb[10 * 3];
+    led_anim_init(&anim, 10);
+    led_anim_render(&anim, 0, rgb);
+    check_pixel(rgb, 0, 0, 0, 0);
+
+    // Half opacity over black, on pixels 2 to 4 only
+    led_anim_layer_t layer = { .effect = LED_ANIM_SOLID, .color = { 200, 100, 0 }, .opacity = 128, .start = 2, .count = 3 };
+    TEST_ASSERT_EQUAL(0, led_anim_add_layer(&anim, &layer));
+    led_anim_render(&anim, 0, rgb);
+    check_pixel(rgb, 1, 0, 0, 0);
+    check_pixel(rgb, 2, 100, 50, 0);
+    check_pixel(rgb, 4, 100, 50, 0);
+    check_pixel(rgb, 5, 0, 0, 0);
+
+    // One pixel per mode over a grey background
+    led_anim_init(&anim, 5);
+    layer = (led_anim_layer_t) { .effect = LED_ANIM_SOLID, .color = { 100, 100, 100 }, .opacity = 255 };
+    led_anim_add_layer(&anim, &layer);
+    const led_anim_blend_t modes[] = { LED_ANIM_BLEND_NORMAL, LED_ANIM_BLEND_ADD, LED_ANIM_BLEND_MULTIPLY, LED_ANIM_BLEND_MAX };
+    for (int m = 0; m < 4; m++) {
+        layer = (led_anim_layer_t) {
+            .effect = LED_ANIM_SOLID, .blend = modes[m], .color = { 200, 0, 51 }, .opacity = 255, .start = m, .count = 1,
+        };
+        TEST_ASSERT_EQUAL(m + 1, led_anim_add_layer(&anim, &layer));
+    }
+    led_anim_render(&anim, 0, rgb);
+    check_pixel(rgb, 0, 200, 0, 51);
+    check_pixel(rgb, 1, 255, 100, 151);
+    check_pixel(rgb, 2, 78, 0, 20);
+    check_pixel(rgb, 3, 200, 100, 100);
+    check_pixel(rgb, 4, 100, 100, 100);
+
+    // Half a multiply: the color halfway to white
+    anim.layers[3].opacity = 128;
+    led_anim_render(&anim, 0, rgb);
+    check_pixel(rgb, 2, 89, 50, 60);
+}
+
+TEST_CASE("led_anim chase, fade and sparkle follow the time", "[led_anim]")
+{
+    led_anim_t anim;
+    uint8_t rgb[10 * 3];
+    led_anim_init(&anim, 10);
+    led_anim_layer_t chase = { .effect = LED_ANIM_CHASE, .color = { 255, 255, 255 }, .opacity = 255, .period_ms = 1000, .size = 3 };
+    led_anim_add_layer(&anim, &chase);
+    led_anim_render(&anim, 0, rgb);
+    // Head on pixel 0, the tail wraps to the end
+    check_pixel(rgb, 0, 255, 255, 255);
+    check_pixel(rgb, 9, 170, 170, 170);
+    check_pixel(rgb, 8, 85, 85, 85);
+    check_pixel(rgb, 7, 0, 0, 0);
+    led_anim_render(&anim, MS(250), rgb);
+    check_pixel(rgb, 2, 255, 255, 255);
+    check_pixel(rgb, 0, 85, 85, 85);
+    check_pixel(rgb, 3, 0, 0, 0);
+    // Same frame one period later
+    led_anim_render(&anim, MS(1250), rgb);
+    check_pixel(rgb, 2, 255, 255, 255);
+
+    led_anim_init(&anim, 10);
+    led_anim_layer_t fade = { .effect = LED_ANIM_FADE, .color = { 255, 0, 0 }, .opacity = 255, .period_ms = 1000 };
+    led_anim_add_layer(&anim, &fade);
+    const int64_t times[] = { 0, MS(250), MS(500), MS(750), MS(1000) };
+    const uint8_t levels[] = { 0, 128, 255, 128, 0 };
+    for (int i = 0; i < 5; i++) {
+        led_anim_render(&anim, times[i], rgb);
+        check_pixel(rgb, 6, levels[i], 0, 0);
+    }
+
+    // A quarter of the pixels spark once per period, the same ones for the same time
+    static led_anim_t sparkle_anim;
+    static uint8_t frame[1000 * 3];
+    static uint8_t again[1000 * 3];
+    static bool lit[1000];
+    led_anim_init(&sparkle_anim, 1000);
+    led_anim_layer_t sparkle = { .effect = LED_ANIM_SPARKLE, .color = { 0, 0, 255 }, .opacity = 255, .period_ms = 100, .size = 64 };
+    led_anim_add_layer(&sparkle_anim, &sparkle);
+    for (int64_t t = MS(200); t < MS(300); t += 500) {
+        led_anim_render(&sparkle_anim, t, frame);
+        for (int i = 0; i < 1000; i++) {
+            lit[i] |= frame[i * 3 + 2] != 0;
+        }
+    }
+    int count = 0;
+    for (int i = 0; i < 1000; i++) {
+        count += lit[i];
+    }
+    TEST_ASSERT_TRUE(count > 200 && count < 300);
+    led_anim_render(&sparkle_anim, MS(230), frame);
+    led_anim_render(&sparkle_anim, MS(230), again);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame, again, sizeof(frame));
+    // Every spark is out by the end of its period
+    led_anim_render(&sparkle_anim, MS(300) - 1, frame);
+    for (int i = 0; i < 1000; i++) {
+        TEST_ASSERT_EQUAL(0, frame[i * 3 + 2]);
+    }
+}
+
+TEST_CASE("led_anim rejects invalid layers", "[led_anim]")
+{
+    led_anim_t anim;
+    led_anim_init(&anim, 10);
+    led_anim_layer_t layer = { .effect = LED_ANIM_CHASE, .opacity = 255 };
+    TEST_ASSERT_EQUAL(-1, led_anim_add_layer(&anim, &layer));
+    layer = (led_anim_layer_t) { .effect = LED_ANIM_SOLID, .start = 10 };
+    TEST_ASSERT_EQUAL(-1, led_anim_add_layer(&anim, &layer));
+    layer.start = 0;
+    for (int i = 0; i < LED_ANIM_MAX_LAYERS; i++) {
+        TEST_ASSERT_EQUAL(i, led_anim_add_layer(&anim, &layer));
+    }
+    TEST_ASSERT_EQUAL(-1, led_anim_add_layer(&anim, &layer));
+}
+
+TEST_CASE("led_anim stats", "[led_anim]")
+{
+    led_anim_stats_t stats;
+    led_anim_stats_reset(&stats);
+    TEST_ASSERT_EQUAL(0, led_anim_stats_render_us_mean(&stats));
+    TEST_ASSERT_EQUAL(0, led_anim_stats_wire_us_mean(&stats));
+    led_anim_stats_add_frame(&stats, 100, 0);
+    led_anim_stats_add_frame(&stats, 300, 2);
+    led_anim_stats_add_wire(&stats, 1800);
+    TEST_ASSERT_EQUAL(2, stats.frames);
+    TEST_ASSERT_EQUAL(2, stats.dropped);
+    TEST_ASSERT_EQUAL(200, led_anim_stats_render_us_mean(&stats));
+    TEST_ASSERT_EQUAL(300, stats.render_us_max);
+    TEST_ASSERT_EQUAL(1800, led_anim_stats_wire_us_mean(&stats));
+    TEST_ASSERT_EQUAL(1800, stats.wire_us_max);
+}
+
+TEST_CASE("led_anim render time of 1000 LEDs and 4 layers", "[led_anim][bench]")
+{
+    static led_anim_t anim;
+    static uint8_t rgb[1000 * 3];
+    led_anim_init(&anim, 1000);
+    const led_anim_layer_t layers[] = {
+        { .effect = LED_ANIM_SOLID, .color = { 0, 0, 24 }, .opacity = 255 },
+        { .effect = LED_ANIM_FADE, .blend = LED_ANIM_BLEND_ADD, .color = { 48, 0, 48 }, .opacity = 255, .period_ms = 4000 },
+        { .effect = LED_ANIM_CHASE, .color = { 255, 96, 0 }, .opacity = 255, .period_ms = 3000, .size = 8 },
+        { .effect = LED_ANIM_SPARKLE, .blend = LED_ANIM_BLEND_MAX, .color = { 255, 255, 255 }, .opacity = 192, .period_ms = 600, .size = 8 },
+    };
+    for (int i = 0; i < 4; i++) {
+        led_anim_add_layer(&anim, &layers[i]);
+    }
+    const int frames = 2000;
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int f = 0; f < frames; f++) {
+        led_anim_render(&anim, f * MS(1000) / 60, rgb);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double ns = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / frames;
+    printf("led_anim render of 1000 LEDs, 4 layers: %.1f us per frame, %.1f ns per pixel\n", ns / 1e3, ns / 1000);
+}
@@ -0,0 +1,1745 @@
+/* Tests and benchmarks of the led_strip RMT and SPI backends on the driver shims
+*/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "unity.h"
+#include "led_strip.h"
+#include "led_strip_interface.h"
+#include "led_strip_shim.h"
+#include "led_strip_spi_encoder.h"
+#include "led_strip_rmt_dev.h"
+#include "led_strip_mock.h"
+
+#define BENCH_LEDS 1000
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static led_strip_handle_t new_rmt_strip(uint32_t leds, led_color_component_format_t fmt)
+{
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = 8,
+        .max_leds = leds,
+        .led_model = LED_MODEL_WS2812,
+        .color_component_format = fmt,
+    };
+    led_strip_rmt_config_t rmt_config = { 0 };
+    led_strip_handle_t strip = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_rmt_device(&strip_config, &rmt_config, &strip));
+    return strip;
+}
+
+static led_strip_handle_t new_spi_strip(uint32_t leds, led_color_component_format_t fmt)
+{
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = 8,
+        .max_leds = leds,
+        .led_model = LED_MODEL_WS2812,
+        .color_component_format = fmt,
+    };
+    led_strip_spi_config_t spi_config = { .spi_bus = SPI2_HOST };
+    led_strip_handle_t strip = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_spi_device(&strip_config, &spi_config, &strip));
+    return strip;
+}
+
+static led_strip_handle_t new_streaming_spi_strip(uint32_t leds, led_color_component_format_t fmt)
+{
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = 8,
+        .max_leds = leds,
+        .led_model = LED_MODEL_WS2812,
+        .color_component_format = fmt,
+    };
+    led_strip_spi_config_t spi_config = { .spi_bus = SPI2_HOST, .flags.with_dma = true, .flags.streaming = true };
+    led_strip_handle_t strip = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_spi_device(&strip_config, &spi_config, &strip));
+    return strip;
+}
+
+// The pixels stay in R, G, B(, W) order, the encoder reorders them
+static led_strip_handle_t new_reordering_rmt_strip(uint32_t leds, led_color_component_format_t fmt)
+{
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = 8,
+        .max_leds = leds,
+        .led_model = LED_MODEL_WS2812,
+        .color_component_format = fmt,
+    };
+    led_strip_rmt_config_t rmt_config = { .flags.encoder_reorder = true };
+    led_strip_handle_t strip = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_rmt_device(&strip_config, &rmt_config, &strip));
+    return strip;
+}
+
+static led_strip_handle_t new_double_buffered_strip(bool spi, uint32_t leds)
+{
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = 8,
+        .max_leds = leds,
+        .led_model = LED_MODEL_WS2812,
+        .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB,
+        .flags.double_buffer = true,
+    };
+    led_strip_rmt_config_t rmt_config = { 0 };
+    led_strip_spi_config_t spi_config = { .spi_bus = SPI2_HOST };
+    led_strip_handle_t strip = NULL;
+    if (spi) {
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_spi_device(&strip_config, &spi_config, &strip));
+    } else {
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_rmt_device(&strip_config, &rmt_config, &strip));
+    }
+    return strip;
+}
+
+// Deterministic colors, different for every pixel and component
+static void fill_pattern(uint8_t *colors, size_t bytes, uint8_t seed)
+{
+    for (size_t i = 0; i < bytes; i++) {
+        colors[i] = (uint8_t)(i * 37 + seed);
+    }
+}
+
+// Bytes put on the wire by a refresh, copied to out
+static size_t refresh_and_capture(led_strip_handle_t strip, uint8_t *out, size_t size)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh(strip));
+    size_t tx_size = 0;
+    const uint8_t *tx = led_strip_shim_last_tx(&tx_size);
+    TEST_ASSERT_TRUE(tx_size <= size);
+    memcpy(out, tx, tx_size);
+    return tx_size;
+}
+
+// set_pixels over a sub-range gives the same frame as set_pixel on each of its pixels
+static void check_bulk_matches_single(led_strip_handle_t bulk, led_strip_handle_t single, uint32_t leds, bool rgbw)
+{
+    static uint8_t colors[64 * 4];
+    static uint8_t frame_bulk[64 * 4 * 3];
+    static uint8_t frame_single[64 * 4 * 3];
+    size_t stride = rgbw ? 4 : 3;
+    TEST_ASSERT_TRUE(leds <= 64);
+    fill_pattern(colors, leds * stride, 5);
+
+    // A background first, so that writing past the range would show
+    for (uint32_t i = 0; i < leds; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(bulk, i, 1, 2, 3));
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(single, i, 1, 2, 3));
+    }
+    uint32_t start = 3, count = leds - 5;
+    if (rgbw) {
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixels_rgbw(bulk, start, count, colors));
+    } else {
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixels(bulk, start, count, colors));
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t *c = &colors[i * stride];
+        if (rgbw) {
+            TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel_rgbw(single, start + i, c[0], c[1], c[2], c[3]));
+        } else {
+            TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(single, start + i, c[0], c[1], c[2]));
+        }
+    }
+    size_t bulk_size = refresh_and_capture(bulk, frame_bulk, sizeof(frame_bulk));
+    size_t single_size = refresh_and_capture(single, frame_single, sizeof(frame_single));
+    TEST_ASSERT_EQUAL(single_size, bulk_size);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame_single, frame_bulk, single_size);
+}
+
+TEST_CASE("led_strip set_pixels matches set_pixel on every backend and format", "[led_strip]")
+{
+    const led_color_component_format_t formats[] = {
+        LED_STRIP_COLOR_COMPONENT_FMT_GRB,
+        LED_STRIP_COLOR_COMPONENT_FMT_RGB,
+        LED_STRIP_COLOR_COMPONENT_FMT_GRBW,
+        LED_STRIP_COLOR_COMPONENT_FMT_RGBW,
+    };
+    const uint32_t leds = 20;
+    for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+        bool has_white = formats[f].format.num_components == 4;
+        for (int rgbw = 0; rgbw <= has_white; rgbw++) {
+            led_strip_handle_t bulk = new_rmt_strip(leds, formats[f]);
+            led_strip_handle_t single = new_rmt_strip(leds, formats[f]);
+            check_bulk_matches_single(bulk, single, leds, rgbw);
+            led_strip_del(bulk);
+            led_strip_del(single);
+
+            bulk = new_spi_strip(leds, formats[f]);
+            single = new_spi_strip(leds, formats[f]);
+            check_bulk_matches_single(bulk, single, leds, rgbw);
+            led_strip_del(bulk);
+            led_strip_del(single);
+        }
+    }
+}
+
+TEST_CASE("led_strip set_pixels checks the range", "[led_strip]")
+{
+    uint8_t colors[4 * 4] = { 0 };
+    led_strip_handle_t strips[] = {
+        new_rmt_strip(4, LED_STRIP_COLOR_COMPONENT_FMT_GRB),
+        new_spi_strip(4, LED_STRIP_COLOR_COMPONENT_FMT_GRB),
+    };
+    for (size_t s = 0; s < sizeof(strips) / sizeof(strips[0]); s++) {
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixels(strips[s], 0, 4, colors));
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixels(strips[s], 4, 0, colors));
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_set_pixels(strips[s], 1, 4, colors));
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_set_pixels(strips[s], 5, 0, colors));
+        // start + count would wrap around
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_set_pixels(strips[s], 2, UINT32_MAX, colors));
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_set_pixels(strips[s], 0, 1, NULL));
+        // No white component
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_set_pixels_rgbw(strips[s], 0, 1, colors));
+        led_strip_del(strips[s]);
+    }
+}
+
+TEST_CASE("led_strip async refresh sends the frame of the call while the next one is set", "[led_strip]")
+{
+    static uint8_t expected[4 * 3 * 3];
+    static uint8_t frame[4 * 3 * 3];
+    for (int spi = 0; spi <= 1; spi++) {
+        // Reference frames from a single buffered strip refreshed synchronously
+        led_strip_handle_t ref = spi ? new_spi_strip(4, LED_STRIP_COLOR_COMPONENT_FMT_GRB)
+                                     : new_rmt_strip(4, LED_STRIP_COLOR_COMPONENT_FMT_GRB);
+        led_strip_handle_t strip = new_double_buffered_strip(spi, 4);
+
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(strip, 0, 10, 20, 30));
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh_async(strip));
+        TEST_ASSERT_TRUE(led_strip_shim_tx_pending());
+        // Set while the first frame is on the wire
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(strip, 1, 40, 50, 60));
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh_wait_done(strip, -1));
+        TEST_ASSERT_FALSE(led_strip_shim_tx_pending());
+        size_t size = 0;
+        const uint8_t *tx = led_strip_shim_last_tx(&size);
+        memcpy(frame, tx, size);
+
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(ref, 0, 10, 20, 30));
+        size_t expected_size = refresh_and_capture(ref, expected, sizeof(expected));
+        TEST_ASSERT_EQUAL(expected_size, size);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, frame, size);
+
+        // The next frame starts from the previous one
+        size = refresh_and_capture(strip, frame, sizeof(frame));
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(ref, 1, 40, 50, 60));
+        refresh_and_capture(ref, expected, sizeof(expected));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, frame, size);
+
+        led_strip_del(strip);
+        led_strip_del(ref);
+    }
+}
+
+static bool count_refresh_done(led_strip_handle_t strip, void *user_ctx)
+{
+    (*(int *)user_ctx)++;
+    return false;
+}
+
+TEST_CASE("led_strip refresh done callback runs once per frame", "[led_strip]")
+{
+    const led_strip_event_callbacks_t cbs = {
+        .on_refresh_done = count_refresh_done,
+    };
+    for (int spi = 0; spi <= 1; spi++) {
+        int done = 0;
+        led_strip_handle_t strip = new_double_buffered_strip(spi, 4);
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_register_event_callbacks(strip, &cbs, &done));
+
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh(strip));
+        TEST_ASSERT_EQUAL(1, done);
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh_async(strip));
+        TEST_ASSERT_EQUAL(1, done);
+        led_strip_shim_complete();
+        TEST_ASSERT_EQUAL(2, done);
+        // Nothing left in flight
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh_wait_done(strip, 0));
+        TEST_ASSERT_EQUAL(2, done);
+
+        led_strip_del(strip);
+    }
+}
+
+static int s_sync_refreshes;
+
+static esp_err_t sync_refresh(led_strip_t *strip)
+{
+    s_sync_refreshes++;
+    return ESP_OK;
+}
+
+TEST_CASE("led_strip async API falls back on a synchronous backend", "[led_strip]")
+{
+    led_strip_t strip = {
+        .refresh = sync_refresh,
+    };
+    const led_strip_event_callbacks_t cbs = { 0 };
+    s_sync_refreshes = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh_async(&strip));
+    TEST_ASSERT_EQUAL(1, s_sync_refreshes);
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh_wait_done(&strip, -1));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, led_strip_register_event_callbacks(&strip, &cbs, NULL));
+}
+
+TEST_CASE("led_strip SPI refresh sends up to the last changed pixel", "[led_strip]")
+{
+    const uint32_t leds = 10;
+    const size_t pixel_bytes = 3 * SPI_BYTES_PER_COLOR_BYTE;
+    static uint8_t all_off[10 * 9];
+    static uint8_t frame[10 * 9];
+    const uint8_t off[3] = { 0 };
+    led_strip_handle_t strip = new_spi_strip(leds, LED_STRIP_COLOR_COMPONENT_FMT_GRB);
+
+    // The first refresh sends the whole strip
+    TEST_ASSERT_EQUAL(leds * pixel_bytes, refresh_and_capture(strip, all_off, sizeof(all_off)));
+
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(strip, 3, 1, 2, 3));
+    TEST_ASSERT_EQUAL(4 * pixel_bytes, refresh_and_capture(strip, frame, sizeof(frame)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(all_off, frame, 3 * pixel_bytes);
+
+    // Writing the colors the LEDs already have changes nothing, only the first pixel goes out
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(strip, 3, 1, 2, 3));
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixels(strip, 5, 1, off));
+    TEST_ASSERT_EQUAL(pixel_bytes, refresh_and_capture(strip, frame, sizeof(frame)));
+
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(strip, 7, 4, 5, 6));
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(strip, 1, 4, 5, 6));
+    TEST_ASSERT_EQUAL(8 * pixel_bytes, refresh_and_capture(strip, frame, sizeof(frame)));
+
+    // Clear goes up to the last LED that was on
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_clear(strip));
+    size_t size = 0;
+    const uint8_t *tx = led_strip_shim_last_tx(&size);
+    TEST_ASSERT_EQUAL(8 * pixel_bytes, size);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(all_off, tx, size);
+
+    led_strip_del(strip);
+}
+
+TEST_CASE("led_strip SPI double buffer stays whole when only the changes are copied", "[led_strip]")
+{
+    enum { LEDS = 24 };
+    const size_t pixel_bytes = 3 * SPI_BYTES_PER_COLOR_BYTE;
+    static uint8_t colors[LEDS * 3];
+    static uint8_t sent[LEDS * 3];
+    static uint8_t expected[LEDS * 9];
+    memset(colors, 0, sizeof(colors));
+    led_strip_handle_t strip = new_double_buffered_strip(true, LEDS);
+
+    uint32_t seed = 1;
+    for (int frame = 0; frame < 200; frame++) {
+        // A few random pixels, some of them set while the previous frame is in flight
+        int changes = frame % 4;
+        for (int c = 0; c <= changes; c++) {
+            seed = seed * 1103515245 + 12345;
+            uint32_t index = (seed >> 16) % LEDS;
+            uint8_t *rgb = &colors[index * 3];
+            rgb[0] = seed >> 8;
+            rgb[1] = seed >> 12;
+            rgb[2] = frame;
+            TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(strip, index, rgb[0], rgb[1], rgb[2]));
+            if (c == changes / 2) {
+                memcpy(sent, colors, sizeof(colors));
+                TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh_async(strip));
+            }
+        }
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh_wait_done(strip, -1));
+
+        for (uint32_t i = 0; i < LEDS; i++) {
+            const uint8_t grb[3] = { sent[i * 3 + 1], sent[i * 3], sent[i * 3 + 2] };
+            led_strip_spi_encode_pixel(grb, 3, &expected[i * pixel_bytes]);
+        }
+        size_t size = 0;
+        const uint8_t *tx = led_strip_shim_last_tx(&size);
+        TEST_ASSERT_TRUE(size >= pixel_bytes && size <= sizeof(expected));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, tx, size);
+    }
+    led_strip_del(strip);
+}
+
+TEST_CASE("led_strip SPI streaming sends the frames of the whole strip encoding", "[led_strip]")
+{
+    static uint8_t colors[200 * 4];
+    static uint8_t expected[200 * 4 * 3];
+    static uint8_t frame[200 * 4 * 3];
+    const led_strip_event_callbacks_t cbs = {
+        .on_refresh_done = count_refresh_done,
+    };
+    const led_color_component_format_t formats[] = {
+        LED_STRIP_COLOR_COMPONENT_FMT_GRB,
+        LED_STRIP_COLOR_COMPONENT_FMT_GRBW,
+    };
+    // Within one chunk, exactly one, one more, and several chunks
+    const uint32_t lengths[] = { 1, 64, 65, 200 };
+    for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+        uint8_t n = formats[f].format.num_components;
+        for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+            uint32_t leds = lengths[l];
+            led_strip_handle_t ref = new_spi_strip(leds, formats[f]);
+            led_strip_handle_t strip = new_streaming_spi_strip(leds, formats[f]);
+            uint32_t chunk_pixels = leds < 64 ? leds : 64;
+            TEST_ASSERT_EQUAL(chunk_pixels * n * SPI_BYTES_PER_COLOR_BYTE, led_strip_shim_spi_max_transfer_sz());
+            int done = 0;
+            TEST_ASSERT_EQUAL(ESP_OK, led_strip_register_event_callbacks(strip, &cbs, &done));
+
+            uint32_t seed = 7;
+            for (int step = 0; step < 12; step++) {
+                seed = seed * 1103515245 + 12345;
+                uint32_t start = (seed >> 16) % leds;
+                uint32_t count = 1 + (seed >> 8) % (leds - start);
+                fill_pattern(colors, count * n, (uint8_t)step);
+                led_strip_handle_t both[] = { ref, strip };
+                for (int b = 0; b < 2; b++) {
+                    if (step == 9) {
+                        TEST_ASSERT_EQUAL(ESP_OK, led_strip_clear(both[b]));
+                    } else if (n > 3) {
+                        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixels_rgbw(both[b], start, count, colors));
+                    } else {
+                        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixels(both[b], start, count, colors));
+                    }
+                }
+                size_t expected_size = refresh_and_capture(ref, expected, sizeof(expected));
+                uint32_t frames = led_strip_shim_tx_count();
+                // Pixels can be set again as soon as the refresh returns
+                TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh_async(strip));
+                TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(strip, 0, 255, 255, 255));
+                TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(ref, 0, 255, 255, 255));
+                TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh_wait_done(strip, -1));
+                // One frame on the wire, not one per chunk
+                TEST_ASSERT_EQUAL(frames + 1, led_strip_shim_tx_count());
+                size_t size = 0;
+                const uint8_t *tx = led_strip_shim_last_tx(&size);
+                TEST_ASSERT_EQUAL(expected_size, size);
+                memcpy(frame, tx, size);
+                TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, frame, size);
+            }
+            // The clear refreshes once more
+            TEST_ASSERT_EQUAL(13, done);
+            led_strip_del(strip);
+            led_strip_del(ref);
+        }
+    }
+}
+
+TEST_CASE("led_strip SPI streaming of 2000 LEDs", "[led_strip][bench]")
+{
+    enum { LEDS = 2000 };
+    static uint8_t colors[LEDS * 3];
+    const int frames = 200;
+    int64_t refresh[2];
+    size_t dma_bytes[2];
+    for (int streaming = 0; streaming <= 1; streaming++) {
+        led_strip_handle_t strip = streaming ? new_streaming_spi_strip(LEDS, LED_STRIP_COLOR_COMPONENT_FMT_GRB)
+                                             : new_spi_strip(LEDS, LED_STRIP_COLOR_COMPONENT_FMT_GRB);
+        dma_bytes[streaming] = led_strip_shim_spi_max_transfer_sz() * (streaming ? 2 : 1);
+        // Every pixel changes, so that every frame is sent whole
+        int64_t start = now_ns();
+        for (int f = 0; f < frames; f++) {
+            fill_pattern(colors, sizeof(colors), f);
+            led_strip_set_pixels(strip, 0, LEDS, colors);
+            led_strip_refresh(strip);
+        }
+        refresh[streaming] = (now_ns() - start) / frames;
+        size_t size = 0;
+        led_strip_shim_last_tx(&size);
+        TEST_ASSERT_EQUAL(LEDS * 3 * SPI_BYTES_PER_COLOR_BYTE, size);
+        led_strip_del(strip);
+    }
+    printf("led_strip SPI frame of %d LEDs: whole strip encoding %zu DMA bytes, %.1f us per frame; "
+           "streaming %zu DMA bytes, %.1f us per frame\n",
+           LEDS, dma_bytes[0], refresh[0] / 1e3, dma_bytes[1], refresh[1] / 1e3);
+}
+
+TEST_CASE("led_strip SPI status strip refresh", "[led_strip][bench]")
+{
+    // A status display: a handful of the first LEDs change, the rest of the strip stays
+    const int frames = 1000;
+    const size_t pixel_bytes = 3 * SPI_BYTES_PER_COLOR_BYTE;
+    led_strip_handle_t strip = new_spi_strip(BENCH_LEDS, LED_STRIP_COLOR_COMPONENT_FMT_GRB);
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh(strip));
+
+    size_t bytes = 0;
+    for (int f = 0; f < frames; f++) {
+        for (uint32_t i = 0; i < 3; i++) {
+            TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(strip, (f + i * 5) % 16, f, 2 * f, 3 * f));
+        }
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh(strip));
+        size_t size = 0;
+        led_strip_shim_last_tx(&size);
+        bytes += size;
+    }
+    size_t full = BENCH_LEDS * pixel_bytes;
+    // 2.5 MHz SPI clock, 8 bits per SPI byte
+    printf("led_strip SPI status frame of %d LEDs: %zu bytes instead of %zu, %.0f us instead of %.0f us on the wire\n",
+           BENCH_LEDS, bytes / frames, full, bytes * 8 / 2.5 / frames, full * 8 / 2.5);
+    led_strip_del(strip);
+}
+
+// Wire bytes expected for colors in R, G, B(, W) order, each component through lut
+static void expected_wire(const uint8_t *colors, uint32_t leds, led_color_component_format_t fmt, const uint8_t *lut, uint8_t *wire)
+{
+    uint8_t n = fmt.format.num_components;
+    for (uint32_t i = 0; i < leds; i++) {
+        const uint8_t *c = &colors[i * n];
+        uint8_t *w = &wire[i * n];
+        w[fmt.format.r_pos] = lut ? lut[c[0]] : c[0];
+        w[fmt.format.g_pos] = lut ? lut[c[1]] : c[1];
+        w[fmt.format.b_pos] = lut ? lut[c[2]] : c[2];
+        if (n > 3) {
+            w[fmt.format.w_pos] = lut ? lut[c[3]] : c[3];
+        }
+    }
+}
+
+TEST_CASE("led_strip RMT encoder applies the color table and the component order", "[led_strip]")
+{
+    // Longer than the chunk of the encoder and than the channel memory, so that both resume
+    enum { LEDS = 37 };
+    static uint8_t colors[LEDS * 4];
+    static uint8_t expected[LEDS * 4];
+    static uint8_t frame[LEDS * 4];
+    static uint8_t lut[256];
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_make_color_lut(lut, 2.2f, 200));
+    const led_color_component_format_t formats[] = {
+        LED_STRIP_COLOR_COMPONENT_FMT_GRB,
+        LED_STRIP_COLOR_COMPONENT_FMT_GRBW,
+    };
+    for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+        led_color_component_format_t fmt = formats[f];
+        uint8_t n = fmt.format.num_components;
+        fill_pattern(colors, LEDS * n, 9);
+        for (int reorder = 0; reorder <= 1; reorder++) {
+            led_strip_handle_t strip = reorder ? new_reordering_rmt_strip(LEDS, fmt) : new_rmt_strip(LEDS, fmt);
+            if (n > 3) {
+                TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixels_rgbw(strip, 0, LEDS, colors));
+            } else {
+                TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixels(strip, 0, LEDS, colors));
+            }
+
+            // Without a table the pixels go out as they are, in the order of the LEDs either way
+            expected_wire(colors, LEDS, fmt, NULL, expected);
+            TEST_ASSERT_EQUAL(LEDS * n, refresh_and_capture(strip, frame, sizeof(frame)));
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, frame, LEDS * n);
+
+            TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_color_lut(strip, lut));
+            expected_wire(colors, LEDS, fmt, lut, expected);
+            TEST_ASSERT_EQUAL(LEDS * n, refresh_and_capture(strip, frame, sizeof(frame)));
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, frame, LEDS * n);
+
+            TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_color_lut(strip, NULL));
+            expected_wire(colors, LEDS, fmt, NULL, expected);
+            refresh_and_capture(strip, frame, sizeof(frame));
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, frame, LEDS * n);
+            led_strip_del(strip);
+        }
+    }
+}
+
+TEST_CASE("led_strip color table is used from the next refresh", "[led_strip]")
+{
+    static uint8_t dim[256];
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_make_color_lut(dim, 1.0f, 64));
+    led_strip_handle_t strip = new_double_buffered_strip(false, 2);
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(strip, 0, 255, 128, 0));
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh_async(strip));
+    // Swapped while the frame is in flight
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_color_lut(strip, dim));
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh_wait_done(strip, -1));
+    size_t size = 0;
+    const uint8_t *tx = led_strip_shim_last_tx(&size);
+    const uint8_t full[3] = { 128, 255, 0 };
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(full, tx, 3);
+
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh(strip));
+    tx = led_strip_shim_last_tx(&size);
+    const uint8_t dimmed[3] = { 32, 64, 0 };
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(dimmed, tx, 3);
+    led_strip_del(strip);
+
+    // The SPI backend encodes when the pixels are set, a table would come too late
+    strip = new_spi_strip(2, LED_STRIP_COLOR_COMPONENT_FMT_GRB);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, led_strip_set_color_lut(strip, dim));
+    led_strip_del(strip);
+}
+
+TEST_CASE("led_strip make_color_lut", "[led_strip]")
+{
+    uint8_t lut[256];
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_make_color_lut(lut, 1.0f, 255));
+    for (int i = 0; i < 256; i++) {
+        TEST_ASSERT_EQUAL(i, lut[i]);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_make_color_lut(lut, 2.8f, 100));
+    TEST_ASSERT_EQUAL(0, lut[0]);
+    TEST_ASSERT_EQUAL(100, lut[255]);
+    for (int i = 1; i < 256; i++) {
+        TEST_ASSERT_TRUE(lut[i] >= lut[i - 1]);
+    }
+    // Dark values are crushed by the gamma curve
+    TEST_ASSERT_EQUAL(0, lut[30]);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_make_color_lut(NULL, 2.2f, 255));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_make_color_lut(lut, 0.0f, 255));
+}
+
+TEST_CASE("led_strip brightness change of 1000 LEDs", "[led_strip][bench]")
+{
+    static uint8_t colors[BENCH_LEDS * 3];
+    static uint8_t scaled[BENCH_LEDS * 3];
+    static uint8_t luts[2][256];
+    const int frames = 200;
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_make_color_lut(luts[0], 2.2f, 255));
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_make_color_lut(luts[1], 2.2f, 64));
+    fill_pattern(colors, sizeof(colors), 0);
+    led_strip_handle_t strip = new_reordering_rmt_strip(BENCH_LEDS, LED_STRIP_COLOR_COMPONENT_FMT_GRB);
+
+    // The application dims its framebuffer and sets every pixel again
+    int64_t start = now_ns();
+    for (int f = 0; f < frames; f++) {
+        const uint8_t *lut = luts[f & 1];
+        for (size_t i = 0; i < sizeof(colors); i++) {
+            scaled[i] = lut[colors[i]];
+        }
+        led_strip_set_pixels(strip, 0, BENCH_LEDS, scaled);
+    }
+    int64_t rewrite = (now_ns() - start) / frames;
+
+    start = now_ns();
+    for (int f = 0; f < frames; f++) {
+        led_strip_set_color_lut(strip, luts[f & 1]);
+    }
+    int64_t swap = (now_ns() - start) / frames;
+
+    // What the table costs the encoder, on the shim encoders
+    led_strip_set_pixels(strip, 0, BENCH_LEDS, colors);
+    int64_t refresh[2];
+    for (int with_lut = 0; with_lut <= 1; with_lut++) {
+        led_strip_set_color_lut(strip, with_lut ? luts[1] : NULL);
+        start = now_ns();
+        for (int f = 0; f < frames; f++) {
+            led_strip_refresh(strip);
+        }
+        refresh[with_lut] = (now_ns() - start) / frames;
+    }
+
+    printf("led_strip brightness change of %d LEDs: rewrite %.1f us, table swap %.3f us; "
+           "encoding with reorder %.1f us, with reorder and table %.1f us per frame\n",
+           BENCH_LEDS, rewrite / 1e3, swap / 1e3, refresh[0] / 1e3, refresh[1] / 1e3);
+    led_strip_del(strip);
+}
+
+// led_strip_set_pixel_hsv before the integer version
+static void float_hsv_to_rgb(uint16_t hue, uint8_t saturation, uint8_t value, uint8_t *rgb)
+{
+    uint32_t rgb_max = value;
+    uint32_t rgb_min = rgb_max * (255 - saturation) / 255.0f;
+    uint32_t i = hue / 60;
+    uint32_t diff = hue % 60;
+    uint32_t rgb_adj = (rgb_max - rgb_min) * diff / 60;
+    switch (i) {
+    case 0:
+        rgb[0] = rgb_max; rgb[1] = rgb_min + rgb_adj; rgb[2] = rgb_min;
+        break;
+    case 1:
+        rgb[0] = rgb_max - rgb_adj; rgb[1] = rgb_max; rgb[2] = rgb_min;
+        break;
+    case 2:
+        rgb[0] = rgb_min; rgb[1] = rgb_max; rgb[2] = rgb_min + rgb_adj;
+        break;
+    case 3:
+        rgb[0] = rgb_min; rgb[1] = rgb_max - rgb_adj; rgb[2] = rgb_max;
+        break;
+    case 4:
+        rgb[0] = rgb_min + rgb_adj; rgb[1] = rgb_min; rgb[2] = rgb_max;
+        break;
+    default:
+        rgb[0] = rgb_max; rgb[1] = rgb_min; rgb[2] = rgb_max - rgb_adj;
+        break;
+    }
+}
+
+TEST_CASE("led_strip HSV conversion gives the colors of the float version", "[led_strip]")
+{
+    static led_strip_hsv_t hsv[256];
+    static uint8_t rgb[256 * 3];
+    uint8_t expected[3];
+    for (uint32_t hue = 0; hue <= 400; hue++) {
+        for (uint32_t saturation = 0; saturation < 256; saturation++) {
+            for (uint32_t value = 0; value < 256; value++) {
+                hsv[value] = (led_strip_hsv_t) { .hue = hue, .saturation = saturation, .value = value };
+            }
+            TEST_ASSERT_EQUAL(ESP_OK, led_strip_hsv_to_rgb(hsv, 256, rgb));
+            for (uint32_t value = 0; value < 256; value++) {
+                float_hsv_to_rgb(hue, saturation, value, expected);
+                if (memcmp(expected, &rgb[value * 3], 3) != 0) {
+                    printf("  hue %u saturation %u value %u\n", (unsigned)hue, (unsigned)saturation, (unsigned)value);
+                    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, &rgb[value * 3], 3);
+                }
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_hsv_to_rgb(NULL, 0, NULL));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_hsv_to_rgb(NULL, 1, rgb));
+}
+
+// Backend that only keeps the pixels it is given, R, G, B(, W) as set, and counts the calls,
+// for the code above the backends
+static uint8_t s_captured[BENCH_LEDS * 4];
+static int s_capture_calls;
+
+static esp_err_t capture_pixels(uint32_t start, uint32_t count, const uint8_t *pixels, uint8_t num_components)
+{
+    if (start > BENCH_LEDS || count > BENCH_LEDS - start) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(&s_captured[start * num_components], pixels, count * num_components);
+    s_capture_calls++;
+    return ESP_OK;
+}
+
+static esp_err_t capture_set_pixels(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *rgb)
+{
+    return capture_pixels(start, count, rgb, 3);
+}
+
+static esp_err_t capture_set_pixels_rgbw(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *rgbw)
+{
+    return capture_pixels(start, count, rgbw, 4);
+}
+
+static led_strip_t capture_strip(void)
+{
+    return (led_strip_t) {
+        .set_pixels = capture_set_pixels,
+        .set_pixels_rgbw = capture_set_pixels_rgbw,
+        .refresh = sync_refresh,
+    };
+}
+
+TEST_CASE("led_strip gradient and rainbow fills", "[led_strip]")
+{
+    led_strip_t strip = capture_strip();
+    uint8_t expected[3];
+
+    // 1 degree per pixel, across several blocks of the conversion
+    s_capture_calls = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_fill_rainbow(&strip, 20, 360, 90, 200, 180));
+    TEST_ASSERT_TRUE(s_capture_calls > 1 && s_capture_calls < 360);
+    for (uint32_t i = 0; i < 360; i++) {
+        float_hsv_to_rgb((90 + i) % 360, 200, 180, expected);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, &s_captured[(20 + i) * 3], 3);
+    }
+
+    // Through red, 10 degrees per pixel, and every component going down or up
+    led_strip_hsv_t from = { .hue = 300, .saturation = 255, .value = 10 };
+    led_strip_hsv_t to = { .hue = 420, .saturation = 135, .value = 250 };
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_fill_gradient(&strip, 0, 13, &from, &to));
+    for (uint32_t i = 0; i < 13; i++) {
+        float_hsv_to_rgb((300 + 10 * i) % 360, 255 - 10 * i, 10 + 20 * i, expected);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, &s_captured[i * 3], 3);
+    }
+    // Every component going down, 10 units per pixel
+    led_strip_hsv_t high = { .hue = 250, .saturation = 250, .value = 250 };
+    led_strip_hsv_t low = { .hue = 130, .saturation = 130, .value = 130 };
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_fill_gradient(&strip, 0, 13, &high, &low));
+    for (uint32_t i = 0; i < 13; i++) {
+        float_hsv_to_rgb(250 - 10 * i, 250 - 10 * i, 250 - 10 * i, expected);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, &s_captured[i * 3], 3);
+    }
+    // Uneven steps still end on the last color
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_fill_gradient(&strip, 0, 397, &to, &from));
+    float_hsv_to_rgb(60, 135, 250, expected);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, &s_captured[0], 3);
+    float_hsv_to_rgb(300, 255, 10, expected);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, &s_captured[396 * 3], 3);
+
+    // A single pixel takes the first color
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_fill_gradient(&strip, 5, 1, &from, &to));
+    float_hsv_to_rgb(300, 255, 10, expected);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, &s_captured[5 * 3], 3);
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_fill_rainbow(&strip, 100, BENCH_LEDS, 0, 255, 255));
+    to.hue = 721;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_fill_gradient(&strip, 0, 10, &from, &to));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_fill_gradient(&strip, 0, 10, NULL, &to));
+}
+
+TEST_CASE("led_strip HSV pixels per second", "[led_strip][bench]")
+{
+    static led_strip_hsv_t hsv[BENCH_LEDS];
+    static uint8_t rgb[BENCH_LEDS * 3];
+    const int frames = 200;
+    for (uint32_t i = 0; i < BENCH_LEDS; i++) {
+        hsv[i] = (led_strip_hsv_t) { .hue = i * 360 / BENCH_LEDS, .saturation = 255 - i % 64, .value = 128 + i % 128 };
+    }
+    led_strip_handle_t strip = new_rmt_strip(BENCH_LEDS, LED_STRIP_COLOR_COMPONENT_FMT_GRB);
+    int64_t elapsed[4];
+
+    // Float conversion and a backend call per pixel, the former led_strip_set_pixel_hsv
+    int64_t start = now_ns();
+    for (int f = 0; f < frames; f++) {
+        for (uint32_t i = 0; i < BENCH_LEDS; i++) {
+            uint8_t c[3];
+            float_hsv_to_rgb(hsv[i].hue, hsv[i].saturation, hsv[i].value, c);
+            led_strip_set_pixel(strip, i, c[0], c[1], c[2]);
+        }
+    }
+    elapsed[0] = now_ns() - start;
+
+    start = now_ns();
+    for (int f = 0; f < frames; f++) {
+        for (uint32_t i = 0; i < BENCH_LEDS; i++) {
+            led_strip_set_pixel_hsv(strip, i, hsv[i].hue, hsv[i].saturation, hsv[i].value);
+        }
+    }
+    elapsed[1] = now_ns() - start;
+
+    start = now_ns();
+    for (int f = 0; f < frames; f++) {
+        led_strip_set_pixels_hsv(strip, 0, BENCH_LEDS, hsv);
+    }
+    elapsed[2] = now_ns() - start;
+
+    start = now_ns();
+    for (int f = 0; f < frames; f++) {
+        led_strip_fill_rainbow(strip, 0, BENCH_LEDS, f, 255, 128);
+    }
+    elapsed[3] = now_ns() - start;
+    led_strip_hsv_to_rgb(hsv, BENCH_LEDS, rgb);
+
+    double pixels = (double)frames * BENCH_LEDS;
+    printf("led_strip HSV Mpixels/s on the host FPU: float per pixel %.1f, set_pixel_hsv %.1f, set_pixels_hsv %.1f, fill_rainbow %.1f\n",
+           pixels * 1e3 / elapsed[0], pixels * 1e3 / elapsed[1], pixels * 1e3 / elapsed[2], pixels * 1e3 / elapsed[3]);
+    led_strip_del(strip);
+}
+
+static const led_strip_shim_tx_t *strip_last_tx(led_strip_handle_t strip)
+{
+    rmt_channel_handle_t chan = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_rmt_get_channel(strip, &chan));
+    return led_strip_shim_rmt_last_tx(chan);
+}
+
+TEST_CASE("led_strip group starts every strip on the same tick", "[led_strip]")
+{
+    static uint8_t colors[120 * 3];
+    static uint8_t expected[120 * 3];
+    const uint32_t lengths[] = { 10, 120, 30, 60 };
+    const size_t num_strips = sizeof(lengths) / sizeof(lengths[0]);
+    led_strip_handle_t strips[4];
+    for (size_t s = 0; s < num_strips; s++) {
+        strips[s] = new_rmt_strip(lengths[s], LED_STRIP_COLOR_COMPONENT_FMT_GRB);
+    }
+    led_strip_group_config_t group_config = {
+        .strips = strips,
+        .num_strips = num_strips,
+    };
+    led_strip_group_handle_t group = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_rmt_group(&group_config, &group));
+
+    for (int frame = 0; frame < 3; frame++) {
+        for (size_t s = 0; s < num_strips; s++) {
+            fill_pattern(colors, lengths[s] * 3, (uint8_t)(frame * 16 + s));
+            TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixels(strips[s], 0, lengths[s], colors));
+        }
+        int64_t start = led_strip_shim_wire_time_us();
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_group_refresh(group));
+
+        int64_t longest = 0;
+        for (size_t s = 0; s < num_strips; s++) {
+            const led_strip_shim_tx_t *tx = strip_last_tx(strips[s]);
+            TEST_ASSERT_EQUAL(start, tx->start_us);
+            if (tx->end_us - tx->start_us > longest) {
+                longest = tx->end_us - tx->start_us;
+            }
+            // Same frame as the strip would send alone
+            led_strip_handle_t ref = new_rmt_strip(lengths[s], LED_STRIP_COLOR_COMPONENT_FMT_GRB);
+            fill_pattern(colors, lengths[s] * 3, (uint8_t)(frame * 16 + s));
+            led_strip_set_pixels(ref, 0, lengths[s], colors);
+            size_t size = refresh_and_capture(ref, expected, sizeof(expected));
+            TEST_ASSERT_EQUAL(size, tx->size);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, tx->data, size);
+            led_strip_del(ref);
+        }
+        // The longest strip, 120 LEDs of 24 bits of 1.2 us plus the reset
+        TEST_ASSERT_EQUAL(120 * 24 * 12 / 10 + 280, longest);
+        TEST_ASSERT_TRUE(led_strip_shim_wire_time_us() >= start + longest);
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_group_del(group));
+    for (size_t s = 0; s < num_strips; s++) {
+        led_strip_del(strips[s]);
+    }
+}
+
+TEST_CASE("led_strip group takes RMT strips only, in one group", "[led_strip]")
+{
+    led_strip_handle_t strips[] = {
+        new_rmt_strip(4, LED_STRIP_COLOR_COMPONENT_FMT_GRB),
+        new_spi_strip(4, LED_STRIP_COLOR_COMPONENT_FMT_GRB),
+    };
+    led_strip_group_config_t group_config = {
+        .strips = strips,
+        .num_strips = 2,
+    };
+    led_strip_group_handle_t group = NULL;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_new_rmt_group(&group_config, &group));
+    group_config.num_strips = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_new_rmt_group(&group_config, &group));
+
+    group_config.num_strips = 1;
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_rmt_group(&group_config, &group));
+    led_strip_group_handle_t other = NULL;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, led_strip_new_rmt_group(&group_config, &other));
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_group_del(group));
+    led_strip_del(strips[0]);
+    led_strip_del(strips[1]);
+}
+
+TEST_CASE("led_strip group of 8 strips of 300 LEDs", "[led_strip][bench]")
+{
+    static uint8_t colors[300 * 3];
+    const int frames = 100;
+    led_strip_handle_t strips[8];
+    for (int s = 0; s < 8; s++) {
+        strips[s] = new_rmt_strip(300, LED_STRIP_COLOR_COMPONENT_FMT_GRB);
+        fill_pattern(colors, sizeof(colors), s);
+        led_strip_set_pixels(strips[s], 0, 300, colors);
+    }
+
+    // One blocking refresh after the other
+    int64_t start_us = led_strip_shim_wire_time_us();
+    int64_t start = now_ns();
+    for (int f = 0; f < frames; f++) {
+        for (int s = 0; s < 8; s++) {
+            led_strip_refresh(strips[s]);
+        }
+    }
+    int64_t sequential_cpu = (now_ns() - start) / frames;
+    double sequential_us = (double)(led_strip_shim_wire_time_us() - start_us) / frames;
+
+    led_strip_group_config_t group_config = {
+        .strips = strips,
+        .num_strips = 8,
+    };
+    led_strip_group_handle_t group = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_rmt_group(&group_config, &group));
+    start_us = led_strip_shim_wire_time_us();
+    start = now_ns();
+    for (int f = 0; f < frames; f++) {
+        led_strip_group_refresh(group);
+    }
+    int64_t group_cpu = (now_ns() - start) / frames;
+    double group_us = (double)(led_strip_shim_wire_time_us() - start_us) / frames;
+
+    printf("led_strip 8 strips of 300 LEDs on the wire clock: one after the other %.2f ms per frame (%.1f fps), "
+           "group %.2f ms per frame (%.1f fps); host %.1f us and %.1f us per frame\n",
+           sequential_us / 1e3, 1e6 / sequential_us, group_us / 1e3, 1e6 / group_us, sequential_cpu / 1e3, group_cpu / 1e3);
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_group_del(group));
+    for (int s = 0; s < 8; s++) {
+        led_strip_del(strips[s]);
+    }
+}
+
+typedef struct {
+    const char *name;
+    led_strip_handle_t (*new_strip)(uint32_t leds, led_color_component_format_t fmt);
+    led_color_component_format_t fmt;
+} bench_strip_t;
+
+TEST_CASE("led_strip fill time of 1000 LEDs", "[led_strip][bench]")
+{
+    static uint8_t colors[BENCH_LEDS * 3];
+    const bench_strip_t strips[] = {
+        { "RMT GRB", new_rmt_strip, LED_STRIP_COLOR_COMPONENT_FMT_GRB },
+        { "RMT RGB", new_rmt_strip, LED_STRIP_COLOR_COMPONENT_FMT_RGB },
+        { "SPI GRB", new_spi_strip, LED_STRIP_COLOR_COMPONENT_FMT_GRB },
+    };
+    const int frames = 2000;
+    for (size_t s = 0; s < sizeof(strips) / sizeof(strips[0]); s++) {
+        led_strip_handle_t strip = strips[s].new_strip(BENCH_LEDS, strips[s].fmt);
+        fill_pattern(colors, sizeof(colors), 0);
+
+        int64_t start = now_ns();
+        for (int f = 0; f < frames; f++) {
+            colors[0] = f;
+            for (uint32_t i = 0; i < BENCH_LEDS; i++) {
+                led_strip_set_pixel(strip, i, colors[i * 3], colors[i * 3 + 1], colors[i * 3 + 2]);
+            }
+        }
+        int64_t per_pixel = (now_ns() - start) / frames;
+
+        start = now_ns();
+        for (int f = 0; f < frames; f++) {
+            colors[0] = f;
+            led_strip_set_pixels(strip, 0, BENCH_LEDS, colors);
+        }
+        int64_t bulk = (now_ns() - start) / frames;
+
+        printf("led_strip %s fill of %d LEDs: set_pixel loop %.1f us, set_pixels %.1f us, %.1fx\n", strips[s].name,
+               BENCH_LEDS, per_pixel / 1e3, bulk / 1e3, (double)per_pixel / bulk);
+        led_strip_del(strip);
+    }
+}
+
+// The bit by bit SPI encoder the lookup tables replaced, the destination must be zeroed
+static void reference_spi_bit(uint8_t data, uint8_t *buf)
+{
+    buf[2] |= data & BIT(0) ? BIT(2) | BIT(1) : BIT(2);
+    buf[2] |= data & BIT(1) ? BIT(5) | BIT(4) : BIT(5);
+    buf[2] |= data & BIT(2) ? BIT(7) : 0x00;
+    buf[1] |= BIT(0);
+    buf[1] |= data & BIT(3) ? BIT(3) | BIT(2) : BIT(3);
+    buf[1] |= data & BIT(4) ? BIT(6) | BIT(5) : BIT(6);
+    buf[0] |= data & BIT(5) ? BIT(1) | BIT(0) : BIT(1);
+    buf[0] |= data & BIT(6) ? BIT(4) | BIT(3) : BIT(4);
+    buf[0] |= data & BIT(7) ? BIT(7) | BIT(6) : BIT(7);
+}
+
+static void reference_spi_pixel(const uint8_t *wire, uint8_t num_components, uint8_t *buf)
+{
+    memset(buf, 0, num_components * SPI_BYTES_PER_COLOR_BYTE);
+    for (int c = 0; c < num_components; c++) {
+        reference_spi_bit(wire[c], buf + c * SPI_BYTES_PER_COLOR_BYTE);
+    }
+}
+
+TEST_CASE("led_strip SPI lookup tables match the bit by bit encoder", "[led_strip]")
+{
+    for (int data = 0; data < 256; data++) {
+        uint8_t expected[3] = { 0 };
+        reference_spi_bit(data, expected);
+        // Garbage in the destination must be overwritten
+        uint8_t actual[3] = { 0xA5, 0x5A, 0xFF };
+        led_strip_spi_encode_byte(data, actual);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, actual, 3);
+        TEST_ASSERT_EQUAL_HEX32(expected[0] << 16 | expected[1] << 8 | expected[2], led_strip_spi_word_lut[data]);
+    }
+    uint8_t wire[4];
+    for (int i = 0; i < 4096; i++) {
+        fill_pattern(wire, sizeof(wire), i);
+        wire[i & 3] = i >> 4;
+        for (uint8_t n = 3; n <= 4; n++) {
+            uint8_t expected[12];
+            uint8_t actual[13];
+            memset(actual, 0xA5, sizeof(actual));
+            reference_spi_pixel(wire, n, expected);
+            led_strip_spi_encode_pixel(wire, n, actual);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, actual, n * SPI_BYTES_PER_COLOR_BYTE);
+            // Nothing written past the pixel
+            TEST_ASSERT_EQUAL_HEX8(0xA5, actual[n * SPI_BYTES_PER_COLOR_BYTE]);
+        }
+    }
+}
+
+TEST_CASE("led_strip SPI encoding speed", "[led_strip][bench]")
+{
+    static uint8_t colors[BENCH_LEDS * 3];
+    static uint8_t spi[BENCH_LEDS * 3 * SPI_BYTES_PER_COLOR_BYTE];
+    static uint8_t spi_ref[BENCH_LEDS * 3 * SPI_BYTES_PER_COLOR_BYTE];
+    const int frames = 2000;
+    fill_pattern(colors, sizeof(colors), 0);
+
+    int64_t start = now_ns();
+    for (int f = 0; f < frames; f++) {
+        colors[0] = f;
+        for (int i = 0; i < BENCH_LEDS; i++) {
+            reference_spi_pixel(&colors[i * 3], 3, &spi_ref[i * 9]);
+        }
+    }
+    int64_t reference = (now_ns() - start) / frames;
+
+    start = now_ns();
+    for (int f = 0; f < frames; f++) {
+        colors[0] = f;
+        for (int i = 0; i < BENCH_LEDS * 3; i++) {
+            led_strip_spi_encode_byte(colors[i], &spi[i * 3]);
+        }
+    }
+    int64_t bytes = (now_ns() - start) / frames;
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(spi_ref, spi, sizeof(spi));
+
+    start = now_ns();
+    for (int f = 0; f < frames; f++) {
+        colors[0] = f;
+        for (int i = 0; i < BENCH_LEDS; i++) {
+            led_strip_spi_encode_pixel(&colors[i * 3], 3, &spi[i * 9]);
+        }
+    }
+    int64_t pixels = (now_ns() - start) / frames;
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(spi_ref, spi, sizeof(spi));
+
+    printf("led_strip SPI encoding of %d RGB pixels: bit by bit %.1f us, byte table %.1f us (%.1fx), "
+           "word table %.1f us (%.1fx)\n", BENCH_LEDS, reference / 1e3, bytes / 1e3, (double)reference / bytes,
+           pixels / 1e3, (double)reference / pixels);
+}
+
+// Scalar model of the dithering: value scaled to 8.8 bits plus the error of the previous frame
+static uint8_t reference_dither(uint16_t value, uint8_t *error)
+{
+    uint32_t sum = value - value / 256 + *error;
+    *error = sum & 0xFF;
+    return sum >> 8;
+}
+
+TEST_CASE("led_strip dithered frames average to the 16 bit value", "[led_strip]")
+{
+    led_strip_t strip = capture_strip();
+    // 1.5, 0.25, an exact 8 bit value, full and off, in an odd number of components
+    const uint16_t rgb[5 * 3] = {
+        0x0180, 0x0040, 100 * 257, 0xFFFF, 0, 0x0180, 0x0040, 100 * 257, 0xFFFF, 0, 0x0180, 0x0040, 100 * 257, 0xFFFF, 0,
+    };
+    led_strip_dither_config_t config = { .strip = &strip, .num_leds = 5, .num_components = 3 };
+    led_strip_dither_handle_t dither = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_dither(&config, &dither));
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_dither_set_pixels(dither, 0, 5, rgb));
+
+    uint32_t sums[5 * 3] = { 0 };
+    s_sync_refreshes = 0;
+    for (int f = 0; f < 256; f++) {
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_dither_refresh_async(dither));
+        for (int i = 0; i < 5 * 3; i++) {
+            uint8_t out = s_captured[i];
+            sums[i] += out;
+            if (rgb[i] == 100 * 257 || rgb[i] == 0xFFFF || rgb[i] == 0) {
+                // exact values do not flicker
+                TEST_ASSERT_EQUAL(rgb[i] / 257, out);
+            } else {
+                // only the two closest levels
+                TEST_ASSERT_TRUE(out == rgb[i] >> 8 || out == (rgb[i] >> 8) + 1);
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL(256, s_sync_refreshes);
+    // 256 frames sum to the value in 8.8 bits, give or take the error left over
+    for (int i = 0; i < 5 * 3; i++) {
+        uint32_t scaled = rgb[i] - rgb[i] / 256;
+        TEST_ASSERT_TRUE(sums[i] + 1 > scaled && sums[i] < scaled + 1 + 1);
+    }
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_dither_set_pixels(dither, 4, 2, rgb));
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_dither_del(dither));
+
+    // R, G, B, W pixels go through set_pixels_rgbw
+    const uint16_t rgbw[2 * 4] = { 0xFFFF, 0, 200 * 257, 0x0080, 0, 0xFFFF, 1 * 257, 0x0080 };
+    config = (led_strip_dither_config_t) { .strip = &strip, .num_leds = 2, .num_components = 4 };
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_dither(&config, &dither));
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_dither_set_pixels(dither, 0, 2, rgbw));
+    uint32_t white = 0;
+    for (int f = 0; f < 16; f++) {
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_dither_refresh_async(dither));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(((uint8_t[]) { 255, 0, 200 }), &s_captured[0], 3);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(((uint8_t[]) { 0, 255, 1 }), &s_captured[4], 3);
+        white += s_captured[3] + s_captured[7];
+    }
+    // half a level on each of the 2 pixels, on 16 frames
+    TEST_ASSERT_EQUAL(16, white);
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_dither_del(dither));
+
+    config.num_components = 2;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_new_dither(&config, &dither));
+}
+
+TEST_CASE("led_strip dithering two components a word matches one at a time", "[led_strip]")
+{
+    led_strip_t strip = capture_strip();
+    static uint16_t rgb[300 * 3];
+    static uint8_t errors[300 * 3];
+    uint32_t seed = 1;
+    for (int i = 0; i < 300 * 3; i++) {
+        seed = seed * 1103515245 + 12345;
+        rgb[i] = seed >> 16;
+        errors[i] = i * 159;
+    }
+    led_strip_dither_config_t config = { .strip = &strip, .num_leds = 300, .num_components = 3 };
+    led_strip_dither_handle_t dither = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_dither(&config, &dither));
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_dither_set_pixels(dither, 0, 300, rgb));
+    for (int f = 0; f < 20; f++) {
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_dither_refresh_async(dither));
+        for (int i = 0; i < 300 * 3; i++) {
+            TEST_ASSERT_EQUAL(reference_dither(rgb[i], &errors[i]), s_captured[i]);
+        }
+    }
+    led_strip_dither_del(dither);
+}
+
+TEST_CASE("led_strip dithered refresh of 1000 LEDs", "[led_strip][bench]")
+{
+    led_strip_t strip = capture_strip();
+    static uint16_t rgb[BENCH_LEDS * 3];
+    static uint8_t errors[BENCH_LEDS * 3];
+    static uint8_t out[BENCH_LEDS * 3];
+    const int frames = 2000;
+    for (int i = 0; i < BENCH_LEDS * 3; i++) {
+        rgb[i] = i * 37;
+    }
+
+    // One component at a time, then the whole frame set and refreshed
+    int64_t start = now_ns();
+    for (int f = 0; f < frames; f++) {
+        rgb[0] = f;
+        for (int i = 0; i < BENCH_LEDS * 3; i++) {
+            out[i] = reference_dither(rgb[i], &errors[i]);
+        }
+        led_strip_set_pixels(&strip, 0, BENCH_LEDS, out);
+        led_strip_refresh_async(&strip);
+    }
+    int64_t scalar = (now_ns() - start) / frames;
+
+    led_strip_dither_config_t config = { .strip = &strip, .num_leds = BENCH_LEDS, .num_components = 3 };
+    led_strip_dither_handle_t dither = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_dither(&config, &dither));
+    start = now_ns();
+    for (int f = 0; f < frames; f++) {
+        rgb[0] = f;
+        led_strip_dither_set_pixels(dither, 0, 1, rgb);
+        led_strip_dither_refresh_async(dither);
+    }
+    int64_t swar = (now_ns() - start) / frames;
+
+    printf("led_strip dithered frame of %d LEDs, host time: one component at a time %.1f us, two a word %.1f us (%.1fx)\n",
+           BENCH_LEDS, scalar / 1e3, swar / 1e3, (double)scalar / swar);
+    led_strip_dither_del(dither);
+}
+
+TEST_CASE("led_strip mock records the frames the backends send", "[led_strip]")
+{
+    const led_color_component_format_t formats[] = {
+        LED_STRIP_COLOR_COMPONENT_FMT_GRB,
+        LED_STRIP_COLOR_COMPONENT_FMT_RGBW,
+    };
+    static uint8_t colors[20 * 4];
+    static uint8_t expected[20 * 4 * 3];
+    const uint32_t leds = 20;
+    for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+        bool rgbw = formats[f].format.num_components == 4;
+        led_strip_handle_t backends[2] = { new_rmt_strip(leds, formats[f]), new_spi_strip(leds, formats[f]) };
+        for (int spi = 0; spi <= 1; spi++) {
+            led_strip_mock_config_t config = {
+                .max_leds = leds,
+                .color_component_format = formats[f],
+                .max_frames = 2,
+                .spi_format = spi,
+            };
+            led_strip_handle_t mock = NULL;
+            TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_mock_device(&config, &mock));
+            fill_pattern(colors, sizeof(colors), f * 2 + spi);
+            led_strip_handle_t strips[2] = { backends[spi], mock };
+            for (int s = 0; s < 2; s++) {
+                if (rgbw) {
+                    TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixels_rgbw(strips[s], 0, leds, colors));
+                } else {
+                    TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixels(strips[s], 0, leds, colors));
+                }
+                TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(strips[s], 7, 1, 2, 3));
+            }
+            size_t size = refresh_and_capture(backends[spi], expected, sizeof(expected));
+            TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh(mock));
+            size_t mock_size = 0;
+            const uint8_t *frame = led_strip_mock_frame(mock, 0, &mock_size);
+            TEST_ASSERT_EQUAL(size, mock_size);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, frame, size);
+
+            // Cleared, and the frame before still kept
+            TEST_ASSERT_EQUAL(ESP_OK, led_strip_clear(mock));
+            TEST_ASSERT_EQUAL(2, led_strip_mock_frame_count(mock));
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, led_strip_mock_frame(mock, 1, NULL), size);
+            TEST_ASSERT_NULL(led_strip_mock_frame(mock, 2, NULL));
+            // 0 expands to 100 100 100 100 100 100 100 100
+            TEST_ASSERT_EQUAL(spi ? 0x24 : 0, led_strip_mock_frame(mock, 0, NULL)[size - 1]);
+            TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh(mock));
+            TEST_ASSERT_NULL(led_strip_mock_frame(mock, 2, NULL));
+            led_strip_del(mock);
+        }
+        led_strip_del(backends[0]);
+        led_strip_del(backends[1]);
+    }
+}
+
+static led_strip_handle_t new_palette_strip(bool spi, uint32_t leds, led_color_component_format_t fmt, uint8_t bits)
+{
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = 8,
+        .max_leds = leds,
+        .led_model = LED_MODEL_WS2812,
+        .color_component_format = fmt,
+        .palette_bits = bits,
+    };
+    led_strip_rmt_config_t rmt_config = { 0 };
+    led_strip_spi_config_t spi_config = { .spi_bus = SPI2_HOST, .flags.with_dma = true };
+    led_strip_handle_t strip = NULL;
+    if (spi) {
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_spi_device(&strip_config, &spi_config, &strip));
+    } else {
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_rmt_device(&strip_config, &rmt_config, &strip));
+    }
+    return strip;
+}
+
+// Sets the pixels of a color strip to the entries the indices point at
+static void set_expanded(led_strip_handle_t strip, const uint8_t *palette, const uint8_t *indices, uint32_t leds, uint8_t n)
+{
+    static uint8_t colors[64 * 4];
+    TEST_ASSERT_TRUE(leds <= 64);
+    for (uint32_t i = 0; i < leds; i++) {
+        memcpy(&colors[i * n], &palette[indices[i] * n], n);
+    }
+    if (n > 3) {
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixels_rgbw(strip, 0, leds, colors));
+    } else {
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixels(strip, 0, leds, colors));
+    }
+}
+
+TEST_CASE("led_strip palette strips send the colors of their entries", "[led_strip]")
+{
+    // Odd, so that the last 4 bit index is alone in its byte, and longer than the encoder chunk
+    enum { LEDS = 37 };
+    static uint8_t palette[256 * 4];
+    static uint8_t indices[LEDS];
+    static uint8_t expected[LEDS * 4 * 3];
+    static uint8_t frame[LEDS * 4 * 3];
+    static uint8_t lut[256];
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_make_color_lut(lut, 2.2f, 200));
+    const led_color_component_format_t formats[] = {
+        LED_STRIP_COLOR_COMPONENT_FMT_GRB,
+        LED_STRIP_COLOR_COMPONENT_FMT_GRBW,
+    };
+    const uint8_t bits[] = { 4, 8 };
+    for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+        uint8_t n = formats[f].format.num_components;
+        for (size_t b = 0; b < sizeof(bits) / sizeof(bits[0]); b++) {
+            uint32_t entries = 1 << bits[b];
+            for (int spi = 0; spi <= 1; spi++) {
+                led_strip_handle_t ref = spi ? new_spi_strip(LEDS, formats[f]) : new_rmt_strip(LEDS, formats[f]);
+                led_strip_handle_t strip = new_palette_strip(spi, LEDS, formats[f], bits[b]);
+                fill_pattern(palette, entries * n, (uint8_t)(f * 4 + b * 2 + spi));
+                for (uint32_t i = 0; i < LEDS; i++) {
+                    indices[i] = (uint8_t)((i * 7 + 3) % entries);
+                }
+                TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_palette(strip, 0, entries, palette));
+                TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixels_index(strip, 0, LEDS, indices));
+                if (!spi) {
+                    TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_color_lut(strip, lut));
+                    TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_color_lut(ref, lut));
+                }
+                set_expanded(ref, palette, indices, LEDS, n);
+                size_t size = refresh_and_capture(ref, expected, sizeof(expected));
+                TEST_ASSERT_EQUAL(size, refresh_and_capture(strip, frame, sizeof(frame)));
+                TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, frame, size);
+
+                // One pixel, then a few entries, both neighbours of a 4 bit pair kept
+                indices[LEDS - 1] = 1;
+                TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel_index(strip, LEDS - 1, 1));
+                indices[10] = 2;
+                TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixels_index(strip, 10, 1, &indices[10]));
+                fill_pattern(&palette[n], 3 * n, 99);
+                TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_palette(strip, 1, 3, &palette[n]));
+                set_expanded(ref, palette, indices, LEDS, n);
+                size = refresh_and_capture(ref, expected, sizeof(expected));
+                TEST_ASSERT_EQUAL(size, refresh_and_capture(strip, frame, sizeof(frame)));
+                TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, frame, size);
+
+                // Cleared to the first entry
+                TEST_ASSERT_EQUAL(ESP_OK, led_strip_clear(strip));
+                memset(indices, 0, sizeof(indices));
+                set_expanded(ref, palette, indices, LEDS, n);
+                size = refresh_and_capture(ref, expected, sizeof(expected));
+                size_t tx_size = 0;
+                const uint8_t *tx = led_strip_shim_last_tx(&tx_size);
+                TEST_ASSERT_EQUAL(size, tx_size);
+                TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, tx, size);
+                led_strip_del(strip);
+                led_strip_del(ref);
+            }
+        }
+    }
+}
+
+TEST_CASE("led_strip palette is used from the next refresh", "[led_strip]")
+{
+    const uint8_t red[3] = { 255, 0, 0 };
+    const uint8_t blue[3] = { 0, 0, 255 };
+    for (int spi = 0; spi <= 1; spi++) {
+        led_strip_handle_t strip = new_palette_strip(spi, 2, LED_STRIP_COLOR_COMPONENT_FMT_GRB, 4);
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_palette(strip, 0, 1, red));
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh_async(strip));
+        // Changed while the frame is in flight
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_palette(strip, 0, 1, blue));
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh_wait_done(strip, -1));
+        uint8_t wire[3 * SPI_BYTES_PER_COLOR_BYTE] = { 0 };
+        size_t size = 0;
+        const uint8_t *tx = led_strip_shim_last_tx(&size);
+        if (spi) {
+            led_strip_spi_encode_pixel((const uint8_t[]) { 0, 255, 0 }, 3, wire);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(wire, tx, 3 * SPI_BYTES_PER_COLOR_BYTE);
+        } else {
+            const uint8_t grb[3] = { 0, 255, 0 };
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(grb, tx, 3);
+        }
+
+        // Only the palette changed, the whole strip goes out again in the new color
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh(strip));
+        tx = led_strip_shim_last_tx(&size);
+        TEST_ASSERT_EQUAL(2 * 3 * (spi ? SPI_BYTES_PER_COLOR_BYTE : 1), size);
+        if (spi) {
+            led_strip_spi_encode_pixel((const uint8_t[]) { 0, 0, 255 }, 3, wire);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(wire, tx + 3 * SPI_BYTES_PER_COLOR_BYTE, 3 * SPI_BYTES_PER_COLOR_BYTE);
+        } else {
+            const uint8_t grb[6] = { 0, 0, 255, 0, 0, 255 };
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(grb, tx, 6);
+        }
+        led_strip_del(strip);
+    }
+}
+
+TEST_CASE("led_strip palette checks the mode and the range", "[led_strip]")
+{
+    const uint8_t colors[17 * 3] = { 0 };
+    const uint8_t indices[2] = { 15, 16 };
+    for (int spi = 0; spi <= 1; spi++) {
+        led_strip_handle_t strip = new_palette_strip(spi, 4, LED_STRIP_COLOR_COMPONENT_FMT_GRB, 4);
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, led_strip_set_pixel(strip, 0, 1, 2, 3));
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, led_strip_set_pixels(strip, 0, 1, colors));
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_set_palette(strip, 0, 17, colors));
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_set_palette(strip, 16, 1, colors));
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_palette(strip, 15, 1, colors));
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixels_index(strip, 0, 1, indices));
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_set_pixels_index(strip, 0, 2, indices));
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_set_pixels_index(strip, 3, 2, indices));
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_set_pixel_index(strip, 4, 0));
+        led_strip_del(strip);
+
+        strip = spi ? new_spi_strip(4, LED_STRIP_COLOR_COMPONENT_FMT_GRB) : new_rmt_strip(4, LED_STRIP_COLOR_COMPONENT_FMT_GRB);
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, led_strip_set_palette(strip, 0, 1, colors));
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, led_strip_set_pixel_index(strip, 0, 0));
+        led_strip_del(strip);
+    }
+
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = 8,
+        .max_leds = 4,
+        .led_model = LED_MODEL_WS2812,
+        .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB,
+        .palette_bits = 5,
+    };
+    led_strip_rmt_config_t rmt_config = { 0 };
+    led_strip_spi_config_t spi_config = { .spi_bus = SPI2_HOST, .flags.with_dma = true };
+    led_strip_handle_t strip = NULL;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_new_rmt_device(&strip_config, &rmt_config, &strip));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_new_spi_device(&strip_config, &spi_config, &strip));
+
+    // The mock keeps colors only
+    led_strip_mock_config_t mock_config = {
+        .max_leds = 4,
+        .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB,
+        .max_frames = 1,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_mock_device(&mock_config, &strip));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, led_strip_set_palette(strip, 0, 1, colors));
+    led_strip_del(strip);
+}
+
+TEST_CASE("led_strip palette cycling of 1000 LEDs", "[led_strip][bench]")
+{
+    static uint8_t palette[256 * 3];
+    static uint8_t indices[BENCH_LEDS];
+    static uint8_t colors[BENCH_LEDS * 3];
+    const int frames = 100;
+    for (uint32_t i = 0; i < BENCH_LEDS; i++) {
+        indices[i] = (uint8_t)(i * 256 / BENCH_LEDS);
+    }
+    fill_pattern(palette, sizeof(palette), 0);
+
+    // The application rotates the colors of its framebuffer, or of the palette only: 0 rewrite, 1 and 2 palettes
+    const uint8_t bits[] = { 0, 8, 4 };
+    for (int spi = 0; spi <= 1; spi++) {
+        int64_t set[3];
+        int64_t refresh[3];
+        double bytes_per_pixel[3];
+        for (int b = 0; b < 3; b++) {
+            uint32_t entries = 1 << bits[b];
+            led_strip_handle_t strip = NULL;
+            if (bits[b]) {
+                strip = new_palette_strip(spi, BENCH_LEDS, LED_STRIP_COLOR_COMPONENT_FMT_GRB, bits[b]);
+                for (uint32_t i = 0; i < BENCH_LEDS; i++) {
+                    colors[i] = indices[i] % entries;
+                }
+                led_strip_set_pixels_index(strip, 0, BENCH_LEDS, colors);
+                bytes_per_pixel[b] = (bits[b] / 8.0 * BENCH_LEDS + entries * 3) / BENCH_LEDS;
+            } else {
+                strip = spi ? new_streaming_spi_strip(BENCH_LEDS, LED_STRIP_COLOR_COMPONENT_FMT_GRB)
+                        : new_rmt_strip(BENCH_LEDS, LED_STRIP_COLOR_COMPONENT_FMT_GRB);
+                bytes_per_pixel[b] = 3;
+            }
+            set[b] = 0;
+            refresh[b] = 0;
+            for (int f = 0; f < frames; f++) {
+                int64_t start = now_ns();
+                if (bits[b]) {
+                    uint32_t shift = f % entries;
+                    led_strip_set_palette(strip, 0, entries - shift, &palette[shift * 3]);
+                    led_strip_set_palette(strip, entries - shift, shift, palette);
+                } else {
+                    for (uint32_t i = 0; i < BENCH_LEDS; i++) {
+                        memcpy(&colors[i * 3], &palette[(uint8_t)(indices[i] + f) * 3], 3);
+                    }
+                    led_strip_set_pixels(strip, 0, BENCH_LEDS, colors);
+                }
+                int64_t end = now_ns();
+                led_strip_refresh(strip);
+                set[b] += end - start;
+                refresh[b] += now_ns() - end;
+            }
+            led_strip_del(strip);
+        }
+        printf("led_strip %s color cycling of %d LEDs, set + refresh per frame: "
+               "rewrite %.1f + %.1f us at %.2f bytes per pixel, 256 entry palette %.1f + %.1f us at %.2f, "
+               "16 entry palette %.1f + %.1f us at %.2f\n", spi ? "SPI" : "RMT", BENCH_LEDS,
+               set[0] / 1e3 / frames, refresh[0] / 1e3 / frames, bytes_per_pixel[0],
+               set[1] / 1e3 / frames, refresh[1] / 1e3 / frames, bytes_per_pixel[1],
+               set[2] / 1e3 / frames, refresh[2] / 1e3 / frames, bytes_per_pixel[2]);
+    }
+}
+
+// Pixels with long repeats, single pixels and long literal stretches, different for every frame
+static void fill_show_frame(uint8_t *pixels, uint32_t leds, uint8_t n, uint32_t frame)
+{
+    for (uint32_t i = 0; i < leds; i++) {
+        uint32_t segment = (i + frame * 3) / 50 % 4;
+        for (uint8_t c = 0; c < n; c++) {
+            pixels[i * n + c] = segment == 0 ? (uint8_t)(frame + c) : segment == 2 ? (uint8_t)(i * 37 + c * 11 + frame) : 0;
+        }
+    }
+}
+
+// Header and frames of a show, returns its size
+static size_t pack_show(uint8_t *show_data, size_t size, uint32_t leds, uint8_t n, uint32_t frames,
+                        void (*fill)(uint8_t *, uint32_t, uint8_t, uint32_t))
+{
+    static uint8_t pixels[1000 * 4];
+    TEST_ASSERT_TRUE(leds <= 1000);
+    led_strip_rle_show_t show = {
+        .num_components = n,
+        .num_leds = leds,
+        .num_frames = frames,
+        .frame_period_us = 20000,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_rle_write_header(&show, show_data));
+    size_t offset = LED_STRIP_RLE_HEADER_SIZE;
+    for (uint32_t f = 0; f < frames; f++) {
+        fill(pixels, leds, n, f);
+        size_t frame_size = 0;
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_rle_pack_frame(pixels, leds, n, show_data + offset, size - offset, &frame_size));
+        TEST_ASSERT_TRUE(frame_size <= LED_STRIP_RLE_FRAME_MAX_SIZE(leds, n));
+        offset += frame_size;
+    }
+    return offset;
+}
+
+TEST_CASE("led_strip RLE frames decode to the packed pixels", "[led_strip]")
+{
+    enum { LEDS = 300, FRAMES = 6 };
+    static uint8_t show_data[LED_STRIP_RLE_HEADER_SIZE + FRAMES * LED_STRIP_RLE_FRAME_MAX_SIZE(LEDS, 4)];
+    static uint8_t expected[LEDS * 4];
+    static uint8_t decoded[LEDS * 4];
+    for (uint8_t n = 3; n <= 4; n++) {
+        size_t size = pack_show(show_data, sizeof(show_data), LEDS, n, FRAMES, fill_show_frame);
+        // Half the pixels are in repeat runs
+        TEST_ASSERT_TRUE(size < LED_STRIP_RLE_HEADER_SIZE + FRAMES * (LEDS * n * 2u / 3));
+        // Followed by the rest of a partition
+        memset(show_data + size, 0xFF, 64);
+        led_strip_rle_show_t show;
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_rle_open(show_data, size + 64, &show));
+        TEST_ASSERT_EQUAL(n, show.num_components);
+        TEST_ASSERT_EQUAL(LEDS, show.num_leds);
+        TEST_ASSERT_EQUAL(FRAMES, show.num_frames);
+        TEST_ASSERT_EQUAL(20000, show.frame_period_us);
+        TEST_ASSERT_EQUAL(size - LED_STRIP_RLE_HEADER_SIZE, show.frames_size);
+
+        size_t offset = 0;
+        led_strip_rle_frame_t frame;
+        for (uint32_t f = 0; f < FRAMES; f++) {
+            TEST_ASSERT_TRUE(led_strip_rle_next_frame(&show, &offset, &frame));
+            fill_show_frame(expected, LEDS, n, f);
+            // By odd steps, so that runs are split
+            led_strip_rle_decoder_t decoder;
+            led_strip_rle_decoder_init(&decoder, &frame);
+            uint32_t pixels = 0;
+            uint32_t count;
+            while ((count = led_strip_rle_decode(&decoder, n, decoded + pixels * n, 7 + f)) != 0) {
+                pixels += count;
+            }
+            TEST_ASSERT_EQUAL(LEDS, pixels);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, decoded, LEDS * n);
+        }
+        TEST_ASSERT_FALSE(led_strip_rle_next_frame(&show, &offset, &frame));
+    }
+}
+
+TEST_CASE("led_strip RLE show checks its frames", "[led_strip]")
+{
+    static uint8_t show_data[LED_STRIP_RLE_HEADER_SIZE + 2 * LED_STRIP_RLE_FRAME_MAX_SIZE(20, 3)];
+    size_t size = pack_show(show_data, sizeof(show_data), 20, 3, 2, fill_show_frame);
+    led_strip_rle_show_t show;
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_rle_open(show_data, size, &show));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, led_strip_rle_open(show_data, size - 1, &show));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_VERSION, led_strip_rle_open(show_data, LED_STRIP_RLE_HEADER_SIZE - 1, &show));
+    show_data[4] = LED_STRIP_RLE_VERSION + 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_VERSION, led_strip_rle_open(show_data, size, &show));
+    show_data[4] = LED_STRIP_RLE_VERSION;
+    // One LED more in the header than in the frames
+    show_data[6]++;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, led_strip_rle_open(show_data, size, &show));
+    show_data[6]--;
+
+    uint8_t pixels[3 * 3] = { 0 };
+    uint8_t frame[LED_STRIP_RLE_FRAME_MAX_SIZE(3, 3)];
+    size_t frame_size = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, led_strip_rle_pack_frame(pixels, 3, 3, frame, 4 + 3, &frame_size));
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_rle_pack_frame(pixels, 3, 3, frame, 4 + 4, &frame_size));
+    TEST_ASSERT_EQUAL(4 + 1 + 3, frame_size);
+    TEST_ASSERT_EQUAL_HEX8(0x82, frame[4]);
+}
+
+TEST_CASE("led_strip RMT encoder sends the decoded runs of a show", "[led_strip]")
+{
+    enum { LEDS = 200, FRAMES = 3 };
+    static uint8_t show_data[LED_STRIP_RLE_HEADER_SIZE + FRAMES * LED_STRIP_RLE_FRAME_MAX_SIZE(LEDS, 4)];
+    static uint8_t wire[LEDS * 4];
+    static uint8_t colors[LEDS * 4];
+    static uint8_t expected[LEDS * 4];
+    static uint8_t frame_bytes[(LEDS + 10) * 4];
+    static uint8_t lut[256];
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_make_color_lut(lut, 2.2f, 200));
+    const led_color_component_format_t formats[] = {
+        LED_STRIP_COLOR_COMPONENT_FMT_GRB,
+        LED_STRIP_COLOR_COMPONENT_FMT_GRBW,
+    };
+    for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+        uint8_t n = formats[f].format.num_components;
+        size_t size = pack_show(show_data, sizeof(show_data), LEDS, n, FRAMES, fill_show_frame);
+        led_strip_rle_show_t show;
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_rle_open(show_data, size, &show));
+        // A strip longer than the show, with pixels of its own, and the reference set pixel by pixel
+        led_strip_handle_t strip = new_rmt_strip(LEDS + 10, formats[f]);
+        led_strip_handle_t ref = new_rmt_strip(LEDS, formats[f]);
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(strip, LEDS + 9, 1, 2, 3));
+
+        size_t offset = 0;
+        led_strip_rle_frame_t frame;
+        uint32_t i = 0;
+        for (; led_strip_rle_next_frame(&show, &offset, &frame); i++) {
+            const uint8_t *table = i == 1 ? lut : NULL;
+            TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_color_lut(strip, table));
+            TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh_rle_async(strip, &show, &frame));
+            TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh_wait_done(strip, -1));
+            size_t tx_size = 0;
+            const uint8_t *tx = led_strip_shim_last_tx(&tx_size);
+            TEST_ASSERT_EQUAL(LEDS * n, tx_size);
+            memcpy(frame_bytes, tx, tx_size);
+
+            // The show is in wire order: back to R, G, B(, W) for the reference
+            fill_show_frame(wire, LEDS, n, i);
+            for (uint32_t p = 0; p < LEDS; p++) {
+                colors[p * n + 0] = wire[p * n + formats[f].format.r_pos];
+                colors[p * n + 1] = wire[p * n + formats[f].format.g_pos];
+                colors[p * n + 2] = wire[p * n + formats[f].format.b_pos];
+                if (n > 3) {
+                    colors[p * n + 3] = wire[p * n + formats[f].format.w_pos];
+                }
+            }
+            if (n > 3) {
+                TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixels_rgbw(ref, 0, LEDS, colors));
+            } else {
+                TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixels(ref, 0, LEDS, colors));
+            }
+            TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_color_lut(ref, table));
+            TEST_ASSERT_EQUAL(LEDS * n, refresh_and_capture(ref, expected, sizeof(expected)));
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, frame_bytes, LEDS * n);
+        }
+        TEST_ASSERT_EQUAL(FRAMES, i);
+
+        // The pixels of the strip were left alone
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_color_lut(strip, NULL));
+        TEST_ASSERT_EQUAL((LEDS + 10) * n, refresh_and_capture(strip, frame_bytes, sizeof(frame_bytes)));
+        TEST_ASSERT_EQUAL(2, frame_bytes[(LEDS + 9) * n + formats[f].format.g_pos]);
+        TEST_ASSERT_EQUAL(0, frame_bytes[0]);
+        led_strip_del(ref);
+        led_strip_del(strip);
+    }
+}
+
+TEST_CASE("led_strip RLE show must fit the strip", "[led_strip]")
+{
+    static uint8_t show_data[LED_STRIP_RLE_HEADER_SIZE + LED_STRIP_RLE_FRAME_MAX_SIZE(20, 3)];
+    size_t size = pack_show(show_data, sizeof(show_data), 20, 3, 1, fill_show_frame);
+    led_strip_rle_show_t show;
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_rle_open(show_data, size, &show));
+    size_t offset = 0;
+    led_strip_rle_frame_t frame;
+    TEST_ASSERT_TRUE(led_strip_rle_next_frame(&show, &offset, &frame));
+
+    led_strip_handle_t strip = new_rmt_strip(19, LED_STRIP_COLOR_COMPONENT_FMT_GRB);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_refresh_rle_async(strip, &show, &frame));
+    led_strip_del(strip);
+    strip = new_rmt_strip(20, LED_STRIP_COLOR_COMPONENT_FMT_GRBW);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_refresh_rle_async(strip, &show, &frame));
+    led_strip_del(strip);
+    strip = new_palette_strip(false, 20, LED_STRIP_COLOR_COMPONENT_FMT_GRB, 8);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, led_strip_refresh_rle_async(strip, &show, &frame));
+    led_strip_del(strip);
+    strip = new_spi_strip(20, LED_STRIP_COLOR_COMPONENT_FMT_GRB);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, led_strip_refresh_rle_async(strip, &show, &frame));
+    led_strip_del(strip);
+}
+
+// A comet over a dark strip, the usual content of a show
+static void fill_comet_frame(uint8_t *pixels, uint32_t leds, uint8_t n, uint32_t frame)
+{
+    memset(pixels, 0, leds * n);
+    for (uint32_t i = 0; i < 16; i++) {
+        uint32_t p = (frame * 7 + i) % leds;
+        memset(&pixels[p * n], (uint8_t)(i * 16 + 15), n);
+    }
+}
+
+TEST_CASE("led_strip RLE show of 1000 LEDs", "[led_strip][bench]")
+{
+    enum { FRAMES = 100 };
+    static uint8_t show_data[LED_STRIP_RLE_HEADER_SIZE + FRAMES * LED_STRIP_RLE_FRAME_MAX_SIZE(BENCH_LEDS, 3)];
+    static uint8_t pixels[BENCH_LEDS * 3];
+    size_t size = pack_show(show_data, sizeof(show_data), BENCH_LEDS, 3, FRAMES, fill_comet_frame);
+    led_strip_rle_show_t show;
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_rle_open(show_data, size, &show));
+    led_strip_handle_t strip = new_rmt_strip(BENCH_LEDS, LED_STRIP_COLOR_COMPONENT_FMT_RGB);
+
+    // Unpacked into the strip by the application, or decoded by the encoder
+    int64_t start = now_ns();
+    for (int f = 0; f < FRAMES; f++) {
+        fill_comet_frame(pixels, BENCH_LEDS, 3, f);
+        led_strip_set_pixels(strip, 0, BENCH_LEDS, pixels);
+        led_strip_refresh(strip);
+    }
+    int64_t unpacked = (now_ns() - start) / FRAMES;
+
+    size_t offset = 0;
+    led_strip_rle_frame_t frame;
+    start = now_ns();
+    while (led_strip_rle_next_frame(&show, &offset, &frame)) {
+        led_strip_refresh_rle_async(strip, &show, &frame);
+        led_strip_refresh_wait_done(strip, -1);
+    }
+    int64_t decoded = (now_ns() - start) / FRAMES;
+
+    printf("led_strip RLE show of %d LEDs: %u bytes per frame instead of %d, "
+           "set_pixels and refresh %.1f us, refresh from the runs %.1f us per frame\n",
+           BENCH_LEDS, (unsigned)(show.frames_size / FRAMES), BENCH_LEDS * 3, unpacked / 1e3, decoded / 1e3);
+    led_strip_del(strip);
+}
@@ -0,0 +1,117 @@
+/* Throughput of the led_strip pixel paths, per backend and strip length
+
+   Every case of the table prints one line "led_strip bench <backend> <op>
+   <leds> LEDs: <ns> ns/pixel <M> Mpixels/s", to be collected from the
+   console and compared from one build to the next. A refresh changes the
+   first and last pixels, so that it sends the whole strip. The rmt and spi
+   backends run on the driver shims of led_strip_shim.c, where a refresh
+   costs what the backend and its encoder do on the host, and mock and
+   mock-spi on the mock of led_strip_mock.c, which keeps the pixels in the
+   RMT byte order or expands them like the SPI backend when refreshed.
+*/
+#include <stdio.h>
+#include <time.h>
+#include "unity.h"
+#include "led_strip.h"
+#include "led_strip_mock.h"
+
+// Pixels handled by each measure, whatever the length of the strip
+#define BENCH_PIXELS 2000000
+
+typedef enum {
+    BENCH_RMT,
+    BENCH_SPI,
+    BENCH_MOCK,
+    BENCH_MOCK_SPI,
+    BENCH_BACKENDS,
+} bench_backend_t;
+
+typedef enum {
+    BENCH_SET_PIXEL,
+    BENCH_SET_PIXEL_HSV,
+    BENCH_CLEAR,
+    BENCH_REFRESH,
+    BENCH_OPS,
+} bench_op_t;
+
+static const char *const s_backend_names[BENCH_BACKENDS] = { "rmt", "spi", "mock", "mock-spi" };
+static const char *const s_op_names[BENCH_OPS] = { "set_pixel", "set_pixel_hsv", "clear", "refresh" };
+
+static int64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static led_strip_handle_t bench_new_strip(bench_backend_t backend, uint32_t leds)
+{
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = 8,
+        .max_leds = leds,
+        .led_model = LED_MODEL_WS2812,
+    };
+    led_strip_rmt_config_t rmt_config = { 0 };
+    led_strip_spi_config_t spi_config = { .spi_bus = SPI2_HOST };
+    led_strip_mock_config_t mock_config = { .max_leds = leds, .spi_format = backend == BENCH_MOCK_SPI };
+    led_strip_handle_t strip = NULL;
+    switch (backend) {
+    case BENCH_RMT:
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_rmt_device(&strip_config, &rmt_config, &strip));
+        break;
+    case BENCH_SPI:
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_spi_device(&strip_config, &spi_config, &strip));
+        break;
+    default:
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_mock_device(&mock_config, &strip));
+        break;
+    }
+    return strip;
+}
+
+// Nanoseconds per pixel of an operation over the whole strip
+static double bench_op(led_strip_handle_t strip, bench_op_t op, uint32_t leds)
+{
+    uint32_t rounds = BENCH_PIXELS / leds;
+    int64_t start = bench_now_ns();
+    for (uint32_t r = 0; r < rounds; r++) {
+        switch (op) {
+        case BENCH_SET_PIXEL:
+            for (uint32_t i = 0; i < leds; i++) {
+                led_strip_set_pixel(strip, i, r, i, r + i);
+            }
+            break;
+        case BENCH_SET_PIXEL_HSV:
+            for (uint32_t i = 0; i < leds; i++) {
+                led_strip_set_pixel_hsv(strip, i, (r + i) % 360, 255, 128);
+            }
+            break;
+        case BENCH_CLEAR:
+            led_strip_clear(strip);
+            break;
+        default:
+            // the SPI backend only sends up to the last changed pixel
+            led_strip_set_pixel(strip, 0, r, 0, 0);
+            led_strip_set_pixel(strip, leds - 1, r, 0, 0);
+            led_strip_refresh(strip);
+            break;
+        }
+    }
+    return (double)(bench_now_ns() - start) / ((double)rounds * leds);
+}
+
+TEST_CASE("led_strip throughput from 10 to 10000 LEDs", "[led_strip][bench]")
+{
+    const uint32_t lengths[] = { 10, 100, 1000, 10000 };
+    for (int b = 0; b < BENCH_BACKENDS; b++) {
+        for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+            led_strip_handle_t strip = bench_new_strip(b, lengths[l]);
+            for (int op = 0; op < BENCH_OPS; op++) {
+                double ns = bench_op(strip, op, lengths[l]);
+                printf("led_strip bench %-8s %-13s %5u LEDs: %7.2f ns/pixel %8.2f Mpixels/s\n",
+                       s_backend_names[b], s_op_names[op], (unsigned)lengths[l], ns, 1e3 / ns);
+            }
+            led_strip_del(strip);
+        }
+    }
+}
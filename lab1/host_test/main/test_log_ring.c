@@ -0,0 +1,133 @@
+/* Tests for the deferred log ring
+*/
+#include <stdio.h>
+#include <inttypes.h>
+#include <time.h>
+#include "unity.h"
+#include "log_ring.h"
+
+static log_ring_t s_ring;
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static log_record_t record(uint32_t time_ms, uint32_t arg)
+{
+    log_record_t rec = {
+        .time_ms = time_ms,
+        .tag = "test",
+        .fmt = "value %" PRIu32,
+        .args = { arg },
+    };
+    return rec;
+}
+
+TEST_CASE("log ring keeps records in order across the wrap", "[log_ring]")
+{
+    log_ring_init(&s_ring);
+    log_record_t rec;
+    TEST_ASSERT_EQUAL(0, log_ring_count(&s_ring));
+    TEST_ASSERT_FALSE(log_ring_get(&s_ring, &rec));
+
+    // Interleaved puts and gets move the indexes several times around the ring
+    uint32_t next_in = 0, next_out = 0;
+    for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < LOG_RING_SIZE / 2 + 3; i++, next_in++) {
+            log_record_t in = record(next_in, next_in * 3);
+            TEST_ASSERT_TRUE(log_ring_put(&s_ring, &in));
+        }
+        while (log_ring_get(&s_ring, &rec)) {
+            TEST_ASSERT_EQUAL(next_out, rec.time_ms);
+            TEST_ASSERT_EQUAL(next_out * 3, rec.args[0]);
+            next_out++;
+        }
+    }
+    TEST_ASSERT_EQUAL(next_in, next_out);
+    TEST_ASSERT_EQUAL(0, log_ring_count(&s_ring));
+    TEST_ASSERT_EQUAL(0, s_ring.dropped);
+}
+
+TEST_CASE("log ring drops and counts records when full", "[log_ring]")
+{
+    log_ring_init(&s_ring);
+    for (uint32_t i = 0; i < LOG_RING_SIZE + 5; i++) {
+        log_record_t in = record(i, i);
+        TEST_ASSERT_EQUAL(i < LOG_RING_SIZE, log_ring_put(&s_ring, &in));
+    }
+    TEST_ASSERT_EQUAL(LOG_RING_SIZE, log_ring_count(&s_ring));
+    TEST_ASSERT_EQUAL(5, s_ring.dropped);
+
+    // The oldest records are kept, a freed slot takes new ones again
+    log_record_t rec;
+    TEST_ASSERT_TRUE(log_ring_get(&s_ring, &rec));
+    TEST_ASSERT_EQUAL(0, rec.time_ms);
+    log_record_t in = record(1000, 0);
+    TEST_ASSERT_TRUE(log_ring_put(&s_ring, &in));
+    for (uint32_t i = 1; i < LOG_RING_SIZE; i++) {
+        TEST_ASSERT_TRUE(log_ring_get(&s_ring, &rec));
+        TEST_ASSERT_EQUAL(i, rec.time_ms);
+    }
+    TEST_ASSERT_TRUE(log_ring_get(&s_ring, &rec));
+    TEST_ASSERT_EQUAL(1000, rec.time_ms);
+}
+
+TEST_CASE("log ring formats the recorded arguments", "[log_ring]")
+{
+    static const char *const name = "BLINKING";
+    log_record_t rec = {
+        .fmt = "state %s after %" PRIu32 " ms, led %d",
+        .args = { (uint32_t)(uintptr_t)name, 500, 1 },
+    };
+    char buf[64];
+    // On the host a pointer does not fit a word, only check the integer arguments there
+    if (sizeof(void *) == sizeof(uint32_t)) {
+        log_ring_format(&rec, buf, sizeof(buf));
+        TEST_ASSERT_EQUAL_STRING("state BLINKING after 500 ms, led 1", buf);
+    }
+    rec.fmt = "press %" PRIu32 " ms, led %d";
+    rec.args[0] = 750;
+    rec.args[1] = 0;
+    log_ring_format(&rec, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING("press 750 ms, led 0", buf);
+}
+
+TEST_CASE("log ring put against formatting the line", "[log_ring][bench]")
+{
+    const int rounds = 200000;
+    log_ring_init(&s_ring);
+    log_record_t rec;
+    int64_t start = now_ns();
+    for (int i = 0; i < rounds; i++) {
+        log_record_t in = {
+            .time_ms = i,
+            .tag = "C",
+            .fmt = "Long press %" PRIu32 " ms, blinking %d",
+            .args = { i, i & 1 },
+        };
+        log_ring_put(&s_ring, &in);
+        // Drained outside the hot path on the target, here only to keep the ring from filling up
+        if (log_ring_count(&s_ring) == LOG_RING_SIZE) {
+            while (log_ring_get(&s_ring, &rec)) {
+            }
+        }
+    }
+    int64_t deferred = now_ns() - start;
+    TEST_ASSERT_EQUAL(0, s_ring.dropped);
+
+    // What ESP_LOGI formats before the UART, which is not counted
+    char line[96];
+    uint32_t sink = 0;
+    start = now_ns();
+    for (int i = 0; i < rounds; i++) {
+        sink += snprintf(line, sizeof(line), "I (%" PRIu32 ") %s: Long press %" PRIu32 " ms, blinking %d\n",
+                         (uint32_t)i, "C", (uint32_t)i, i & 1);
+    }
+    int64_t formatted = now_ns() - start;
+
+    printf("log record: ring put %.1f ns, formatted line %.1f ns, %.1fx (sink %" PRIu32 ")\n",
+           (double)deferred / rounds, (double)formatted / rounds, (double)formatted / deferred, sink);
+}
@@ -0,0 +1,10 @@
+/* Entry point of the lab1 host tests
+*/
+#include "unity.h"
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    unity_run_all_tests();
+    UNITY_END();
+}
@@ -0,0 +1,208 @@
+/* Replay of the lab1 cases A.c, B.c and C_improved.c over button traces
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "unity.h"
+#include "replay.h"
+#include "button_cases.h"
+
+#define MS(ms) ((int64_t)(ms) * 1000)
+
+// app_main of each case, renamed by CMakeLists.txt
+void case_a_main(void);
+void case_b_main(void);
+void case_c_main(void);
+
+static replay_trace_t s_trace;
+static replay_timeline_t s_led;
+static replay_timeline_t s_expected;
+
+static void expect_changes(const replay_timeline_t *expected, const replay_timeline_t *actual)
+{
+    TEST_ASSERT_EQUAL(expected->num_changes, actual->num_changes);
+    for (size_t i = 0; i < expected->num_changes; i++) {
+        TEST_ASSERT_EQUAL(expected->changes[i].time_us, actual->changes[i].time_us);
+        TEST_ASSERT_EQUAL(expected->changes[i].level, actual->changes[i].level);
+    }
+}
+
+static void expect_led(size_t i, int64_t time_ms, uint8_t level)
+{
+    TEST_ASSERT_TRUE(i < s_led.num_changes);
+    TEST_ASSERT_EQUAL(MS(time_ms), s_led.changes[i].time_us);
+    TEST_ASSERT_EQUAL(level, s_led.changes[i].level);
+}
+
+TEST_CASE("replay parses csv traces", "[replay]")
+{
+    TEST_ASSERT_TRUE(replay_trace_parse_csv(&s_trace, "# press\n100,1\n 100.5, 0 # bounce\n\n101,1\n300,0\n2000,end\n"));
+    TEST_ASSERT_EQUAL(4, s_trace.num_edges);
+    TEST_ASSERT_EQUAL(100500, s_trace.edges[1].time_us);
+    TEST_ASSERT_EQUAL(0, s_trace.edges[1].level);
+    TEST_ASSERT_EQUAL(MS(2000), s_trace.end_us);
+
+    TEST_ASSERT_FALSE(replay_trace_parse_csv(&s_trace, "100,1\n50,0\n"));
+    TEST_ASSERT_FALSE(replay_trace_parse_csv(&s_trace, "100,2\n"));
+    TEST_ASSERT_FALSE(replay_trace_parse_csv(&s_trace, "100;1\n"));
+    TEST_ASSERT_FALSE(replay_trace_parse_csv(&s_trace, "100,1\n50,end\n"));
+}
+
+TEST_CASE("replay case A toggles on debounced presses", "[replay][case_a]")
+{
+    // Recorded on the board: second press bounces for 3 ms
+    TEST_ASSERT_TRUE(replay_trace_parse_csv(&s_trace,
+                     "120,1\n310,0\n"
+                     "900,1\n901,0\n902.5,1\n903,0\n903.4,1\n1250,0\n"
+                     "1280,1\n1500,0\n"));
+    TEST_ASSERT_TRUE(replay_run(case_a_main, &s_trace, &s_led));
+    TEST_ASSERT_EQUAL(3, s_led.num_changes);
+    expect_led(0, 120, 1);
+    expect_led(1, 900, 0);
+    expect_led(2, 1280, 1);
+}
+
+TEST_CASE("replay case B toggles at the long press threshold", "[replay][case_b]")
+{
+    replay_trace_init(&s_trace);
+    TEST_ASSERT_TRUE(replay_trace_press(&s_trace, 0, 499, 0));
+    TEST_ASSERT_TRUE(replay_trace_press(&s_trace, 1000, 500, 0));
+    TEST_ASSERT_TRUE(replay_trace_press(&s_trace, 3000, 2000, 2));
+    TEST_ASSERT_TRUE(replay_run(case_b_main, &s_trace, &s_led));
+    TEST_ASSERT_EQUAL(2, s_led.num_changes);
+    expect_led(0, 1500, 1);
+    // Bounces restart the timing: the last bounce edge is at 3004 ms
+    expect_led(1, 3504, 0);
+}
+
+TEST_CASE("replay case C blinks on the nominal schedule", "[replay][case_c]")
+{
+    replay_trace_init(&s_trace);
+    TEST_ASSERT_TRUE(replay_trace_press(&s_trace, 0, 700, 0));
+    TEST_ASSERT_TRUE(replay_run(case_c_main, &s_trace, &s_led));
+    // On at 500 ms, toggles every 100 ms, the last one at 10.4 s turns it off before the 10.5 s end
+    TEST_ASSERT_EQUAL(1 + 99, s_led.num_changes);
+    for (size_t i = 0; i < 100; i++) {
+        expect_led(i, 500 + 100 * i, !(i & 1));
+    }
+}
+
+TEST_CASE("replay case C long press cancels blinking", "[replay][case_c]")
+{
+    replay_trace_init(&s_trace);
+    TEST_ASSERT_TRUE(replay_trace_press(&s_trace, 0, 600, 0));
+    TEST_ASSERT_TRUE(replay_trace_press(&s_trace, 1000, 200, 0));
+    TEST_ASSERT_TRUE(replay_trace_press(&s_trace, 3050, 1000, 0));
+    TEST_ASSERT_TRUE(replay_run(case_c_main, &s_trace, &s_led));
+    // Short press at 1 s does not cancel, the long one cancels at 3550 ms right after the 3500 ms toggle
+    TEST_ASSERT_EQUAL(32, s_led.num_changes);
+    expect_led(30, 3500, 1);
+    expect_led(31, 3550, 0);
+}
+
+// ---- Cross-check against the table-driven cases of button_core ----
+
+static void record_expected(void *arg, uint8_t level)
+{
+    replay_timeline_t *tl = arg;
+    if (tl->num_changes && tl->changes[tl->num_changes - 1].level == level) {
+        return;
+    }
+    if (!tl->num_changes && level == 0) {
+        return;
+    }
+    TEST_ASSERT_TRUE(tl->num_changes < REPLAY_MAX_LED_CHANGES);
+    tl->changes[tl->num_changes++] = (replay_edge_t) {
+        .level = level,
+    };
+}
+
+// Same ordering as the replay: deadlines due at an edge time go before the edge
+static void run_table_case(button_case_t which, const replay_trace_t *trace, replay_timeline_t *tl)
+{
+    fsm_t fsm;
+    button_case_ctx_t ctx = BUTTON_CASE_CTX_DEFAULT();
+    ctx.set_led = record_expected;
+    ctx.set_led_arg = tl;
+    tl->num_changes = 0;
+    TEST_ASSERT_TRUE(button_case_init(&fsm, which, &ctx));
+    for (size_t i = 0; i < trace->num_edges; i++) {
+        // Fire one deadline at a time to stamp each LED change with its time
+        int64_t deadline;
+        while ((deadline = button_case_next_deadline(&ctx)) <= trace->edges[i].time_us) {
+            size_t before = tl->num_changes;
+            button_case_fire_due(&fsm, deadline);
+            for (size_t c = before; c < tl->num_changes; c++) {
+                tl->changes[c].time_us = deadline;
+            }
+        }
+        size_t before = tl->num_changes;
+        button_case_edge(&fsm, trace->edges[i].level, trace->edges[i].time_us);
+        for (size_t c = before; c < tl->num_changes; c++) {
+            tl->changes[c].time_us = trace->edges[i].time_us;
+        }
+    }
+    int64_t deadline;
+    while ((deadline = button_case_next_deadline(&ctx)) != BUTTON_CASE_NO_DEADLINE && deadline <= trace->end_us) {
+        size_t before = tl->num_changes;
+        button_case_fire_due(&fsm, deadline);
+        for (size_t c = before; c < tl->num_changes; c++) {
+            tl->changes[c].time_us = deadline;
+        }
+    }
+}
+
+static uint32_t s_rng = 2024;
+
+static uint32_t rng_next(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+// Presses of 10 ms to 1.2 s, some bouncing, separated by 20 ms to 3 s
+static void random_trace(replay_trace_t *trace, int presses)
+{
+    replay_trace_init(trace);
+    int64_t t = 100;
+    for (int i = 0; i < presses; i++) {
+        int64_t duration = 10 + rng_next() % 1200;
+        int bounces = rng_next() % 4 == 0 ? 1 + rng_next() % 3 : 0;
+        TEST_ASSERT_TRUE(replay_trace_press(trace, t, duration, bounces));
+        t += duration + 20 + rng_next() % 3000;
+    }
+}
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+TEST_CASE("replay matches the table-driven cases on random traces", "[replay][bench]")
+{
+    static void (*const mains[BUTTON_CASE_COUNT])(void) = {
+        [BUTTON_CASE_A] = case_a_main,
+        [BUTTON_CASE_B] = case_b_main,
+        [BUTTON_CASE_C] = case_c_main,
+    };
+    int64_t virtual_us = 0;
+    int64_t wall_ns = 0;
+    for (int run = 0; run < 20; run++) {
+        random_trace(&s_trace, 200);
+        virtual_us += s_trace.edges[s_trace.num_edges - 1].time_us;
+        for (int which = 0; which < BUTTON_CASE_COUNT; which++) {
+            run_table_case(which, &s_trace, &s_expected);
+            int64_t start = now_ns();
+            TEST_ASSERT_TRUE(replay_run(mains[which], &s_trace, &s_led));
+            wall_ns += now_ns() - start;
+            expect_changes(&s_expected, &s_led);
+        }
+    }
+    virtual_us *= BUTTON_CASE_COUNT;
+    printf("replay: %.0f s of button activity in %.1f ms, %.0fx real time\n",
+           virtual_us / 1e6, wall_ns / 1e6, virtual_us * 1e3 / wall_ns);
+}
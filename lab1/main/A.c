@@ -11,8 +11,11 @@
 #include "freertos/task.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
-#include "led_strip.h"
+#include "esp_timer.h"
 #include "sdkconfig.h"
+#include "button_events.h"
+#include "latency.h"
+#include "deferred_log.h"
 
 static const char *TAG = "example";
 
@@ -21,11 +24,14 @@ static const char *TAG = "example";
 */
 #define LED_GPIO CONFIG_BLINK_GPIO
 #define BUTTON_GPIO 0
+#define DEBOUNCE_TIME_US (50 * 1000) // Presses closer than this to the previous one are bounces
 
 // Led state 0=powered off 1=powered on
 static uint8_t s_led_state = 0;
 // Last state of button press 0=Not pressed 1=Pressed
 static uint8_t s_button_last_state = 0;
+// Timestamp of the last accepted press (us)
+static int64_t s_last_press_time = INT64_MIN / 2;
 
 // Configure the GPIO pin elected for the led
 static void configure_led(void)
@@ -36,7 +42,8 @@ static void configure_led(void)
     gpio_set_direction(LED_GPIO, GPIO_MODE_OUTPUT);
 }
 
-// Configure the GPIO pin elected for the static void configure_button(void)
+// Configure the GPIO pin elected for the button
+static void configure_button(void)
 {
     ESP_LOGI(TAG, "Example configured to use GPIO button!");
     gpio_reset_pin(BUTTON_GPIO);
@@ -50,17 +57,22 @@ static void configure_led(void)
 static void toggle_led(void)
 {
     gpio_set_level(LED_GPIO, s_led_state);
+    latency_led_changed();
 }
 
-static bool check_button_press(void)
+static bool check_button_press(const button_event_t *evt)
 {
-    /* Read the button state */
-    uint8_t s_button_current_state = gpio_get_level(BUTTON_GPIO);
-    ESP_LOGI(TAG, "Button state: %d", s_button_current_state);
-    
-    /* Check for rising edge (button press) */
+    /* Button state sampled by the ISR */
+    uint8_t s_button_current_state = evt->level;
+    LAB1_LOGI(TAG, "Button state: %d", s_button_current_state);
+
+    /* Check for rising edge (button press), ignoring bounces right after a press */
     if (s_button_last_state == 0 && s_button_current_state == 1) {
         s_button_last_state = s_button_current_state;
+        if (evt->time_us - s_last_press_time < DEBOUNCE_TIME_US) {
+            return false;
+        }
+        s_last_press_time = evt->time_us;
         return true;
     }
     
@@ -78,17 +90,19 @@ void app_main(void)
     /* Configure the button GPIO */
     configure_button();
 
+    /* Edges are delivered by the GPIO interrupt, nothing to poll */
+    ESP_ERROR_CHECK(button_events_init(BUTTON_GPIO, LED_GPIO));
+    s_button_last_state = gpio_get_level(BUTTON_GPIO);
+
     while (1) {
+        button_event_t evt;
+        button_events_wait(&evt, portMAX_DELAY);
         /* Check if button was pressed (rising edge) */
-        if(check_button_press()){
+        if(check_button_press(&evt)){
             /* Toggle the LED state */
             s_led_state = !s_led_state;
-            ESP_LOGI(TAG, "Button pressed! LED state: %s", s_led_state ? "ON" : "OFF");
+            LAB1_LOGI(TAG, "Button pressed! LED state: %s", s_led_state ? "ON" : "OFF");
             toggle_led();
-            
-            // More delay as the user have to stop pressing the button and them wont be that fast
-            vTaskDelay(50 / portTICK_PERIOD_MS);
         }
-        vTaskDelay(10 / portTICK_PERIOD_MS);
     }
 }
@@ -5,7 +5,11 @@
 #include "freertos/task.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "sdkconfig.h"
+#include "button_events.h"
+#include "latency.h"
+#include "deferred_log.h"
 
 static const char *TAG = "case_b";
 
@@ -23,12 +27,13 @@ typedef enum {
 // Global variables
 static uint8_t s_led_state = 0;                     // Tracks LED state (0=OFF, 1=ON)
 static button_state_t current_state = IDLE;   // Current state machine state
-static TickType_t press_start_time = 0;             // Time when button was first pressed
+static int64_t press_start_time = 0;                // Time when button was first pressed (us)
 
 // Function to update LED state
 static void toggle_led(void)
 {
     gpio_set_level(LED_GPIO, s_led_state);
+    latency_led_changed();
 }
 
 // Configure LED GPIO pin
@@ -53,14 +58,26 @@ void app_main(void)
     // Initialize hardware
     configure_led();
     configure_button();
+    ESP_ERROR_CHECK(button_events_init(BUTTON_GPIO, LED_GPIO));
 
     ESP_LOGI(TAG, "Starting state machine - Case B (long press)");
 
-    // Main polling loop
+    uint8_t button_level = gpio_get_level(BUTTON_GPIO);    // Last known button state
+
+    // Main event loop: the task only wakes up on a button edge or when the long press timer fires
     while (1) {
-        uint8_t button_level = gpio_get_level(BUTTON_GPIO); // Read current button state
-        TickType_t current_time = xTaskGetTickCount();      // Get current system time
-        
+        int64_t deadline = BUTTON_NO_DEADLINE;
+        if (current_state == BUTTON_PRESSED) {
+            deadline = press_start_time + (int64_t)LONG_PRESS_TIME_MS * 1000;
+        }
+        button_events_set_deadline(deadline);
+        button_event_t evt;
+        button_events_wait(&evt, portMAX_DELAY);
+        int64_t current_time = evt.time_us;
+        if (evt.type == BUTTON_EVENT_EDGE) {
+            button_level = evt.level;
+        }
+
         // State machine logic
         switch (current_state) {
             case IDLE:
@@ -68,7 +85,7 @@ void app_main(void)
                     // Button pressed, start timing
                     current_state = BUTTON_PRESSED;
                     press_start_time = current_time;
-                    ESP_LOGI(TAG, "Button pressed, starting timer...");
+                    LAB1_LOGI(TAG, "Button pressed, starting timer...");
                 }
                 break;
                 
@@ -76,16 +93,16 @@ void app_main(void)
                 if (button_level == 0) {
                     // Button released before minimum time
                     current_state = IDLE;
-                    ESP_LOGI(TAG, "Button released too soon");
+                    LAB1_LOGI(TAG, "Button released too soon");
                 } else {
                     // Check if enough time has passed
-                    TickType_t elapsed = (current_time - press_start_time) * portTICK_PERIOD_MS;
+                    int64_t elapsed = (current_time - press_start_time) / 1000;
                     if (elapsed >= LONG_PRESS_TIME_MS) {
                         // Valid long press - change to release waiting state
                         current_state = BUTTON_RELEASED;
                         s_led_state = !s_led_state;
                         toggle_led();
-                        ESP_LOGI(TAG, "Long press detected! LED: %s", s_led_state ? "ON" : "OFF");
+                        LAB1_LOGI(TAG, "Long press detected! LED: %s", s_led_state ? "ON" : "OFF");
                     }
                 }
                 break;
@@ -94,12 +111,9 @@ void app_main(void)
                 if (button_level == 0) {
                     // Button released, return to initial state
                     current_state = IDLE;
-                    ESP_LOGI(TAG, "Button released, returning to initial state");
+                    LAB1_LOGI(TAG, "Button released, returning to initial state");
                 }
                 break;
         }
-        
-        // Small delay to avoid excessive CPU usage
-        vTaskDelay(10 / portTICK_PERIOD_MS);
     }
 }
\ No newline at end of file
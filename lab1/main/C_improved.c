@@ -5,7 +5,17 @@
 #include "freertos/task.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "sdkconfig.h"
+#include "button_events.h"
+#include "latency.h"
+#include "deferred_log.h"
+#if CONFIG_LAB1_MEASURE_JITTER
+#include "jitter.h"
+#endif
+#if CONFIG_LAB1_LED_RMT
+#include "led_pattern.h"
+#endif
 
 static const char *TAG = "case_c";
 
@@ -14,6 +24,14 @@ static const char *TAG = "case_c";
 #define LONG_PRESS_TIME_MS 500     // Minimum press time required (0.5 seconds)
 #define BLINK_DURATION_MS 10000    // Total blinking duration (10 seconds)
 #define BLINK_PERIOD_MS 200        // Blinking period (100ms ON, 100ms OFF)
+#define MS_TO_US(ms) ((int64_t)(ms) * 1000)
+
+// With the RMT sequencer the hardware toggles the LED, the FSM only starts and stops it
+#if CONFIG_LAB1_LED_RMT
+#define BLINK_IN_HARDWARE 1
+#else
+#define BLINK_IN_HARDWARE 0
+#endif
 
 // State machine states
 typedef enum {
@@ -28,14 +46,52 @@ typedef enum {
 // Global variables
 static uint8_t s_led_state = 0;                    // Current LED state (0=OFF, 1=ON)
 static button_state_t current_state = IDLE;        // Current state machine state
-static TickType_t press_start_time = 0;            // Timestamp when button was pressed
-static TickType_t blink_start_time = 0;            // Timestamp when blinking started
-static TickType_t last_blink_time = 0;             // Timestamp of last blink toggle
+static int64_t press_start_time = 0;               // Timestamp when button was pressed (us)
+static int64_t blink_start_time = 0;               // Timestamp when blinking started (us)
+static int64_t last_blink_time = 0;                // Nominal time of last blink toggle (us)
+#if CONFIG_LAB1_MEASURE_JITTER
+static jitter_t s_toggle_jitter;                   // Actual toggle times against BLINK_PERIOD_MS / 2
+#endif
+
+#if CONFIG_LAB1_LED_RMT
+static led_pattern_t s_blink_pattern;              // BLINK_PERIOD_MS square wave
+
+// Function to set LED state, also stops a blink in progress
+static void set_led(uint8_t state)
+{
+    ESP_ERROR_CHECK(led_pattern_set(state));
+    latency_led_changed();
+    s_led_state = state;
+}
+
+// Configure LED GPIO pin as RMT output
+static void configure_led(void)
+{
+    ESP_LOGI(TAG, "Configuring RMT LED on GPIO%d", LED_GPIO);
+    ESP_ERROR_CHECK(led_pattern_init(LED_GPIO));
+    ESP_ERROR_CHECK(led_pattern_compile_blink(&s_blink_pattern, BLINK_PERIOD_MS, 50));
+    s_led_state = 0;
+}
+
+// Start blinking for BLINK_DURATION_MS, the RMT plays it without the CPU
+static void start_blink(void)
+{
+    ESP_ERROR_CHECK(led_pattern_play(&s_blink_pattern, BLINK_DURATION_MS / BLINK_PERIOD_MS));
+    latency_led_changed();
+    s_led_state = 1;
+}
 
+// Stop blinking, LED off
+static void stop_blink(void)
+{
+    set_led(0);
+}
+#else
 // Function to set LED state
 static void set_led(uint8_t state)
 {
     gpio_set_level(LED_GPIO, state);
+    latency_led_changed();
     s_led_state = state;
 }
 
@@ -48,6 +104,41 @@ static void configure_led(void)
     set_led(0); // Initialize LED off
 }
 
+// Start blinking, the FSM toggles the LED every BLINK_PERIOD_MS / 2
+static void start_blink(void)
+{
+    set_led(1); // Start with LED on
+#if CONFIG_LAB1_MEASURE_JITTER
+    jitter_start(&s_toggle_jitter, MS_TO_US(BLINK_PERIOD_MS / 2), esp_timer_get_time());
+#endif
+}
+
+// Stop blinking, LED off
+static void stop_blink(void)
+{
+    set_led(0);
+#if CONFIG_LAB1_MEASURE_JITTER
+    const jitter_t *j = &s_toggle_jitter;
+    if (j->count) {
+        ESP_LOGI(TAG, "Toggle period %lld us over %lu toggles: error min %lld us, max %lld us, mean |err| %lld us, drift %lld us",
+                 (long long)j->nominal_us, (unsigned long)j->count, (long long)j->min_err_us,
+                 (long long)j->max_err_us, (long long)jitter_mean_abs_err_us(j), (long long)jitter_drift_us(j));
+    }
+#endif
+}
+#endif
+
+// Toggle the LED. The next toggle is scheduled from the nominal time, not from
+// when the task woke up, so the wake-up latency does not accumulate
+static void blink_toggle(void)
+{
+    set_led(!s_led_state);
+    last_blink_time += MS_TO_US(BLINK_PERIOD_MS / 2);
+#if CONFIG_LAB1_MEASURE_JITTER
+    jitter_add(&s_toggle_jitter, esp_timer_get_time());
+#endif
+}
+
 // Configure button GPIO pin
 static void configure_button(void)
 {
@@ -57,24 +148,47 @@ static void configure_button(void)
     gpio_set_pull_mode(BUTTON_GPIO, GPIO_PULLDOWN_ONLY);
 }
 
-static TickType_t getElapsed(TickType_t current_time, TickType_t start_time)
+static int64_t getElapsed(int64_t current_time, int64_t start_time)
+{
+    return current_time - start_time;
+}
+
+static bool checkBlinkExcededDuration(int64_t current_time)
 {
-    return (current_time - start_time) * portTICK_PERIOD_MS;
+    return getElapsed(current_time, blink_start_time) >= MS_TO_US(BLINK_DURATION_MS);
 }
 
-static bool checkBlinkExcededDuration(TickType_t current_time)
+static bool checkBlinkToggleTime(int64_t current_time)
 {
-    return getElapsed(current_time, blink_start_time) >= BLINK_DURATION_MS;
+    if (BLINK_IN_HARDWARE) {
+        return false;
+    }
+    return getElapsed(current_time, last_blink_time) >= MS_TO_US(BLINK_PERIOD_MS / 2);
 }
 
-static bool checkBlinkToggleTime(TickType_t current_time)
+static bool checkLongPress(int64_t current_time)
 {
-    return getElapsed(current_time, last_blink_time) >= (BLINK_PERIOD_MS / 2);
+    return getElapsed(current_time, press_start_time) >= MS_TO_US(LONG_PRESS_TIME_MS);
 }
 
-static bool checkLongPress(TickType_t current_time)
+// Earliest time at which one of the timing checks of the current state can fire
+static int64_t nextDeadline(void)
 {
-    return getElapsed(current_time, press_start_time) >= LONG_PRESS_TIME_MS;
+    int64_t toggle_time = BLINK_IN_HARDWARE ? BUTTON_NO_DEADLINE : last_blink_time + MS_TO_US(BLINK_PERIOD_MS / 2);
+    int64_t long_press_time = press_start_time + MS_TO_US(LONG_PRESS_TIME_MS);
+    int64_t blink_end_time = blink_start_time + MS_TO_US(BLINK_DURATION_MS);
+
+    switch (current_state) {
+        case BUTTON_PRESSED:
+            return long_press_time;
+        case BUTTON_RELEASED:
+        case BLINKING:
+            return toggle_time < blink_end_time ? toggle_time : blink_end_time;
+        case BLINKING_BUTTON_PRESSED:
+            return toggle_time < long_press_time ? toggle_time : long_press_time;
+        default:
+            return BUTTON_NO_DEADLINE;
+    }
 }
 
 void app_main(void)
@@ -82,14 +196,23 @@ void app_main(void)
     // Initialize
     configure_led();
     configure_button();
+    ESP_ERROR_CHECK(button_events_init(BUTTON_GPIO, LED_GPIO));
 
     ESP_LOGI(TAG, "Starting state machine - Case C (blinking with long press cancellation)");
-    
-    // Main polling loop
+
+    uint8_t button_level = gpio_get_level(BUTTON_GPIO);     // Last known button state
+
+    // Main event loop: the task only wakes up on a button edge or when the deadline timer fires
     while (1) {
-        uint8_t button_level = gpio_get_level(BUTTON_GPIO);  // Read current button state
-        TickType_t current_time = xTaskGetTickCount();       // Get current system time
-        
+        button_events_set_deadline(nextDeadline());
+        button_event_t evt;
+        button_events_wait(&evt, portMAX_DELAY);
+        // Evaluate the state machine at the exact edge or timer expiry time
+        int64_t current_time = evt.time_us;
+        if (evt.type == BUTTON_EVENT_EDGE) {
+            button_level = evt.level;
+        }
+
         // State machine logic
         switch (current_state) {
             case IDLE:
@@ -98,7 +221,7 @@ void app_main(void)
                     // Button pressed, start timing
                     current_state = BUTTON_PRESSED;
                     press_start_time = current_time;
-                    ESP_LOGI(TAG, "Button pressed, starting timer...");
+                    LAB1_LOGI(TAG, "Button pressed, starting timer...");
                 }
                 break;
                 
@@ -106,16 +229,17 @@ void app_main(void)
                 if (button_level == 0) {
                     // Button released before minimum time
                     current_state = IDLE;
-                    ESP_LOGI(TAG, "Button released too early");
+                    LAB1_LOGI(TAG, "Button released too early");
                 } else {
                     // Check if enough time has passed
                     if (checkLongPress(current_time)) {
                         // Valid long press - start blinking IMMEDIATELY
                         current_state = BUTTON_RELEASED;
-                        blink_start_time = current_time;
-                        last_blink_time = current_time;
-                        set_led(1); // Start with LED on
-                        ESP_LOGI(TAG, "Long press detected! Starting blinking immediately");
+                        // Blink schedule starts at the nominal long press time
+                        blink_start_time = press_start_time + MS_TO_US(LONG_PRESS_TIME_MS);
+                        last_blink_time = blink_start_time;
+                        start_blink();
+                        LAB1_LOGI(TAG, "Long press detected! Starting blinking immediately");
                     }
                 }
                 break;
@@ -125,21 +249,19 @@ void app_main(void)
                 // Check first if 10 seconds have passed
                 if (checkBlinkExcededDuration(current_time)) {
                     // End blinking regardless of button state
-                    set_led(0);
+                    stop_blink();
                     current_state = BLINKING_ENDED_BUTTON_RELEASED;
-                    ESP_LOGI(TAG, "Blinking finished after 10 seconds, LED off");
+                    LAB1_LOGI(TAG, "Blinking finished after 10 seconds, LED off");
                 } else if (button_level == 0) {
                     // Button released, continue blinking
                     current_state = BLINKING;
-                    ESP_LOGI(TAG, "Button released, continuing blinking");
+                    LAB1_LOGI(TAG, "Button released, continuing blinking");
                 } else {
                     // Button still pressed from initial activation
                     // To cancel, must release and press again for >0.5s
                     // Only continue blinking
                     if (checkBlinkToggleTime(current_time)) {
-                        s_led_state = !s_led_state;
-                        set_led(s_led_state);
-                        last_blink_time = current_time;
+                        blink_toggle();
                     }
                 }
                 break;
@@ -150,20 +272,18 @@ void app_main(void)
                 if (button_level == 1) {
                     current_state = BLINKING_BUTTON_PRESSED;
                     press_start_time = current_time;
-                    ESP_LOGI(TAG, "Button pressed during blinking...");
+                    LAB1_LOGI(TAG, "Button pressed during blinking...");
                 } else {
                     // Check if 10 seconds have passed
                     if (checkBlinkExcededDuration(current_time)) {
                         // End blinking
-                        set_led(0); // Turn off LED
+                        stop_blink(); // Turn off LED
                         current_state = IDLE;
-                        ESP_LOGI(TAG, "Blinking finished, LED off");
+                        LAB1_LOGI(TAG, "Blinking finished, LED off");
                     } else {
                         // Continue blinking
                         if (checkBlinkToggleTime(current_time)) {
-                            s_led_state = !s_led_state;
-                            set_led(s_led_state);
-                            last_blink_time = current_time;
+                            blink_toggle();
                         }
                     }
                 }
@@ -174,20 +294,18 @@ void app_main(void)
                 if (button_level == 0) {
                     // Button released before minimum time, continue blinking
                     current_state = BLINKING;
-                    ESP_LOGI(TAG, "Button released too early, continuing blinking");
+                    LAB1_LOGI(TAG, "Button released too early, continuing blinking");
                 } else {
                     // Check if enough time has passed to cancel
                     if (checkLongPress(current_time)) {
                         // Valid long press - cancel blinking
-                        set_led(0); // Turn off LED
+                        stop_blink(); // Turn off LED
                         current_state = BLINKING_ENDED_BUTTON_RELEASED;
-                        ESP_LOGI(TAG, "Long press detected! Cancelling blinking...");
+                        LAB1_LOGI(TAG, "Long press detected! Cancelling blinking...");
                     } else {
                         // Continue blinking while checking press duration
                         if (checkBlinkToggleTime(current_time)) {
-                            s_led_state = !s_led_state;
-                            set_led(s_led_state);
-                            last_blink_time = current_time;
+                            blink_toggle();
                         }
                     }
                 }
@@ -198,11 +316,9 @@ void app_main(void)
                 if (button_level == 0) {
                     // Button released, cancel blinking
                     current_state = IDLE;
-                    ESP_LOGI(TAG, "Button released, blinking cancelled, LED off");
+                    LAB1_LOGI(TAG, "Button released, blinking cancelled, LED off");
                 }
                 break;
         }
-        // Small delay to avoid excessive CPU usage (10ms polling rate)
-        vTaskDelay(10 / portTICK_PERIOD_MS);
     }
 }
\ No newline at end of file
@@ -0,0 +1,85 @@
+/* Animation demo on the LED strip
+
+   A dim background, a slow color breath, a chase and sparkles are
+   composited by led_anim and played at a fixed frame rate on the strip of
+   CONFIG_BLINK_GPIO. Every 5 s the frames, the dropped slots and the render
+   and wire times of the last period are logged, to size the strip and the
+   frame rate from data.
+*/
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "led_strip.h"
+#include "led_anim.h"
+#include "led_anim_player.h"
+
+static const char *TAG = "anim";
+
+#define STATS_PERIOD_MS 5000
+
+static led_anim_t s_anim;
+
+static led_strip_handle_t configure_strip(void)
+{
+    ESP_LOGI(TAG, "Configuring a strip of %d LEDs on GPIO%d", CONFIG_LAB1_ANIM_NUM_LEDS, CONFIG_BLINK_GPIO);
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = CONFIG_BLINK_GPIO,
+        .max_leds = CONFIG_LAB1_ANIM_NUM_LEDS,
+        .led_model = LED_MODEL_WS2812,
+        .flags.double_buffer = true,
+    };
+    led_strip_handle_t strip = NULL;
+#if CONFIG_BLINK_LED_STRIP_BACKEND_RMT
+    led_strip_rmt_config_t rmt_config = {
+        .resolution_hz = 10 * 1000 * 1000,
+        .flags.with_dma = false,
+    };
+    ESP_ERROR_CHECK(led_strip_new_rmt_device(&strip_config, &rmt_config, &strip));
+#else
+    led_strip_spi_config_t spi_config = {
+        .spi_bus = SPI2_HOST,
+        .flags.with_dma = true,
+    };
+    ESP_ERROR_CHECK(led_strip_new_spi_device(&strip_config, &spi_config, &strip));
+#endif
+    return strip;
+}
+
+static void configure_layers(void)
+{
+    led_anim_init(&s_anim, CONFIG_LAB1_ANIM_NUM_LEDS);
+    const led_anim_layer_t layers[] = {
+        { .effect = LED_ANIM_SOLID, .blend = LED_ANIM_BLEND_NORMAL, .color = { 0, 0, 24 }, .opacity = 255 },
+        { .effect = LED_ANIM_FADE, .blend = LED_ANIM_BLEND_ADD, .color = { 48, 0, 48 }, .opacity = 255, .period_ms = 4000 },
+        { .effect = LED_ANIM_CHASE, .blend = LED_ANIM_BLEND_NORMAL, .color = { 255, 96, 0 }, .opacity = 255, .period_ms = 3000, .size = 8 },
+        { .effect = LED_ANIM_SPARKLE, .blend = LED_ANIM_BLEND_MAX, .color = { 255, 255, 255 }, .opacity = 192, .period_ms = 600, .size = 8 },
+    };
+    for (size_t i = 0; i < sizeof(layers) / sizeof(layers[0]); i++) {
+        led_anim_add_layer(&s_anim, &layers[i]);
+    }
+}
+
+void app_main(void)
+{
+    led_strip_handle_t strip = configure_strip();
+    configure_layers();
+    led_anim_player_config_t config = {
+        .strip = strip,
+        .anim = &s_anim,
+        .frame_rate_hz = CONFIG_LAB1_ANIM_FRAME_RATE,
+        .core_id = portNUM_PROCESSORS - 1,
+        .priority = 5,
+    };
+    ESP_ERROR_CHECK(led_anim_player_start(&config));
+
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(STATS_PERIOD_MS));
+        led_anim_stats_t stats;
+        led_anim_player_get_stats(&stats, true);
+        ESP_LOGI(TAG, "%lu frames, %lu dropped, render %lu us (max %lu), wire %lu us (max %lu)",
+                 (unsigned long)stats.frames, (unsigned long)stats.dropped,
+                 (unsigned long)led_anim_stats_render_us_mean(&stats), (unsigned long)stats.render_us_max,
+                 (unsigned long)led_anim_stats_wire_us_mean(&stats), (unsigned long)stats.wire_us_max);
+    }
+}
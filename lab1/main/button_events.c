@@ -0,0 +1,240 @@
+/* Interrupt-driven button events
+*/
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "button_events.h"
+#include "latency.h"
+#include "deferred_log.h"
+#if CONFIG_LAB1_LIGHT_SLEEP
+#include "hal/gpio_ll.h"
+#include "power_save.h"
+#endif
+#if CONFIG_LAB1_ETM_TIMESTAMP
+#include "driver/gpio_etm.h"
+#include "driver/gptimer.h"
+#include "esp_etm.h"
+#endif
+
+static const char *TAG = "button_events";
+
+static QueueHandle_t s_event_queue = NULL;   // Edges pushed by the ISR, deadlines by the timer
+static gpio_num_t s_button_gpio = GPIO_NUM_NC;
+static volatile uint32_t s_dropped = 0;      // Events lost on a full queue
+static esp_timer_handle_t s_deadline_timer = NULL;
+static int64_t s_deadline_us = BUTTON_NO_DEADLINE;  // Deadline the timer is armed for
+
+#if CONFIG_LAB1_ETM_TIMESTAMP
+#define EDGE_TIMER_RESOLUTION_HZ 1000000    // Counts in us, like esp_timer
+
+static gptimer_handle_t s_edge_timer = NULL;
+static int64_t s_edge_timer_offset_us;      // esp_timer_get_time() - edge timer count
+
+// Every edge makes the ETM capture the free-running gptimer, without the CPU
+static esp_err_t edge_capture_init(gpio_num_t gpio)
+{
+    // Same crystal as the esp_timer systimer, so the two clocks do not drift apart
+    const gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_XTAL,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = EDGE_TIMER_RESOLUTION_HZ,
+    };
+    ESP_RETURN_ON_ERROR(gptimer_new_timer(&timer_config, &s_edge_timer), TAG, "create edge timer failed");
+
+    const gpio_etm_event_config_t event_config = {
+        .edge = GPIO_ETM_EVENT_EDGE_ANY,
+    };
+    esp_etm_event_handle_t edge_event = NULL;
+    ESP_RETURN_ON_ERROR(gpio_new_etm_event(&event_config, &edge_event), TAG, "create GPIO ETM event failed");
+    ESP_RETURN_ON_ERROR(gpio_etm_event_bind_gpio(edge_event, gpio), TAG, "bind GPIO ETM event failed");
+
+    const gptimer_etm_task_config_t task_config = {
+        .task_type = GPTIMER_ETM_TASK_CAPTURE,
+    };
+    esp_etm_task_handle_t capture_task = NULL;
+    ESP_RETURN_ON_ERROR(gptimer_new_etm_task(s_edge_timer, &task_config, &capture_task), TAG, "create capture task failed");
+
+    const esp_etm_channel_config_t channel_config = {};
+    esp_etm_channel_handle_t channel = NULL;
+    ESP_RETURN_ON_ERROR(esp_etm_new_channel(&channel_config, &channel), TAG, "create ETM channel failed");
+    ESP_RETURN_ON_ERROR(esp_etm_channel_connect(channel, edge_event, capture_task), TAG, "connect ETM channel failed");
+    ESP_RETURN_ON_ERROR(esp_etm_channel_enable(channel), TAG, "enable ETM channel failed");
+
+    ESP_RETURN_ON_ERROR(gptimer_enable(s_edge_timer), TAG, "enable edge timer failed");
+    ESP_RETURN_ON_ERROR(gptimer_start(s_edge_timer), TAG, "start edge timer failed");
+    // Map the timer count to the esp_timer time base once, both then count the same microseconds
+    uint64_t count = 0;
+    int64_t now = esp_timer_get_time();
+    ESP_RETURN_ON_ERROR(gptimer_get_raw_count(s_edge_timer, &count), TAG, "read edge timer failed");
+    s_edge_timer_offset_us = now - (int64_t)count;
+    ESP_LOGI(TAG, "Edges on GPIO%d timestamped by the ETM", gpio);
+    return ESP_OK;
+}
+
+// Time of the last edge, captured by the hardware when it happened. A bounce between the
+// edge and this read moves it to the bounce, which is the edge the sampled level belongs to
+static inline int64_t IRAM_ATTR edge_time_us(void)
+{
+    uint64_t count = 0;
+    gptimer_get_captured_count(s_edge_timer, &count);
+    return s_edge_timer_offset_us + (int64_t)count;
+}
+#else
+static inline int64_t IRAM_ATTR edge_time_us(void)
+{
+    return esp_timer_get_time();
+}
+#endif
+
+#if CONFIG_LAB1_LIGHT_SLEEP
+// Light sleep can only be woken by a GPIO level: the interrupt waits for the level
+// opposite to the current one and is flipped on every edge, which behaves as any-edge
+static inline void IRAM_ATTR wait_for_level_change(uint8_t level)
+{
+    gpio_ll_set_intr_type(GPIO_LL_GET_HW(GPIO_PORT_0), s_button_gpio,
+                          level ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+}
+#endif
+
+// Runs on every edge: timestamp first, then sample the new level
+static void IRAM_ATTR button_isr_handler(void *arg)
+{
+    BaseType_t woken = pdFALSE;
+    button_event_t evt = {
+        .time_us = edge_time_us(),
+        .cycles = esp_cpu_get_cycle_count(),
+        .type = BUTTON_EVENT_EDGE,
+        .level = gpio_get_level(s_button_gpio),
+    };
+#if CONFIG_LAB1_LIGHT_SLEEP
+    wait_for_level_change(evt.level);
+#endif
+    if (xQueueSendFromISR(s_event_queue, &evt, &woken) != pdTRUE) {
+        s_dropped++;
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+// Dispatched from the timer ISR: no esp_timer task switch between expiry and the FSM task
+static void IRAM_ATTR deadline_timer_cb(void *arg)
+{
+    BaseType_t woken = pdFALSE;
+    button_event_t evt = {
+        .time_us = esp_timer_get_time(),
+        .cycles = esp_cpu_get_cycle_count(),
+        .type = BUTTON_EVENT_DEADLINE,
+    };
+    if (xQueueSendFromISR(s_event_queue, &evt, &woken) != pdTRUE) {
+        s_dropped++;
+    }
+    if (woken) {
+        esp_timer_isr_dispatch_need_yield();
+    }
+}
+#else
+// Dispatched from the esp_timer task
+static void deadline_timer_cb(void *arg)
+{
+    button_event_t evt = {
+        .time_us = esp_timer_get_time(),
+        .cycles = esp_cpu_get_cycle_count(),
+        .type = BUTTON_EVENT_DEADLINE,
+    };
+    if (xQueueSend(s_event_queue, &evt, 0) != pdTRUE) {
+        s_dropped++;
+    }
+}
+#endif
+
+esp_err_t button_events_init(gpio_num_t gpio, gpio_num_t led_gpio)
+{
+    ESP_RETURN_ON_FALSE(s_event_queue == NULL, ESP_ERR_INVALID_STATE, TAG, "already initialized");
+    s_event_queue = xQueueCreate(BUTTON_EVENTS_QUEUE_LEN, sizeof(button_event_t));
+    ESP_RETURN_ON_FALSE(s_event_queue, ESP_ERR_NO_MEM, TAG, "no mem for event queue");
+    s_button_gpio = gpio;
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = deadline_timer_cb,
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+        .dispatch_method = ESP_TIMER_ISR,
+#else
+        .dispatch_method = ESP_TIMER_TASK,
+#endif
+        .name = "button_deadline",
+    };
+    ESP_RETURN_ON_ERROR(esp_timer_create(&timer_args, &s_deadline_timer), TAG, "create deadline timer failed");
+
+#if CONFIG_LAB1_LIGHT_SLEEP
+    // gpio_wakeup_enable() sets the level interrupt, the ISR flips it from then on
+    uint8_t level = gpio_get_level(gpio);
+    ESP_RETURN_ON_ERROR(gpio_wakeup_enable(gpio, level ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL),
+                        TAG, "enable GPIO wakeup failed");
+    // Keep the pull configuration of the button while asleep
+    ESP_RETURN_ON_ERROR(gpio_sleep_sel_dis(gpio), TAG, "disable sleep configuration failed");
+    ESP_RETURN_ON_ERROR(power_save_init(led_gpio), TAG, "power save init failed");
+#else
+    ESP_RETURN_ON_ERROR(gpio_set_intr_type(gpio, GPIO_INTR_ANYEDGE), TAG, "set interrupt type failed");
+#endif
+#if CONFIG_LAB1_ETM_TIMESTAMP
+    ESP_RETURN_ON_ERROR(edge_capture_init(gpio), TAG, "edge capture init failed");
+#endif
+    // The ISR service may already be installed by another driver
+    esp_err_t ret = gpio_install_isr_service(0);
+    ESP_RETURN_ON_FALSE(ret == ESP_OK || ret == ESP_ERR_INVALID_STATE, ret, TAG, "install ISR service failed");
+    ESP_RETURN_ON_ERROR(gpio_isr_handler_add(gpio, button_isr_handler, NULL), TAG, "add ISR handler failed");
+    ESP_RETURN_ON_ERROR(latency_init(), TAG, "latency instrumentation init failed");
+    ESP_RETURN_ON_ERROR(deferred_log_init(), TAG, "deferred log init failed");
+    ESP_LOGI(TAG, "Edge interrupts enabled on GPIO%d", gpio);
+    return ESP_OK;
+}
+
+bool button_events_wait(button_event_t *evt, TickType_t timeout)
+{
+    latency_wait_begin();
+    if (xQueueReceive(s_event_queue, evt, timeout) != pdTRUE) {
+        return false;
+    }
+    latency_event_received(evt);
+#if CONFIG_LAB1_LIGHT_SLEEP
+    power_save_event_received(esp_timer_get_time());
+#endif
+    return true;
+}
+
+void button_events_set_deadline(int64_t deadline_us)
+{
+    // Most FSM runs leave the deadline unchanged, keep the timer running then
+    if (deadline_us == s_deadline_us && esp_timer_is_active(s_deadline_timer)) {
+        return;
+    }
+    esp_timer_stop(s_deadline_timer);   // ESP_ERR_INVALID_STATE when not running
+    s_deadline_us = deadline_us;
+    if (deadline_us == BUTTON_NO_DEADLINE) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    if (deadline_us <= now) {
+        // Already due, no need for a timer round trip
+        button_event_t evt = {
+            .time_us = now,
+            .cycles = esp_cpu_get_cycle_count(),
+            .type = BUTTON_EVENT_DEADLINE,
+        };
+        if (xQueueSend(s_event_queue, &evt, 0) != pdTRUE) {
+            s_dropped++;
+        }
+        return;
+    }
+    ESP_ERROR_CHECK(esp_timer_start_once(s_deadline_timer, deadline_us - now));
+}
+
+uint32_t button_events_dropped(void)
+{
+    return s_dropped;
+}
@@ -0,0 +1,50 @@
+/* Interrupt-driven button events
+
+   The button GPIO raises an interrupt on every edge. The ISR timestamps the
+   edge with esp_timer_get_time() and pushes it to a queue, so the state
+   machine task stays blocked until an edge or its next deadline arrives.
+   Deadlines are timed by a one-shot esp_timer that posts a deadline event
+   to the same queue, with microsecond resolution instead of RTOS ticks.
+
+   With CONFIG_LAB1_ETM_TIMESTAMP the edge timestamp is not taken by the ISR
+   but captured in hardware: the Event Task Matrix connects the GPIO edge
+   event to the capture task of a free-running gptimer, and the ISR only
+   reads the captured count. Interrupt latency and preemption then no longer
+   skew press durations.
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+#include "esp_err.h"
+
+#define BUTTON_EVENTS_QUEUE_LEN 16       // Edges buffered between two FSM runs
+#define BUTTON_NO_DEADLINE INT64_MAX     // Deadline value meaning "wait only for edges"
+
+typedef enum {
+    BUTTON_EVENT_EDGE,      // Edge captured by the GPIO ISR
+    BUTTON_EVENT_DEADLINE,  // Deadline timer expired
+} button_event_type_t;
+
+// Event read by the state machine task
+typedef struct {
+    int64_t time_us;    // esp_timer_get_time() time base, when the edge happened or the timer fired
+    uint32_t cycles;    // esp_cpu_get_cycle_count() at the same moment, for latency measurements
+    uint8_t type;       // button_event_type_t
+    uint8_t level;      // Button level right after the edge, edges only
+} button_event_t;
+
+// Enable any-edge interrupt on an already configured input GPIO. led_gpio keeps its level in light sleep
+esp_err_t button_events_init(gpio_num_t gpio, gpio_num_t led_gpio);
+
+// Block until an event arrives or timeout expires. Returns true when evt was filled
+bool button_events_wait(button_event_t *evt, TickType_t timeout);
+
+// Post a deadline event at deadline_us, replacing the previous one. BUTTON_NO_DEADLINE disarms.
+// A deadline event may be stale when the deadline changed while it was queued: always recheck the time
+void button_events_set_deadline(int64_t deadline_us);
+
+// Number of events lost because the queue was full
+uint32_t button_events_dropped(void);
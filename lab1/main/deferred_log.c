@@ -0,0 +1,66 @@
+/* Deferred logging for the state machine loops
+*/
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_check.h"
+#include "log_ring.h"
+#include "deferred_log.h"
+
+static const char *TAG = "deferred_log";
+
+#define LOGGER_STACK_SIZE 3072
+#define LOGGER_PRIORITY 1       // Above idle only, the loops always win
+#define LOGGER_LINE_LEN 128
+
+static log_ring_t s_ring;
+static TaskHandle_t s_logger_task = NULL;
+
+void deferred_log_write(const char *tag, const char *fmt, uint32_t arg0, uint32_t arg1, uint32_t arg2)
+{
+    log_record_t rec = {
+        .time_ms = esp_log_timestamp(),
+        .tag = tag,
+        .fmt = fmt,
+        .args = { arg0, arg1, arg2 },
+    };
+    // The logger drains the ring before sleeping: only the record that makes it non-empty wakes it.
+    // A count of 0 means the logger already took it, the caller is the only producer
+    if (log_ring_put(&s_ring, &rec) && log_ring_count(&s_ring) == 1 && s_logger_task) {
+        xTaskNotifyGive(s_logger_task);
+    }
+}
+
+uint32_t deferred_log_dropped(void)
+{
+    return s_ring.dropped;
+}
+
+static void logger_task(void *arg)
+{
+    char line[LOGGER_LINE_LEN];
+    uint32_t reported_drops = 0;
+    log_record_t rec;
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (log_ring_get(&s_ring, &rec)) {
+            log_ring_format(&rec, line, sizeof(line));
+            // Same layout as ESP_LOGI(), with the time of the call
+            esp_log_write(ESP_LOG_INFO, rec.tag, "I (%lu) %s: %s\n", (unsigned long)rec.time_ms, rec.tag, line);
+        }
+        uint32_t drops = s_ring.dropped;
+        if (drops != reported_drops) {
+            ESP_LOGW(TAG, "%lu records dropped", (unsigned long)(drops - reported_drops));
+            reported_drops = drops;
+        }
+    }
+}
+
+esp_err_t deferred_log_init(void)
+{
+    ESP_RETURN_ON_FALSE(s_logger_task == NULL, ESP_ERR_INVALID_STATE, TAG, "already initialized");
+    log_ring_init(&s_ring);
+    BaseType_t ok = xTaskCreate(logger_task, "deferred_log", LOGGER_STACK_SIZE, NULL, LOGGER_PRIORITY, &s_logger_task);
+    ESP_RETURN_ON_FALSE(ok == pdPASS, ESP_ERR_NO_MEM, TAG, "create logger task failed");
+    return ESP_OK;
+}
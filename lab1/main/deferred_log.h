@@ -0,0 +1,44 @@
+/* Deferred logging for the state machine loops
+
+   With CONFIG_LAB1_DEFERRED_LOG, LAB1_LOGI() only stores the timestamp, the
+   tag, the format and up to 3 arguments in a lock-free ring (log_ring.h) and
+   returns. A low-priority task formats and prints the records when the CPU
+   has nothing else to do, so the UART never stalls the event loop. The ring
+   has a single producer: LAB1_LOGI() is meant for the event loop task only.
+
+   Arguments are stored as 32-bit words: integers up to 32 bits and pointers
+   to strings that outlive the call (literals). Anything else, 64-bit values
+   in particular, must keep using ESP_LOGI().
+
+   Without CONFIG_LAB1_DEFERRED_LOG, LAB1_LOGI() is ESP_LOGI().
+*/
+#pragma once
+
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "esp_log.h"
+
+#if CONFIG_LAB1_DEFERRED_LOG
+// Create the ring and the logger task
+esp_err_t deferred_log_init(void);
+
+// Store a record, called through LAB1_LOGI()
+void deferred_log_write(const char *tag, const char *fmt, uint32_t arg0, uint32_t arg1, uint32_t arg2);
+
+// Records lost because the logger task could not keep up
+uint32_t deferred_log_dropped(void);
+
+// The dummy first argument lets ##__VA_ARGS__ be empty, missing arguments are 0 and extra ones ignored
+#define DEFERRED_LOG_ARGS_(dummy, a0, a1, a2, ...) \
+    (uint32_t)(uintptr_t)(a0), (uint32_t)(uintptr_t)(a1), (uint32_t)(uintptr_t)(a2)
+#define LAB1_LOGI(tag, fmt, ...) \
+    deferred_log_write(tag, fmt, DEFERRED_LOG_ARGS_(0, ##__VA_ARGS__, 0, 0, 0))
+#else
+static inline esp_err_t deferred_log_init(void)
+{
+    return ESP_OK;
+}
+
+#define LAB1_LOGI(tag, fmt, ...) ESP_LOGI(tag, fmt, ##__VA_ARGS__)
+#endif
@@ -0,0 +1,111 @@
+/* Lab1 cases A, B and C driven by the table-driven FSM engine
+
+   Same behaviour as A.c, B.c and C_improved.c, with the state machine
+   described by the const transition tables of button_cases.c.
+*/
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "button_events.h"
+#include "latency.h"
+#include "button_cases.h"
+#if CONFIG_LAB1_LED_RMT
+#include "led_pattern.h"
+#endif
+
+static const char *TAG = "case_fsm";
+
+#define LED_GPIO 4
+#define BUTTON_GPIO 0
+
+#if CONFIG_LAB1_CASE_A
+#define LAB1_CASE BUTTON_CASE_A
+#elif CONFIG_LAB1_CASE_B
+#define LAB1_CASE BUTTON_CASE_B
+#else
+#define LAB1_CASE BUTTON_CASE_C
+#endif
+
+static fsm_t s_fsm;
+static button_case_ctx_t s_ctx = BUTTON_CASE_CTX_DEFAULT();
+
+#if CONFIG_LAB1_LED_RMT
+static led_pattern_t s_blink_pattern;
+
+// LED output used by the FSM actions, also stops a blink in progress
+static void set_led(void *arg, uint8_t level)
+{
+    ESP_ERROR_CHECK(led_pattern_set(level));
+    latency_led_changed();
+}
+
+// Blink played by the RMT, the FSM only times its end
+static void start_blink(void *arg, uint32_t period_ms, uint32_t duration_ms)
+{
+    ESP_ERROR_CHECK(led_pattern_play(&s_blink_pattern, duration_ms / period_ms));
+    latency_led_changed();
+}
+
+// Configure LED GPIO pin as RMT output
+static void configure_led(void)
+{
+    ESP_LOGI(TAG, "Configuring RMT LED on GPIO%d", LED_GPIO);
+    ESP_ERROR_CHECK(led_pattern_init(LED_GPIO));
+    ESP_ERROR_CHECK(led_pattern_compile_blink(&s_blink_pattern, s_ctx.blink_period_ms, 50));
+    s_ctx.start_blink = start_blink;
+}
+#else
+// LED output used by the FSM actions
+static void set_led(void *arg, uint8_t level)
+{
+    gpio_set_level(LED_GPIO, level);
+    latency_led_changed();
+}
+
+// Configure LED GPIO pin
+static void configure_led(void)
+{
+    ESP_LOGI(TAG, "Configuring LED on GPIO%d", LED_GPIO);
+    gpio_reset_pin(LED_GPIO);
+    gpio_set_direction(LED_GPIO, GPIO_MODE_OUTPUT);
+    set_led(NULL, 0);
+}
+#endif
+
+// Configure button GPIO pin
+static void configure_button(void)
+{
+    ESP_LOGI(TAG, "Configuring button on GPIO%d", BUTTON_GPIO);
+    gpio_reset_pin(BUTTON_GPIO);
+    gpio_set_direction(BUTTON_GPIO, GPIO_MODE_INPUT);
+    gpio_set_pull_mode(BUTTON_GPIO, GPIO_PULLDOWN_ONLY);
+}
+
+void app_main(void)
+{
+    configure_led();
+    configure_button();
+    ESP_ERROR_CHECK(button_events_init(BUTTON_GPIO, LED_GPIO));
+
+    s_ctx.set_led = set_led;
+    if (!button_case_init(&s_fsm, LAB1_CASE, &s_ctx)) {
+        ESP_LOGE(TAG, "Invalid transition table for case %d", LAB1_CASE);
+        return;
+    }
+    ESP_LOGI(TAG, "Starting table-driven state machine - Case %c", 'A' + LAB1_CASE);
+
+    while (1) {
+        button_events_set_deadline(button_case_next_deadline(&s_ctx));
+        button_event_t evt;
+        button_events_wait(&evt, portMAX_DELAY);
+        // Deadlines that expired before the event go first
+        button_case_fire_due(&s_fsm, evt.time_us);
+        if (evt.type == BUTTON_EVENT_EDGE) {
+            button_case_edge(&s_fsm, evt.level, evt.time_us);
+        }
+    }
+}
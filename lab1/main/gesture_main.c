@@ -0,0 +1,107 @@
+/* Gesture demo: every lab1 interaction from one recognizer
+
+   Click toggles the LED, double click turns it on, triple click turns it
+   off, long press toggles it and holding it further blinks it at the
+   hold-repeat rate. A second subscriber logs every gesture.
+*/
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "button_events.h"
+#include "latency.h"
+#include "gesture.h"
+
+static const char *TAG = "gesture";
+
+#define LED_GPIO 4
+#define BUTTON_GPIO 0
+
+static uint8_t s_led_state = 0;
+static gesture_t s_gesture;
+
+// Function to set LED state
+static void set_led(uint8_t state)
+{
+    gpio_set_level(LED_GPIO, state);
+    latency_led_changed();
+    s_led_state = state;
+}
+
+// Configure LED GPIO pin
+static void configure_led(void)
+{
+    ESP_LOGI(TAG, "Configuring LED on GPIO%d", LED_GPIO);
+    gpio_reset_pin(LED_GPIO);
+    gpio_set_direction(LED_GPIO, GPIO_MODE_OUTPUT);
+    set_led(0);
+}
+
+// Configure button GPIO pin
+static void configure_button(void)
+{
+    ESP_LOGI(TAG, "Configuring button on GPIO%d", BUTTON_GPIO);
+    gpio_reset_pin(BUTTON_GPIO);
+    gpio_set_direction(BUTTON_GPIO, GPIO_MODE_INPUT);
+    gpio_set_pull_mode(BUTTON_GPIO, GPIO_PULLDOWN_ONLY);
+}
+
+// LED subscriber
+static void on_led_gesture(const gesture_event_t *evt, void *arg)
+{
+    switch (evt->type) {
+        case GESTURE_CLICK:
+            set_led(evt->count == 1 ? !s_led_state : evt->count == 2);
+            break;
+        case GESTURE_LONG_PRESS:
+        case GESTURE_HOLD_REPEAT:
+            set_led(!s_led_state);
+            break;
+        default:
+            break;
+    }
+}
+
+// Logger subscriber
+static void on_log_gesture(const gesture_event_t *evt, void *arg)
+{
+    static const char *const names[GESTURE_TYPE_COUNT] = {
+        [GESTURE_PRESS] = "press",
+        [GESTURE_RELEASE] = "release",
+        [GESTURE_CLICK] = "click",
+        [GESTURE_LONG_PRESS] = "long press",
+        [GESTURE_HOLD_REPEAT] = "hold repeat",
+        [GESTURE_LONG_RELEASE] = "long release",
+    };
+    ESP_LOGI(TAG, "%s x%u at %lld ms, LED %s", names[evt->type], evt->count,
+             (long long)(evt->time_us / 1000), s_led_state ? "ON" : "OFF");
+}
+
+void app_main(void)
+{
+    configure_led();
+    configure_button();
+    ESP_ERROR_CHECK(button_events_init(BUTTON_GPIO, LED_GPIO));
+
+    gesture_config_t config = GESTURE_CONFIG_DEFAULT();
+    gesture_init(&s_gesture, &config);
+    gesture_subscribe(&s_gesture, GESTURE_MASK(GESTURE_CLICK) | GESTURE_MASK(GESTURE_LONG_PRESS) |
+                      GESTURE_MASK(GESTURE_HOLD_REPEAT), on_led_gesture, NULL);
+    gesture_subscribe(&s_gesture, GESTURE_MASK_ALL & ~(GESTURE_MASK(GESTURE_PRESS) | GESTURE_MASK(GESTURE_RELEASE)),
+                      on_log_gesture, NULL);
+
+    ESP_LOGI(TAG, "Starting gesture recognizer");
+    while (1) {
+        button_events_set_deadline(gesture_next_deadline(&s_gesture));
+        button_event_t evt;
+        button_events_wait(&evt, portMAX_DELAY);
+        if (evt.type == BUTTON_EVENT_EDGE) {
+            gesture_edge(&s_gesture, evt.level, evt.time_us);
+        } else {
+            gesture_poll(&s_gesture, evt.time_us);
+        }
+    }
+}
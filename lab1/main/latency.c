@@ -0,0 +1,129 @@
+/* Event-to-LED latency instrumentation
+*/
+#include <stdio.h>
+#include <stdbool.h>
+#include "esp_check.h"
+#include "esp_clk_tree.h"
+#include "esp_console.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "latency_hist.h"
+#include "latency.h"
+
+static const char *TAG = "latency";
+
+static latency_hist_t s_hist[2];            // Indexed by button_event_type_t
+static latency_hist_t s_loop_hist;          // Cycles spent handling one event
+static int s_pending_type = -1;             // Event whose LED change is awaited, -1 if none
+static uint32_t s_pending_cycles;
+static bool s_in_loop;                      // An event is being handled since s_loop_start
+static uint32_t s_loop_start;
+
+void latency_event_received(const button_event_t *evt)
+{
+    // Only the first LED change after an event counts, a later one belongs to another path
+    s_pending_type = evt->type;
+    s_pending_cycles = evt->cycles;
+    s_in_loop = true;
+    s_loop_start = esp_cpu_get_cycle_count();
+}
+
+void latency_wait_begin(void)
+{
+    if (s_in_loop) {
+        latency_hist_record(&s_loop_hist, esp_cpu_get_cycle_count() - s_loop_start);
+        s_in_loop = false;
+    }
+}
+
+void latency_led_changed(void)
+{
+    if (s_pending_type < 0) {
+        return;
+    }
+    latency_hist_record(&s_hist[s_pending_type], esp_cpu_get_cycle_count() - s_pending_cycles);
+    s_pending_type = -1;
+}
+
+static void dump_hist(const char *name, const latency_hist_t *hist, uint32_t cycles_per_us)
+{
+    if (hist->count == 0) {
+        printf("%s: no samples\n", name);
+        return;
+    }
+    printf("%s: %lu samples, min %.2f us, p50 %.2f us, p99 %.2f us, max %.2f us\n", name,
+           (unsigned long)hist->count, (double)hist->min / cycles_per_us,
+           (double)latency_hist_percentile(hist, 50) / cycles_per_us,
+           (double)latency_hist_percentile(hist, 99) / cycles_per_us, (double)hist->max / cycles_per_us);
+    for (int b = 0; b < LATENCY_HIST_NUM_BUCKETS; b++) {
+        if (hist->counts[b] == 0) {
+            continue;
+        }
+        uint32_t lower = latency_hist_bucket_lower(b);
+        uint32_t upper = b + 1 < LATENCY_HIST_NUM_BUCKETS ? latency_hist_bucket_lower(b + 1) : UINT32_MAX;
+        printf("  %10.2f - %10.2f us %8lu\n", (double)lower / cycles_per_us, (double)upper / cycles_per_us,
+               (unsigned long)hist->counts[b]);
+    }
+}
+
+static int cmd_latency(int argc, char **argv)
+{
+    uint32_t cpu_hz = 0;
+    esp_clk_tree_src_get_freq_hz(SOC_MOD_CLK_CPU, ESP_CLK_TREE_SRC_FREQ_PRECISION_CACHED, &cpu_hz);
+    uint32_t cycles_per_us = cpu_hz / 1000000;
+    if (cycles_per_us == 0) {
+        return 1;
+    }
+    printf("CPU at %lu MHz\n", (unsigned long)cycles_per_us);
+    dump_hist("edge -> LED", &s_hist[BUTTON_EVENT_EDGE], cycles_per_us);
+    dump_hist("deadline -> LED", &s_hist[BUTTON_EVENT_DEADLINE], cycles_per_us);
+    dump_hist("event loop", &s_loop_hist, cycles_per_us);
+    return 0;
+}
+
+static int cmd_latency_reset(int argc, char **argv)
+{
+    latency_hist_reset(&s_hist[BUTTON_EVENT_EDGE]);
+    latency_hist_reset(&s_hist[BUTTON_EVENT_DEADLINE]);
+    latency_hist_reset(&s_loop_hist);
+    return 0;
+}
+
+esp_err_t latency_init(void)
+{
+    cmd_latency_reset(0, NULL);
+
+    const esp_console_cmd_t commands[] = {
+        {
+            .command = "latency",
+            .help = "Dump the event to LED latency and event loop histograms",
+            .func = cmd_latency,
+        },
+        {
+            .command = "latency_reset",
+            .help = "Clear the latency histograms",
+            .func = cmd_latency_reset,
+        },
+    };
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        ESP_RETURN_ON_ERROR(esp_console_cmd_register(&commands[i]), TAG, "register command failed");
+    }
+
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = "lab1>";
+#if CONFIG_ESP_CONSOLE_UART_DEFAULT || CONFIG_ESP_CONSOLE_UART_CUSTOM
+    esp_console_dev_uart_config_t hw_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    ESP_RETURN_ON_ERROR(esp_console_new_repl_uart(&hw_config, &repl_config, &repl), TAG, "create UART REPL failed");
+#elif CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG
+    esp_console_dev_usb_serial_jtag_config_t hw_config = ESP_CONSOLE_DEV_USB_SERIAL_JTAG_CONFIG_DEFAULT();
+    ESP_RETURN_ON_ERROR(esp_console_new_repl_usb_serial_jtag(&hw_config, &repl_config, &repl), TAG, "create USB REPL failed");
+#elif CONFIG_ESP_CONSOLE_USB_CDC
+    esp_console_dev_usb_cdc_config_t hw_config = ESP_CONSOLE_DEV_CDC_CONFIG_DEFAULT();
+    ESP_RETURN_ON_ERROR(esp_console_new_repl_usb_cdc(&hw_config, &repl_config, &repl), TAG, "create USB CDC REPL failed");
+#endif
+    ESP_RETURN_ON_FALSE(repl, ESP_ERR_NOT_SUPPORTED, TAG, "no console to run the REPL on");
+    ESP_RETURN_ON_ERROR(esp_console_start_repl(repl), TAG, "start REPL failed");
+    ESP_LOGI(TAG, "Type 'latency' to dump the event to LED latency histograms");
+    return ESP_OK;
+}
@@ -0,0 +1,48 @@
+/* Event-to-LED latency instrumentation
+
+   Every button event carries the CPU cycle count of its ISR (edge) or timer
+   callback (deadline). The first LED change made while handling the event
+   records the elapsed cycles in a log-scale histogram, one for edges and
+   one for deadlines. A third histogram holds the cycles the loop spends on
+   an event, from button_events_wait() returning to its next call, which is
+   what CONFIG_LAB1_DEFERRED_LOG shortens. The "latency" console command
+   dumps min/p50/p99/max and the buckets, "latency_reset" starts over.
+
+   Without CONFIG_LAB1_LATENCY_HIST the hooks compile to nothing.
+*/
+#pragma once
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "button_events.h"
+
+#if CONFIG_LAB1_LATENCY_HIST
+// Register the console commands and start the console REPL
+esp_err_t latency_init(void);
+
+// The task starts handling evt, called by button_events_wait()
+void latency_event_received(const button_event_t *evt);
+
+// The task is done with the previous event, called by button_events_wait()
+void latency_wait_begin(void);
+
+// The LED output just changed, call it right after gpio_set_level()
+void latency_led_changed(void);
+#else
+static inline esp_err_t latency_init(void)
+{
+    return ESP_OK;
+}
+
+static inline void latency_event_received(const button_event_t *evt)
+{
+}
+
+static inline void latency_wait_begin(void)
+{
+}
+
+static inline void latency_led_changed(void)
+{
+}
+#endif
@@ -0,0 +1,175 @@
+/* Fixed-rate player of led_anim animations on an LED strip
+*/
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "driver/gptimer.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "led_anim_player.h"
+
+static const char *TAG = "led_anim_player";
+
+#define PLAYER_STACK_SIZE 4096
+#define PLAYER_TIMER_RESOLUTION_HZ 1000000
+
+static led_anim_player_config_t s_config;
+static gptimer_handle_t s_timer = NULL;
+static TaskHandle_t s_task = NULL;
+static SemaphoreHandle_t s_anim_lock = NULL;
+static uint8_t *s_frame = NULL;             // Rendered pixels, R, G, B
+static volatile bool s_stopping;
+static TaskHandle_t s_stopper = NULL;       // Task waiting for the player to exit
+static led_anim_stats_t s_stats;
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile int64_t s_wire_end_us;      // Set by the done callback of the strip
+
+static bool IRAM_ATTR on_frame_slot(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_ctx)
+{
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_task, &woken);
+    return woken == pdTRUE;
+}
+
+static bool IRAM_ATTR on_refresh_done(led_strip_handle_t strip, void *user_ctx)
+{
+    s_wire_end_us = esp_timer_get_time();
+    return false;
+}
+
+static void player_task(void *arg)
+{
+    int64_t period_us = 1000000 / s_config.frame_rate_hz;
+    int64_t slot = -1;     // the first notification is for the frame at time 0
+    int64_t wire_start_us = 0;
+    bool on_wire = false;
+    while (!s_stopping) {
+        // More than one notification: the slots in between were missed
+        uint32_t slots = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (s_stopping) {
+            break;
+        }
+        slot += slots;
+
+        int64_t start_us = esp_timer_get_time();
+        xSemaphoreTake(s_anim_lock, portMAX_DELAY);
+        led_anim_render(s_config.anim, slot * period_us, s_frame);
+        xSemaphoreGive(s_anim_lock);
+        uint32_t render_us = esp_timer_get_time() - start_us;
+
+        // The strip may still send the previous frame from the buffer set_pixels writes to
+        if (on_wire) {
+            led_strip_refresh_wait_done(s_config.strip, -1);
+        }
+        led_strip_set_pixels(s_config.strip, 0, s_config.anim->num_leds, s_frame);
+        int64_t refresh_us = esp_timer_get_time();
+        portENTER_CRITICAL(&s_stats_lock);
+        led_anim_stats_add_frame(&s_stats, render_us, slots - 1);
+        if (on_wire) {
+            led_anim_stats_add_wire(&s_stats, s_wire_end_us - wire_start_us);
+        }
+        portEXIT_CRITICAL(&s_stats_lock);
+        wire_start_us = refresh_us;
+        on_wire = led_strip_refresh_async(s_config.strip) == ESP_OK;
+    }
+    if (on_wire) {
+        led_strip_refresh_wait_done(s_config.strip, -1);
+    }
+    xTaskNotifyGive(s_stopper);
+    vTaskDelete(NULL);
+}
+
+esp_err_t led_anim_player_start(const led_anim_player_config_t *config)
+{
+    ESP_RETURN_ON_FALSE(config && config->strip && config->anim && config->anim->num_leds, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(config->frame_rate_hz && config->frame_rate_hz <= PLAYER_TIMER_RESOLUTION_HZ / 1000, ESP_ERR_INVALID_ARG, TAG,
+                        "frame rate out of range");
+    ESP_RETURN_ON_FALSE(s_task == NULL, ESP_ERR_INVALID_STATE, TAG, "already playing");
+    esp_err_t ret = ESP_OK;
+    s_config = *config;
+    s_stopping = false;
+    led_anim_stats_reset(&s_stats);
+
+    const led_strip_event_callbacks_t cbs = {
+        .on_refresh_done = on_refresh_done,
+    };
+    ESP_RETURN_ON_ERROR(led_strip_register_event_callbacks(config->strip, &cbs, NULL), TAG, "register strip callbacks failed");
+    s_frame = malloc(config->anim->num_leds * 3);
+    s_anim_lock = xSemaphoreCreateMutex();
+    ESP_GOTO_ON_FALSE(s_frame && s_anim_lock, ESP_ERR_NO_MEM, err, TAG, "no mem for player");
+    ESP_GOTO_ON_FALSE(xTaskCreatePinnedToCore(player_task, "led_anim", PLAYER_STACK_SIZE, NULL, config->priority, &s_task,
+                                              config->core_id) == pdPASS, ESP_ERR_NO_MEM, err, TAG, "create player task failed");
+
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = PLAYER_TIMER_RESOLUTION_HZ,
+    };
+    ESP_GOTO_ON_ERROR(gptimer_new_timer(&timer_config, &s_timer), err, TAG, "create frame timer failed");
+    gptimer_event_callbacks_t timer_cbs = {
+        .on_alarm = on_frame_slot,
+    };
+    ESP_GOTO_ON_ERROR(gptimer_register_event_callbacks(s_timer, &timer_cbs, NULL), err, TAG, "register timer callback failed");
+    gptimer_alarm_config_t alarm_config = {
+        .alarm_count = PLAYER_TIMER_RESOLUTION_HZ / config->frame_rate_hz,
+        .reload_count = 0,
+        .flags.auto_reload_on_alarm = true,
+    };
+    ESP_GOTO_ON_ERROR(gptimer_set_alarm_action(s_timer, &alarm_config), err, TAG, "set frame alarm failed");
+    ESP_GOTO_ON_ERROR(gptimer_enable(s_timer), err, TAG, "enable frame timer failed");
+    ESP_GOTO_ON_ERROR(gptimer_start(s_timer), err, TAG, "start frame timer failed");
+    // the first frame without waiting for the first alarm
+    xTaskNotifyGive(s_task);
+    return ESP_OK;
+err:
+    led_anim_player_stop();
+    return ret;
+}
+
+esp_err_t led_anim_player_stop(void)
+{
+    if (s_timer) {
+        // disable fails if the timer was never started, it is deleted anyway
+        gptimer_stop(s_timer);
+        gptimer_disable(s_timer);
+        gptimer_del_timer(s_timer);
+        s_timer = NULL;
+    }
+    if (s_task) {
+        s_stopper = xTaskGetCurrentTaskHandle();
+        s_stopping = true;
+        xTaskNotifyGive(s_task);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        s_task = NULL;
+    }
+    if (s_anim_lock) {
+        vSemaphoreDelete(s_anim_lock);
+        s_anim_lock = NULL;
+    }
+    free(s_frame);
+    s_frame = NULL;
+    return ESP_OK;
+}
+
+void led_anim_player_lock(void)
+{
+    xSemaphoreTake(s_anim_lock, portMAX_DELAY);
+}
+
+void led_anim_player_unlock(void)
+{
+    xSemaphoreGive(s_anim_lock);
+}
+
+void led_anim_player_get_stats(led_anim_stats_t *stats, bool reset)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    *stats = s_stats;
+    if (reset) {
+        led_anim_stats_reset(&s_stats);
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+}
@@ -0,0 +1,41 @@
+/* Fixed-rate player of led_anim animations on an LED strip
+
+   A gptimer alarm wakes the player task once per frame slot. The task
+   renders the animation for the time of the slot, waits for the previous
+   frame to leave the wire, hands the pixels to the strip and starts an
+   asynchronous refresh, so a frame is rendered while the previous one is
+   transmitted. Slots that pass while the task is still busy are dropped
+   and counted, and the animation time stays on the slot grid.
+
+   The render time of each frame and its wire time, from the start of the
+   refresh to the done callback of the strip, are kept in led_anim_stats_t.
+   One player at a time.
+*/
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+#include "led_strip.h"
+#include "led_anim.h"
+
+typedef struct {
+    led_strip_handle_t strip;   // At least anim->num_leds pixels, its event callbacks are taken over
+    led_anim_t *anim;           // Read by the player task, change it under led_anim_player_lock()
+    uint32_t frame_rate_hz;
+    BaseType_t core_id;         // Core of the player task, tskNO_AFFINITY for any
+    UBaseType_t priority;
+} led_anim_player_config_t;
+
+// Create the player task and start the frame timer
+esp_err_t led_anim_player_start(const led_anim_player_config_t *config);
+
+// Stop the timer and delete the task, once the frame in progress is sent
+esp_err_t led_anim_player_stop(void);
+
+// Keep the player from rendering while the layers are changed
+void led_anim_player_lock(void);
+void led_anim_player_unlock(void);
+
+// Copy of the statistics since the start or the last reset
+void led_anim_player_get_stats(led_anim_stats_t *stats, bool reset);
@@ -0,0 +1,179 @@
+/* LED pattern sequencer on the RMT TX peripheral
+*/
+#include <string.h>
+#include <ctype.h>
+#include "driver/rmt_tx.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "led_pattern.h"
+
+static const char *TAG = "led_pattern";
+
+#define MS_TO_TICKS(ms) ((uint32_t)(ms) * (LED_PATTERN_RESOLUTION_HZ / 1000))
+#define MAX_HALF_TICKS 0x7FFF   // duration0/duration1 are 15-bit fields
+
+static rmt_channel_handle_t s_chan = NULL;
+static rmt_encoder_handle_t s_copy_encoder = NULL;
+static led_pattern_t s_playing;     // The hardware reads from here while playing
+
+// Pattern under construction: a list of (level, ticks) halves packed two per symbol
+typedef struct {
+    led_pattern_t *pattern;
+    size_t halves;
+} builder_t;
+
+static esp_err_t push_half(builder_t *b, uint8_t level, uint32_t ticks)
+{
+    ESP_RETURN_ON_FALSE(b->halves < LED_PATTERN_MAX_SYMBOLS * 2, ESP_ERR_INVALID_SIZE, TAG, "pattern too long");
+    rmt_symbol_word_t *sym = &b->pattern->symbols[b->halves / 2];
+    if (b->halves % 2 == 0) {
+        sym->level0 = level;
+        sym->duration0 = ticks;
+    } else {
+        sym->level1 = level;
+        sym->duration1 = ticks;
+    }
+    b->halves++;
+    return ESP_OK;
+}
+
+// Append a level held for ms, split into as many halves as the 15-bit durations need
+static esp_err_t push_level(builder_t *b, uint8_t level, uint32_t ms)
+{
+    uint32_t ticks = MS_TO_TICKS(ms);
+    while (ticks) {
+        uint32_t chunk = ticks > MAX_HALF_TICKS ? MAX_HALF_TICKS : ticks;
+        ESP_RETURN_ON_ERROR(push_half(b, level, chunk), TAG, "push level failed");
+        ticks -= chunk;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t finish(builder_t *b)
+{
+    ESP_RETURN_ON_FALSE(b->halves, ESP_ERR_INVALID_ARG, TAG, "empty pattern");
+    if (b->halves % 2) {
+        // A zero duration would end the transmission: split the last half in two instead
+        rmt_symbol_word_t *sym = &b->pattern->symbols[b->halves / 2];
+        uint32_t ticks = sym->duration0;
+        ESP_RETURN_ON_FALSE(ticks >= 2, ESP_ERR_INVALID_ARG, TAG, "last step too short");
+        sym->duration0 = ticks / 2;
+        sym->level1 = sym->level0;
+        sym->duration1 = ticks - ticks / 2;
+        b->halves++;
+    }
+    b->pattern->num_symbols = b->halves / 2;
+    return ESP_OK;
+}
+
+esp_err_t led_pattern_compile_steps(led_pattern_t *pattern, const uint32_t *durations_ms, size_t count)
+{
+    ESP_RETURN_ON_FALSE(pattern && durations_ms, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    builder_t b = { .pattern = pattern };
+    for (size_t i = 0; i < count; i++) {
+        ESP_RETURN_ON_ERROR(push_level(&b, i % 2 == 0, durations_ms[i]), TAG, "compile step %d failed", (int)i);
+    }
+    return finish(&b);
+}
+
+esp_err_t led_pattern_compile_blink(led_pattern_t *pattern, uint32_t period_ms, uint8_t duty_percent)
+{
+    ESP_RETURN_ON_FALSE(duty_percent > 0 && duty_percent < 100, ESP_ERR_INVALID_ARG, TAG, "duty must be 1..99%%");
+    uint32_t steps[2] = {
+        period_ms * duty_percent / 100,
+        period_ms - period_ms * duty_percent / 100,
+    };
+    return led_pattern_compile_steps(pattern, steps, 2);
+}
+
+esp_err_t led_pattern_compile_morse(led_pattern_t *pattern, const char *text, uint32_t unit_ms)
+{
+    static const char *const letters[26] = {
+        ".-", "-...", "-.-.", "-..", ".", "..-.", "--.", "....", "..", ".---", "-.-", ".-..", "--",
+        "-.", "---", ".--.", "--.-", ".-.", "...", "-", "..-", "...-", ".--", "-..-", "-.--", "--..",
+    };
+    static const char *const digits[10] = {
+        "-----", ".----", "..---", "...--", "....-", ".....", "-....", "--...", "---..", "----.",
+    };
+    ESP_RETURN_ON_FALSE(pattern && text, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    builder_t b = { .pattern = pattern };
+    for (const char *c = text; *c; c++) {
+        const char *code = NULL;
+        if (isalpha((unsigned char)*c)) {
+            code = letters[toupper((unsigned char)*c) - 'A'];
+        } else if (isdigit((unsigned char)*c)) {
+            code = digits[*c - '0'];
+        } else if (*c == ' ') {
+            // Word gap is 7 units, 3 of them are already the letter gap
+            ESP_RETURN_ON_ERROR(push_level(&b, 0, 4 * unit_ms), TAG, "pattern too long");
+            continue;
+        } else {
+            ESP_RETURN_ON_FALSE(false, ESP_ERR_INVALID_ARG, TAG, "no Morse code for '%c'", *c);
+        }
+        for (const char *m = code; *m; m++) {
+            ESP_RETURN_ON_ERROR(push_level(&b, 1, (*m == '-' ? 3 : 1) * unit_ms), TAG, "pattern too long");
+            // 1 unit between marks, 3 after the letter
+            ESP_RETURN_ON_ERROR(push_level(&b, 0, (m[1] ? 1 : 3) * unit_ms), TAG, "pattern too long");
+        }
+    }
+    return finish(&b);
+}
+
+esp_err_t led_pattern_init(gpio_num_t gpio)
+{
+    ESP_RETURN_ON_FALSE(s_chan == NULL, ESP_ERR_INVALID_STATE, TAG, "already initialized");
+    rmt_tx_channel_config_t chan_config = {
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .gpio_num = gpio,
+        .mem_block_symbols = LED_PATTERN_MEM_SYMBOLS,
+        .resolution_hz = LED_PATTERN_RESOLUTION_HZ,
+        .trans_queue_depth = 2,
+    };
+    ESP_RETURN_ON_ERROR(rmt_new_tx_channel(&chan_config, &s_chan), TAG, "create RMT TX channel failed");
+    rmt_copy_encoder_config_t copy_config = {};
+    ESP_RETURN_ON_ERROR(rmt_new_copy_encoder(&copy_config, &s_copy_encoder), TAG, "create copy encoder failed");
+    ESP_RETURN_ON_ERROR(rmt_enable(s_chan), TAG, "enable RMT channel failed");
+    ESP_LOGI(TAG, "LED patterns on GPIO%d", gpio);
+    return led_pattern_set(0);
+}
+
+// Abort the transmission in progress, O(1) whatever the pattern length
+static esp_err_t abort_playing(void)
+{
+    ESP_RETURN_ON_FALSE(s_chan, ESP_ERR_INVALID_STATE, TAG, "not initialized");
+    ESP_RETURN_ON_ERROR(rmt_disable(s_chan), TAG, "disable RMT channel failed");
+    ESP_RETURN_ON_ERROR(rmt_enable(s_chan), TAG, "enable RMT channel failed");
+    return ESP_OK;
+}
+
+esp_err_t led_pattern_play(const led_pattern_t *pattern, int repeat)
+{
+    ESP_RETURN_ON_FALSE(pattern && pattern->num_symbols && (repeat > 0 || repeat == LED_PATTERN_FOREVER),
+                        ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_ERROR(abort_playing(), TAG, "stop previous pattern failed");
+    memcpy(&s_playing, pattern, sizeof(s_playing));
+    rmt_transmit_config_t tx_config = {
+        .loop_count = repeat == 1 ? 0 : repeat,
+        .flags.eot_level = 0,
+    };
+    return rmt_transmit(s_chan, s_copy_encoder, s_playing.symbols,
+                        s_playing.num_symbols * sizeof(rmt_symbol_word_t), &tx_config);
+}
+
+esp_err_t led_pattern_set(uint8_t level)
+{
+    ESP_RETURN_ON_ERROR(abort_playing(), TAG, "stop pattern failed");
+    // Shortest possible transmission, the channel then idles at eot_level
+    s_playing.symbols[0] = (rmt_symbol_word_t) {
+        .level0 = level,
+        .duration0 = 1,
+        .level1 = level,
+        .duration1 = 1,
+    };
+    s_playing.num_symbols = 1;
+    rmt_transmit_config_t tx_config = {
+        .loop_count = 0,
+        .flags.eot_level = level,
+    };
+    return rmt_transmit(s_chan, s_copy_encoder, s_playing.symbols, sizeof(rmt_symbol_word_t), &tx_config);
+}
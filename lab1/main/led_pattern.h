@@ -0,0 +1,44 @@
+/* LED pattern sequencer on the RMT TX peripheral
+
+   A pattern (blink, on/off steps, Morse text) is compiled once into RMT
+   symbols and played by the hardware with loop_count, so the CPU does not
+   toggle the LED and the calling task can stay blocked while it blinks.
+   Once initialized, the LED GPIO belongs to the RMT channel: use
+   led_pattern_set() instead of gpio_set_level().
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "driver/gpio.h"
+#include "driver/rmt_types.h"
+#include "esp_err.h"
+
+#define LED_PATTERN_RESOLUTION_HZ 10000     // 0.1ms per RMT tick
+#define LED_PATTERN_MEM_SYMBOLS 48          // RMT channel memory, a looped pattern must fit in it
+#define LED_PATTERN_MAX_SYMBOLS (LED_PATTERN_MEM_SYMBOLS - 1)   // One slot is kept for the end marker
+#define LED_PATTERN_FOREVER -1              // Repeat until stopped
+
+// Pattern compiled to RMT symbols
+typedef struct {
+    rmt_symbol_word_t symbols[LED_PATTERN_MAX_SYMBOLS];
+    size_t num_symbols;
+} led_pattern_t;
+
+// Create the RMT channel driving the LED on gpio, LED off
+esp_err_t led_pattern_init(gpio_num_t gpio);
+
+// Square wave: period_ms long, ON for duty_percent of it
+esp_err_t led_pattern_compile_blink(led_pattern_t *pattern, uint32_t period_ms, uint8_t duty_percent);
+
+// Alternating ON/OFF durations, starting with ON
+esp_err_t led_pattern_compile_steps(led_pattern_t *pattern, const uint32_t *durations_ms, size_t count);
+
+// Morse code of text (letters, digits, spaces), unit_ms being the length of a dot
+esp_err_t led_pattern_compile_morse(led_pattern_t *pattern, const char *text, uint32_t unit_ms);
+
+// Play pattern repeat times (LED_PATTERN_FOREVER for ever), replacing what is playing. Returns immediately
+esp_err_t led_pattern_play(const led_pattern_t *pattern, int repeat);
+
+// Stop any pattern and hold the LED at level
+esp_err_t led_pattern_set(uint8_t level);
@@ -0,0 +1,249 @@
+/* Multi-channel controller: N buttons and LEDs served by one task
+
+   Channel n reads the nth GPIO of CONFIG_LAB1_MULTI_BUTTON_GPIOS and drives
+   the nth one of CONFIG_LAB1_MULTI_LED_GPIOS, every channel running case C.
+   The pins are checked before anything is configured: the console UART and
+   SPI flash pins are refused, and every pin must be below GPIO32 to be
+   read and written through one register. Each scan samples the buttons with the keypad
+   scanner, which debounces the whole GPIO input register in parallel, updates the struct-of-arrays button bank
+   and writes the LED changes with one set and one clear register write.
+   Virtual channels driven by a random presser extend the bank up to 64
+   channels, to see how the cost scales on the chip.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#include "soc/spi_pins.h"
+#include "soc/uart_pins.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "keypad.h"
+#include "button_bank.h"
+
+static const char *TAG = "multi";
+
+#define SCAN_PERIOD_MS 10           // Debounced over DEBOUNCE_SAMPLES scans
+#define REPORT_PERIOD_MS 10000      // Per channel CPU time report
+
+#define MAX_PHYSICAL_CHANNELS 16
+
+// Pins the demo must never reconfigure: the console and the SPI flash
+#define RESERVED_GPIO_MASK ((1ULL << U0TXD_GPIO_NUM) | (1ULL << U0RXD_GPIO_NUM) | \
+                            (1ULL << SPI_IOMUX_PIN_NUM_CS) | (1ULL << SPI_IOMUX_PIN_NUM_CLK) | \
+                            (1ULL << SPI_IOMUX_PIN_NUM_MOSI) | (1ULL << SPI_IOMUX_PIN_NUM_MISO) | \
+                            (1ULL << SPI_IOMUX_PIN_NUM_WP) | (1ULL << SPI_IOMUX_PIN_NUM_HD))
+
+// Physical channels, active high buttons with pull-down
+static uint8_t s_button_gpios[MAX_PHYSICAL_CHANNELS];
+static uint8_t s_led_gpios[MAX_PHYSICAL_CHANNELS];
+static int s_physical_channels;
+static int s_num_channels;
+
+static button_bank_t s_bank;
+static keypad_t s_keypad;
+
+// Virtual channels: each one keeps its level for a random number of scans
+static uint32_t s_rng = 0x1234567;
+static uint64_t s_virtual_levels = 0;
+static uint16_t s_virtual_hold[BUTTON_BANK_MAX_CHANNELS];
+
+static uint32_t rng_next(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static uint64_t virtual_buttons(void)
+{
+    for (int i = s_physical_channels; i < s_num_channels; i++) {
+        if (s_virtual_hold[i] == 0) {
+            s_virtual_levels ^= 1ULL << i;
+            // Presses and gaps of 10 ms to 2 s
+            s_virtual_hold[i] = 1 + rng_next() % (2000 / SCAN_PERIOD_MS);
+        }
+        s_virtual_hold[i]--;
+    }
+    return s_virtual_levels;
+}
+
+// Comma separated GPIO numbers of a Kconfig list, returns how many or -1 when malformed
+static int parse_gpios(const char *list, uint8_t *gpios)
+{
+    int count = 0;
+    const char *p = list;
+    while (*p) {
+        char *end;
+        long gpio = strtol(p, &end, 10);
+        if (end == p || gpio < 0 || gpio > UINT8_MAX || count == MAX_PHYSICAL_CHANNELS) {
+            return -1;
+        }
+        gpios[count++] = gpio;
+        for (p = end; *p == ' '; p++) {
+        }
+        if (*p == ',') {
+            p++;
+        } else if (*p) {
+            return -1;
+        }
+    }
+    return count;
+}
+
+// Pins are read and written through GPIO_IN_REG and GPIO_OUT_W1TS/W1TC_REG, which only cover GPIO0..GPIO31
+static bool check_gpio(int gpio, bool output, uint64_t *used)
+{
+    const char *what = output ? "LED" : "button";
+    if (gpio >= 32 || !(output ? GPIO_IS_VALID_OUTPUT_GPIO(gpio) : GPIO_IS_VALID_GPIO(gpio))) {
+        ESP_LOGE(TAG, "%s GPIO%d is not a valid %s below GPIO32", what, gpio, output ? "output" : "input");
+        return false;
+    }
+    if ((RESERVED_GPIO_MASK >> gpio) & 1) {
+        ESP_LOGE(TAG, "%s GPIO%d drives the console UART or the SPI flash", what, gpio);
+        return false;
+    }
+    if ((*used >> gpio) & 1) {
+        ESP_LOGE(TAG, "%s GPIO%d is used twice", what, gpio);
+        return false;
+    }
+    *used |= 1ULL << gpio;
+    return true;
+}
+
+static bool load_gpios(void)
+{
+    int buttons = parse_gpios(CONFIG_LAB1_MULTI_BUTTON_GPIOS, s_button_gpios);
+    int leds = parse_gpios(CONFIG_LAB1_MULTI_LED_GPIOS, s_led_gpios);
+    if (buttons <= 0 || leds != buttons) {
+        ESP_LOGE(TAG, "Need 1 to %d button GPIOs and as many LED GPIOs, got \"%s\" and \"%s\"",
+                 MAX_PHYSICAL_CHANNELS, CONFIG_LAB1_MULTI_BUTTON_GPIOS, CONFIG_LAB1_MULTI_LED_GPIOS);
+        return false;
+    }
+    uint64_t used = 0;
+    for (int i = 0; i < buttons; i++) {
+        if (!check_gpio(s_button_gpios[i], false, &used) || !check_gpio(s_led_gpios[i], true, &used)) {
+            return false;
+        }
+    }
+    s_physical_channels = buttons;
+    s_num_channels = buttons + CONFIG_LAB1_MULTI_VIRTUAL_CHANNELS;
+    return true;
+}
+
+static void configure_gpios(void)
+{
+    uint32_t button_mask = 0;
+    uint64_t led_mask = 0;
+    for (int i = 0; i < s_physical_channels; i++) {
+        button_mask |= 1u << s_button_gpios[i];
+        led_mask |= 1ULL << s_led_gpios[i];
+    }
+    // Active high buttons with pull-down
+    ESP_ERROR_CHECK(keypad_init(&s_keypad, button_mask, 0));
+    gpio_config_t io_conf = {
+        .pin_bit_mask = led_mask,
+        .mode = GPIO_MODE_OUTPUT,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    ESP_ERROR_CHECK(gpio_config(&io_conf));
+    REG_WRITE(GPIO_OUT_W1TC_REG, (uint32_t)led_mask);
+}
+
+// Physical LEDs that changed, written with one set and one clear
+static void write_leds(uint64_t leds, uint64_t changed)
+{
+    uint32_t set = 0;
+    uint32_t clear = 0;
+    for (int i = 0; i < s_physical_channels; i++) {
+        if ((changed >> i) & 1) {
+            if ((leds >> i) & 1) {
+                set |= 1u << s_led_gpios[i];
+            } else {
+                clear |= 1u << s_led_gpios[i];
+            }
+        }
+    }
+    REG_WRITE(GPIO_OUT_W1TS_REG, set);
+    REG_WRITE(GPIO_OUT_W1TC_REG, clear);
+}
+
+static void report(uint32_t scans, uint64_t scan_cycles, uint32_t max_scan_cycles)
+{
+    uint32_t mhz = esp_rom_get_cpu_ticks_per_us();
+    ESP_LOGI(TAG, "%d channels, %" PRIu32 " scans: %" PRIu64 " cycles/scan avg, %" PRIu32 " max (%.2f us)",
+             s_num_channels, scans, scan_cycles / scans, max_scan_cycles, (double)max_scan_cycles / mhz);
+    for (int i = 0; i < s_num_channels; i++) {
+        if (s_bank.steps[i]) {
+            ESP_LOGI(TAG, "  channel %2d%s: %5" PRIu32 " steps, %5" PRIu32 " cycles/step, %.3f%% CPU",
+                     i, i < s_physical_channels ? "" : "v", s_bank.steps[i], s_bank.cycles[i] / s_bank.steps[i],
+                     s_bank.cycles[i] * 100.0 / ((double)REPORT_PERIOD_MS * 1000 * mhz));
+        }
+    }
+    button_bank_reset_cycles(&s_bank);
+}
+
+void app_main(void)
+{
+    if (!load_gpios()) {
+        return;
+    }
+    configure_gpios();
+    button_case_ctx_t config = BUTTON_CASE_CTX_DEFAULT();
+    if (!button_bank_init(&s_bank, BUTTON_CASE_C, &config, s_num_channels)) {
+        ESP_LOGE(TAG, "Invalid bank of %d channels", s_num_channels);
+        return;
+    }
+    s_bank.get_cycles = esp_cpu_get_cycle_count;
+    ESP_LOGI(TAG, "Starting %d channels (%d virtual), scan every %d ms", s_num_channels,
+             CONFIG_LAB1_MULTI_VIRTUAL_CHANNELS, SCAN_PERIOD_MS);
+
+    const uint64_t physical_mask = (1ULL << s_physical_channels) - 1;
+    uint64_t leds = 0;
+    uint32_t scans = 0;
+    uint64_t scan_cycles = 0;
+    uint32_t max_scan_cycles = 0;
+    int64_t report_start = esp_timer_get_time();
+    TickType_t last_wake = xTaskGetTickCount();
+    while (1) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(SCAN_PERIOD_MS));
+        uint32_t start = esp_cpu_get_cycle_count();
+        int64_t now = esp_timer_get_time();
+
+        // One register read samples every physical button at the same instant
+        keypad_scan(&s_keypad);
+        uint32_t pressed = keypad_state(&s_keypad);
+        uint64_t buttons = virtual_buttons();
+        for (int i = 0; i < s_physical_channels; i++) {
+            buttons |= (uint64_t)((pressed >> s_button_gpios[i]) & 1) << i;
+        }
+
+        uint64_t new_leds = button_bank_update(&s_bank, buttons, now);
+        if ((new_leds ^ leds) & physical_mask) {
+            write_leds(new_leds, new_leds ^ leds);
+        }
+        leds = new_leds;
+
+        uint32_t cycles = esp_cpu_get_cycle_count() - start;
+        scans++;
+        scan_cycles += cycles;
+        if (cycles > max_scan_cycles) {
+            max_scan_cycles = cycles;
+        }
+        if (now - report_start >= (int64_t)REPORT_PERIOD_MS * 1000) {
+            report(scans, scan_cycles, max_scan_cycles);
+            scans = 0;
+            scan_cycles = 0;
+            max_scan_cycles = 0;
+            report_start = now;
+        }
+    }
+}
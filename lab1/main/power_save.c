@@ -0,0 +1,95 @@
+/* Automatic light sleep between button events
+*/
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "power_save.h"
+
+static const char *TAG = "power_save";
+
+// Updated by the light sleep callbacks, interrupts disabled
+static volatile int64_t s_asleep_us = 0;        // Total time in light sleep
+static volatile uint32_t s_sleeps = 0;          // Light sleep periods
+static volatile int64_t s_wake_us = 0;          // Last wake-up, 0 once handled
+
+// Wake-to-action latency, updated by the event task
+static uint32_t s_actions = 0;
+static int64_t s_latency_max_us = 0;
+static int64_t s_latency_sum_us = 0;
+static int64_t s_report_start_us = 0;
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+// sleep_time_us is the time actually spent asleep
+static esp_err_t IRAM_ATTR light_sleep_exit_cb(int64_t sleep_time_us, void *arg)
+{
+    s_asleep_us += sleep_time_us;
+    s_sleeps++;
+    s_wake_us = esp_timer_get_time();
+    return ESP_OK;
+}
+#endif
+
+esp_err_t power_save_init(gpio_num_t led_gpio)
+{
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_XTAL_FREQ,
+        .light_sleep_enable = true,
+    };
+    ESP_RETURN_ON_ERROR(esp_pm_configure(&pm_config), TAG, "configure power management failed");
+    ESP_RETURN_ON_ERROR(esp_sleep_enable_gpio_wakeup(), TAG, "enable GPIO wakeup failed");
+    // The LED keeps its level while asleep, a blink sleeps between toggles
+    ESP_RETURN_ON_ERROR(gpio_sleep_sel_dis(led_gpio), TAG, "disable LED sleep configuration failed");
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+    esp_pm_sleep_cbs_register_config_t cbs_config = {
+        .exit_cb = light_sleep_exit_cb,
+    };
+    ESP_RETURN_ON_ERROR(esp_pm_light_sleep_register_cbs(&cbs_config), TAG, "register sleep callbacks failed");
+#else
+    ESP_LOGW(TAG, "CONFIG_PM_LIGHT_SLEEP_CALLBACKS disabled, no sleep statistics");
+#endif
+    s_report_start_us = esp_timer_get_time();
+    ESP_LOGI(TAG, "Automatic light sleep enabled, CPU %d-%d MHz", pm_config.min_freq_mhz, pm_config.max_freq_mhz);
+    return ESP_OK;
+}
+
+void power_save_event_received(int64_t now_us)
+{
+    int64_t wake_us = s_wake_us;
+    // wake_us is 0 when the chip did not sleep since the previous event
+    if (wake_us) {
+        s_wake_us = 0;
+        int64_t latency = now_us - wake_us;
+        s_actions++;
+        s_latency_sum_us += latency;
+        if (latency > s_latency_max_us) {
+            s_latency_max_us = latency;
+        }
+    }
+    // Reported from here so that the statistics never wake the chip up themselves
+    if (now_us - s_report_start_us >= (int64_t)POWER_SAVE_REPORT_PERIOD_MS * 1000) {
+        power_save_report();
+    }
+}
+
+void power_save_report(void)
+{
+    int64_t now = esp_timer_get_time();
+    int64_t elapsed = now - s_report_start_us;
+    int64_t asleep = s_asleep_us;
+    ESP_LOGI(TAG, "Asleep %lld of %lld ms (%d%%) in %lu sleeps, wake-to-action avg %lld us max %lld us over %lu wake-ups",
+             (long long)(asleep / 1000), (long long)(elapsed / 1000), elapsed ? (int)(asleep * 100 / elapsed) : 0,
+             (unsigned long)s_sleeps, (long long)(s_actions ? s_latency_sum_us / s_actions : 0),
+             (long long)s_latency_max_us, (unsigned long)s_actions);
+    s_asleep_us = 0;
+    s_sleeps = 0;
+    s_actions = 0;
+    s_latency_max_us = 0;
+    s_latency_sum_us = 0;
+    s_report_start_us = now;
+}
@@ -0,0 +1,26 @@
+/* Automatic light sleep between button events
+
+   esp_pm drops the CPU to the XTAL frequency and enters light sleep
+   whenever every task is blocked. The button GPIO is a level wakeup source
+   and the esp_timer deadlines wake the chip on their own, so the state
+   machines keep working unchanged. Light sleep callbacks account the time
+   spent asleep and the latency from a wake-up to the task handling the
+   event that caused it.
+*/
+#pragma once
+
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "esp_err.h"
+
+#define POWER_SAVE_REPORT_PERIOD_MS 60000  // Statistics are logged on the first event after this period
+
+// Enable automatic light sleep and GPIO wakeup, led_gpio keeping its level while asleep.
+// The button GPIO itself is armed by button_events
+esp_err_t power_save_init(gpio_num_t led_gpio);
+
+// Called by the event task for every event it receives, at now_us. Logs the report when due
+void power_save_event_received(int64_t now_us);
+
+// Log the time asleep and the wake-to-action latencies since the previous report
+void power_save_report(void);
@@ -0,0 +1,132 @@
+/* Show demo on the LED strip
+
+   A run-length encoded show, packed on the host with led_strip_rle_pack.py,
+   is mapped from the data partition CONFIG_LAB1_SHOW_PARTITION and played
+   in a loop on the strip of CONFIG_BLINK_GPIO. The runs are decoded by the
+   RMT encoder while each frame is on the wire, so the show is never copied
+   to RAM and the CPU only starts each frame. The frames are timed by a
+   gptimer at the period of the show, and the frames of missed slots are
+   skipped so that the show keeps its pace. Every 5 s the frames sent and
+   the slots missed are logged.
+*/
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gptimer.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "led_strip.h"
+
+static const char *TAG = "show";
+
+#define STATS_PERIOD_US 5000000
+#define SHOW_TIMER_RESOLUTION_HZ 1000000
+
+static TaskHandle_t s_task;
+
+static bool IRAM_ATTR on_frame_slot(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_ctx)
+{
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_task, &woken);
+    return woken == pdTRUE;
+}
+
+static void start_frame_timer(uint32_t period_us)
+{
+    gptimer_handle_t timer = NULL;
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = SHOW_TIMER_RESOLUTION_HZ,
+    };
+    ESP_ERROR_CHECK(gptimer_new_timer(&timer_config, &timer));
+    gptimer_event_callbacks_t timer_cbs = {
+        .on_alarm = on_frame_slot,
+    };
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(timer, &timer_cbs, NULL));
+    // 1 tick per microsecond, the period of the show exactly
+    gptimer_alarm_config_t alarm_config = {
+        .alarm_count = period_us,
+        .reload_count = 0,
+        .flags.auto_reload_on_alarm = true,
+    };
+    ESP_ERROR_CHECK(gptimer_set_alarm_action(timer, &alarm_config));
+    ESP_ERROR_CHECK(gptimer_enable(timer));
+    ESP_ERROR_CHECK(gptimer_start(timer));
+}
+
+static led_strip_handle_t configure_strip(const led_strip_rle_show_t *show)
+{
+    ESP_LOGI(TAG, "Configuring a strip of %lu LEDs on GPIO%d", (unsigned long)show->num_leds, CONFIG_BLINK_GPIO);
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = CONFIG_BLINK_GPIO,
+        .max_leds = show->num_leds,
+        .led_model = LED_MODEL_WS2812,
+        .color_component_format = show->num_components == 4 ? LED_STRIP_COLOR_COMPONENT_FMT_GRBW : LED_STRIP_COLOR_COMPONENT_FMT_GRB,
+    };
+    led_strip_rmt_config_t rmt_config = {
+        .resolution_hz = 10 * 1000 * 1000,
+        .flags.with_dma = false,
+    };
+    led_strip_handle_t strip = NULL;
+    ESP_ERROR_CHECK(led_strip_new_rmt_device(&strip_config, &rmt_config, &strip));
+    return strip;
+}
+
+void app_main(void)
+{
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                                CONFIG_LAB1_SHOW_PARTITION);
+    if (!partition) {
+        ESP_LOGE(TAG, "No data partition \"%s\" in the partition table", CONFIG_LAB1_SHOW_PARTITION);
+        return;
+    }
+    const void *data = NULL;
+    esp_partition_mmap_handle_t mmap_handle;
+    ESP_ERROR_CHECK(esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA, &data, &mmap_handle));
+    led_strip_rle_show_t show;
+    esp_err_t err = led_strip_rle_open(data, partition->size, &show);
+    if (err == ESP_OK && (show.num_frames == 0 || show.frame_period_us == 0)) {
+        err = ESP_ERR_INVALID_SIZE;
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "No show in partition \"%s\": %s", CONFIG_LAB1_SHOW_PARTITION, esp_err_to_name(err));
+        esp_partition_munmap(mmap_handle);
+        return;
+    }
+    ESP_LOGI(TAG, "%lu frames, %lu bytes, one every %lu us", (unsigned long)show.num_frames,
+             (unsigned long)show.frames_size, (unsigned long)show.frame_period_us);
+    led_strip_handle_t strip = configure_strip(&show);
+
+    s_task = xTaskGetCurrentTaskHandle();
+    start_frame_timer(show.frame_period_us);
+    // the first frame without waiting for the first alarm
+    xTaskNotifyGive(s_task);
+    uint32_t frames = 0;
+    uint32_t missed = 0;
+    int64_t next_stats = esp_timer_get_time() + STATS_PERIOD_US;
+    size_t offset = 0;
+    led_strip_rle_frame_t frame;
+    while (1) {
+        // More than one notification: the slots in between were missed, and so are their frames
+        uint32_t slots = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        missed += slots - 1;
+        for (uint32_t i = 0; i < slots; i++) {
+            if (!led_strip_rle_next_frame(&show, &offset, &frame)) {
+                offset = 0;
+                led_strip_rle_next_frame(&show, &offset, &frame);
+            }
+        }
+        // waits for the previous frame, then the encoder reads this one from flash while it is sent
+        ESP_ERROR_CHECK(led_strip_refresh_rle_async(strip, &show, &frame));
+        frames++;
+        if (esp_timer_get_time() >= next_stats) {
+            next_stats += STATS_PERIOD_US;
+            ESP_LOGI(TAG, "%lu frames, %lu slots missed", (unsigned long)frames, (unsigned long)missed);
+            frames = 0;
+            missed = 0;
+        }
+    }
+}